@@ -0,0 +1,447 @@
+/**
+ * @file maze_bench.cpp
+ * @brief Benchmark headless das consultas de colisão do labirinto (sem janela nem contexto OpenGL).
+ *
+ * Carrega o modelo, percorre caminhos (aleatórios ou gravados) chamando checkWallCollision()
+ * e getFloorHeight() e reporta consultas por segundo, latências p50/p99 e o número de
+ * alocações de memória feitas durante o carregamento e durante as consultas.
+ *
+ * Uso (a partir da raiz do projeto):
+ *   ./maze_bench [--model caminho.obj | --generate LxA] [--walks N] [--steps N] [--step-length L]
+ *                [--seed S] [--replay ficheiro] [--min-qps Q] [--threads 1,2,4] [--batch-agents N]
+ *                [--paged N] [--page-budget KiB] [--page-distance D]
+ *
+ * O ficheiro de --replay tem uma posição "x y z" por linha; cada par de posições
+ * consecutivas é tratado como um passo. Com --min-qps, o programa termina com código 1 se
+ * o débito ficar abaixo do valor indicado (útil em CI).
+ *
+ * Com --generate LxA o labirinto não vem de um OBJ: é gerado com MazeGenerator (L x A células,
+ * semente --seed) e o tempo de carregamento passa a ser o da construção. Depois dos passeios,
+ * uma NavGrid verifica que a saída é alcançável a partir do início (código 1 se não for).
+ *
+ * Com --threads 1,2,4 corre também o passeio em lote: --batch-agents agentes dão um passo
+ * por ronda, testados com checkWallCollisionBatch() e getFloorHeightBatch() num ThreadPool
+ * com esse número de threads (a que chama incluída), e é reportado o débito por número de
+ * threads. As posições finais têm de ser iguais para todos os números de threads.
+ *
+ * Com --paged N o labirinto é dividido em N x N páginas (MazePager::bake) e um agente percorre-o
+ * com moveAndSlide() e getFloorHeight() sobre as páginas residentes de um MazePager sem GPU, com
+ * orçamento --page-budget KiB (por omissão dois terços da memória do labirinto completo) e páginas
+ * pedidas até --page-distance (por omissão 1/16 da diagonal). Cada passo espera pelas leituras pedidas e é comparado com o
+ * labirinto completo; são reportados os despejos e o conjunto residente. Um passo que diverge
+ * quando todas as páginas a menos de --page-distance estão residentes é uma falha (código 1);
+ * os passos em que o orçamento não chegou para elas são só contados.
+ */
+
+#include <Maze.h>
+#include <MazePager.h>
+#include <NavGrid.h>
+#include <ThreadPool.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <memory>
+#include <thread>
+
+// Contagem de alocações: substitui os operadores globais de new/delete deste executável.
+// malloc/free passam por funções não inline para que o GCC não emparelhe o free com o
+// operator new (-Wmismatched-new-delete)
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> allocationBytes(0);
+
+__attribute__((noinline)) static void* countedAlloc(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+__attribute__((noinline)) static void countedFree(void* ptr) { std::free(ptr); }
+
+void* operator new(std::size_t size) {
+    if (void* ptr = countedAlloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { countedFree(ptr); }
+
+/// Opções da linha de comandos.
+struct BenchOptions {
+    std::string model = "models/3d-model.obj";
+    int generateWidth = 0;              ///< Células do labirinto gerado (0: carrega model)
+    int generateHeight = 0;
+    std::string replay;
+    int walks = 64;
+    int steps = 2000;
+    float stepLength = 10.0f;
+    unsigned seed = 12345;
+    double minQps = 0.0;
+    std::vector<unsigned> threads;      ///< Números de threads do passeio em lote (vazio: não corre)
+    int batchAgents = 4096;
+    int pagesPerAxis = 0;               ///< Páginas por eixo do passeio paginado (0: não corre)
+    size_t pageBudgetKiB = 0;           ///< 0: dois terços de Maze::memoryBytes()
+    float pageDistance = 0.0f;          ///< 0: 1/16 de Maze::modelSize
+};
+
+/// Latências (ns) de um tipo de consulta.
+struct LatencyStats {
+    std::vector<float> samples;
+
+    float percentile(float p) {
+        if (samples.empty()) return 0.0f;
+        size_t k = std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1)));
+        std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+        return samples[k];
+    }
+};
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--model" && hasValue) options.model = argv[++i];
+        else if (arg == "--generate" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.generateWidth, &options.generateHeight) != 2 ||
+                options.generateWidth <= 0 || options.generateHeight <= 0) return false;
+        }
+        else if (arg == "--replay" && hasValue) options.replay = argv[++i];
+        else if (arg == "--walks" && hasValue) options.walks = std::atoi(argv[++i]);
+        else if (arg == "--steps" && hasValue) options.steps = std::atoi(argv[++i]);
+        else if (arg == "--step-length" && hasValue) options.stepLength = (float)std::atof(argv[++i]);
+        else if (arg == "--seed" && hasValue) options.seed = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--min-qps" && hasValue) options.minQps = std::atof(argv[++i]);
+        else if (arg == "--threads" && hasValue) {
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin < list.size();) {
+                size_t end = list.find(',', begin);
+                if (end == std::string::npos) end = list.size();
+                int count = std::atoi(list.substr(begin, end - begin).c_str());
+                if (count <= 0) return false;
+                options.threads.push_back((unsigned)count);
+                begin = end + 1;
+            }
+        }
+        else if (arg == "--batch-agents" && hasValue) options.batchAgents = std::atoi(argv[++i]);
+        else if (arg == "--paged" && hasValue) options.pagesPerAxis = std::atoi(argv[++i]);
+        else if (arg == "--page-budget" && hasValue) options.pageBudgetKiB = (size_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--page-distance" && hasValue) options.pageDistance = (float)std::atof(argv[++i]);
+        else {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            return false;
+        }
+    }
+    // As páginas são carimbadas com o ficheiro de origem, que um labirinto gerado não tem
+    if (options.generateWidth > 0 && options.pagesPerAxis > 0) {
+        std::cerr << "--paged requer um modelo (--model), nao --generate" << std::endl;
+        return false;
+    }
+    return options.walks > 0 && options.steps > 0 && options.batchAgents > 0 && options.pagesPerAxis >= 0;
+}
+
+/// Resultado de um passeio em lote.
+struct BatchResult {
+    size_t queries = 0;
+    double ms = 0.0;            ///< Tempo só das chamadas em lote
+    double checksum = 0.0;      ///< Soma das posições finais (igual para qualquer número de threads)
+};
+
+/**
+ * @brief Passeio em lote: em cada ronda todos os agentes propõem um passo aleatório; as
+ * paredes são testadas com checkWallCollisionBatch() e o chão com getFloorHeightBatch() nos
+ * passos que não colidiram.
+ * @param pool nullptr para correr na thread atual.
+ */
+static BatchResult runBatchWalk(Maze& maze, const BenchOptions& options, ThreadPool* pool) {
+    using Clock = std::chrono::steady_clock;
+    size_t agentCount = (size_t)options.batchAgents;
+    size_t rounds = std::max<size_t>(1, (size_t)options.walks * options.steps / agentCount);
+    std::vector<glm::vec3> agents(agentCount, maze.startPosition), proposed(agentCount), floorQueries;
+    std::vector<size_t> floorAgents;
+    std::vector<float> heights;
+    std::unique_ptr<bool[]> hits(new bool[agentCount]);
+    floorQueries.reserve(agentCount);
+    floorAgents.reserve(agentCount);
+    heights.resize(agentCount);
+    unsigned state = options.seed;
+
+    BatchResult result;
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < agentCount; i++) {
+            state = state * 1664525u + 1013904223u;
+            float angle = (state >> 8) / 16777216.0f * 6.2831853f;
+            proposed[i] = agents[i] + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * options.stepLength;
+        }
+
+        Clock::time_point t0 = Clock::now();
+        maze.checkWallCollisionBatch(proposed.data(), nullptr, agentCount, hits.get(), pool, 5.0f);
+        result.ms += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        floorQueries.clear();
+        floorAgents.clear();
+        for (size_t i = 0; i < agentCount; i++) {
+            if (hits[i]) continue;
+            floorQueries.push_back(proposed[i]);
+            floorAgents.push_back(i);
+        }
+        t0 = Clock::now();
+        maze.getFloorHeightBatch(floorQueries.data(), floorQueries.size(), heights.data(), pool);
+        result.ms += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        result.queries += agentCount + floorQueries.size();
+        for (size_t k = 0; k < floorAgents.size(); k++) {
+            if (heights[k] < -90000.0f) continue;
+            const glm::vec3& to = floorQueries[k];
+            agents[floorAgents[k]] = glm::vec3(to.x, heights[k] + 50.0f, to.z);
+        }
+    }
+    for (const glm::vec3& agent : agents) result.checksum += agent.x + agent.y + agent.z;
+    return result;
+}
+
+/// Resultado do passeio paginado.
+struct PagedResult {
+    size_t steps = 0;
+    size_t mismatches = 0;      ///< Passos com todas as páginas próximas residentes em que o resultado divergiu
+    size_t overBudget = 0;      ///< Passos em que alguma página próxima não coube no orçamento
+    double ms = 0.0;            ///< Tempo total, incluindo a espera pelas leituras
+    double waitMs = 0.0;        ///< Tempo à espera de páginas pedidas
+    size_t maxResidentPages = 0;
+    uint64_t maxResidentBytes = 0;
+};
+
+/**
+ * @brief Passeio paginado: um agente anda em linha reta e muda de direção ao bater numa parede.
+ *
+ * Antes de cada passo o pager pede as páginas próximas e espera por elas, pelo que o
+ * resultado de moveAndSlide() e getFloorHeight() tem de ser o do labirinto completo sempre
+ * que as páginas a menos de loadDistance couberem no orçamento.
+ */
+static PagedResult runPagedWalk(Maze& maze, MazePager& pager, const BenchOptions& options, float loadDistance) {
+    using Clock = std::chrono::steady_clock;
+    PagedResult result;
+    result.steps = (size_t)options.walks * options.steps;
+    unsigned state = options.seed;
+    auto randomHeading = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        float angle = (state >> 8) / 16777216.0f * 6.2831853f;
+        return glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+    };
+
+    glm::vec3 position = maze.startPosition;
+    glm::vec3 heading = randomHeading();
+    Clock::time_point start = Clock::now();
+    for (size_t step = 0; step < result.steps; step++) {
+        pager.update(position, loadDistance);
+        Clock::time_point waitStart = Clock::now();
+        while (pager.pendingLoads() > 0) {
+            std::this_thread::yield();
+            pager.update(position, loadDistance);
+        }
+        result.waitMs += std::chrono::duration<double, std::milli>(Clock::now() - waitStart).count();
+        result.maxResidentPages = std::max(result.maxResidentPages, pager.residentPages());
+        result.maxResidentBytes = std::max(result.maxResidentBytes, pager.residentMemory());
+
+        glm::vec3 delta = heading * options.stepLength;
+        glm::vec3 next = pager.moveAndSlide(position, delta, 5.0f);
+        float height = pager.getFloorHeight(next);
+        if (pager.skippedPages() > 0) {
+            result.overBudget++;
+        } else if (glm::length(next - maze.moveAndSlide(position, delta, 5.0f)) > 1e-3f || height != maze.getFloorHeight(next)) {
+            result.mismatches++;
+        }
+
+        // Parede à frente (o deslize ficou com menos de metade do passo): nova direção
+        if (glm::length(next - position) < 0.5f * options.stepLength) heading = randomHeading();
+        if (height > -90000.0f) position = glm::vec3(next.x, height + 50.0f, next.z);
+    }
+    result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
+
+/// Lê um caminho gravado (uma posição "x y z" por linha).
+static bool loadReplay(const std::string& path, std::vector<glm::vec3>& positions) {
+    std::ifstream file(path);
+    if (!file) return false;
+    glm::vec3 p;
+    while (file >> p.x >> p.y >> p.z) positions.push_back(p);
+    return positions.size() >= 2;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Uso: maze_bench [--model f.obj | --generate LxA] [--walks N] [--steps N] [--step-length L] "
+                     "[--seed S] [--replay ficheiro] [--min-qps Q] [--threads 1,2,4] [--batch-agents N] "
+                     "[--paged N] [--page-budget KiB] [--page-distance D]" << std::endl;
+        return 2;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    size_t allocsBeforeLoad = allocationCount.load();
+    bool generated = options.generateWidth > 0;
+    MazeGenerator::Params generatorParams;
+    generatorParams.seed = options.seed;
+    generatorParams.width = options.generateWidth;
+    generatorParams.height = options.generateHeight;
+    Clock::time_point loadStart = Clock::now();
+    std::unique_ptr<Maze> loadedMaze(generated ? new Maze(generatorParams) : new Maze(options.model));
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+    size_t loadAllocs = allocationCount.load() - allocsBeforeLoad;
+    Maze& maze = *loadedMaze;
+    if (maze.wallTriangles.empty() && maze.floorTriangles.empty()) {
+        std::cerr << "Falha ao carregar " << options.model << std::endl;
+        return 2;
+    }
+
+    std::vector<glm::vec3> replay;
+    if (!options.replay.empty() && !loadReplay(options.replay, replay)) {
+        std::cerr << "Falha ao ler o caminho " << options.replay << std::endl;
+        return 2;
+    }
+
+    // Reservar tudo antes de medir, para que as alocações contadas sejam só as das consultas
+    size_t stepCount = replay.empty() ? (size_t)options.walks * options.steps : replay.size() - 1;
+    LatencyStats wallStats, floorStats;
+    wallStats.samples.reserve(stepCount);
+    floorStats.samples.reserve(stepCount);
+    std::vector<glm::vec3> agents(replay.empty() ? options.walks : 1, maze.startPosition);
+    unsigned state = options.seed;
+    auto random = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0f;
+    };
+
+    size_t wallHits = 0, floorMisses = 0;
+    size_t allocsBeforeQueries = allocationCount.load();
+    size_t bytesBeforeQueries = allocationBytes.load();
+    Clock::time_point queryStart = Clock::now();
+    for (size_t step = 0; step < stepCount; step++) {
+        glm::vec3 to;
+        if (replay.empty()) {
+            // Passeio aleatório: cada agente tenta um passo numa direção XZ aleatória
+            const glm::vec3& agent = agents[step % agents.size()];
+            float angle = random() * 6.2831853f;
+            to = agent + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * options.stepLength;
+        } else {
+            to = replay[step + 1];
+        }
+
+        Clock::time_point t0 = Clock::now();
+        bool hit = maze.checkWallCollision(to, 5.0f);
+        Clock::time_point t1 = Clock::now();
+        wallStats.samples.push_back(std::chrono::duration<float, std::nano>(t1 - t0).count());
+        if (hit) {
+            wallHits++;
+            continue;
+        }
+
+        t0 = Clock::now();
+        float height = maze.getFloorHeight(to);
+        t1 = Clock::now();
+        floorStats.samples.push_back(std::chrono::duration<float, std::nano>(t1 - t0).count());
+        if (height < -90000.0f) {
+            floorMisses++;
+            continue;
+        }
+        if (replay.empty()) agents[step % agents.size()] = glm::vec3(to.x, height + 50.0f, to.z);
+    }
+    double queryMs = std::chrono::duration<double, std::milli>(Clock::now() - queryStart).count();
+    size_t queryAllocs = allocationCount.load() - allocsBeforeQueries;
+    size_t queryBytes = allocationBytes.load() - bytesBeforeQueries;
+
+    size_t queries = wallStats.samples.size() + floorStats.samples.size();
+    double qps = queries / (queryMs / 1000.0);
+    if (generated) {
+        std::printf("modelo          gerado %dx%d, semente %u (%zu paredes, %zu chao)\n", options.generateWidth,
+                    options.generateHeight, options.seed, maze.wallTriangles.size(), maze.floorTriangles.size());
+    } else {
+        std::printf("modelo          %s (%zu paredes, %zu chao)\n", options.model.c_str(),
+                    maze.wallTriangles.size(), maze.floorTriangles.size());
+    }
+    std::printf("%s %.1f ms, %zu alocacoes\n", generated ? "construcao     " : "carregamento   ", loadMs, loadAllocs);
+    std::printf("passos          %zu (%s), %zu colisoes, %zu sem chao\n", stepCount,
+                replay.empty() ? "aleatorio" : "gravado", wallHits, floorMisses);
+    std::printf("consultas       %zu em %.1f ms = %.0f consultas/s\n", queries, queryMs, qps);
+    std::printf("parede  (ns)    p50 %.0f  p99 %.0f\n", wallStats.percentile(0.50f), wallStats.percentile(0.99f));
+    std::printf("chao    (ns)    p50 %.0f  p99 %.0f\n", floorStats.percentile(0.50f), floorStats.percentile(0.99f));
+    std::printf("alocacoes       %zu (%zu bytes) durante as consultas\n", queryAllocs, queryBytes);
+
+    // Passeio em lote: t threads = t - 1 workers + a thread que chama parallelFor()
+    double baseQps = 0.0, baseChecksum = 0.0;
+    bool consistent = true;
+    for (unsigned threads : options.threads) {
+        std::unique_ptr<ThreadPool> pool(threads > 1 ? new ThreadPool(threads - 1) : nullptr);
+        BatchResult batch = runBatchWalk(maze, options, pool.get());
+        double batchQps = batch.queries / (batch.ms / 1000.0);
+        if (baseQps == 0.0) {
+            baseQps = batchQps;
+            baseChecksum = batch.checksum;
+        }
+        consistent = consistent && batch.checksum == baseChecksum;
+        std::printf("lote %2u threads %zu consultas em %.1f ms = %.0f consultas/s (x%.2f)\n", threads,
+                    batch.queries, batch.ms, batchQps, batchQps / baseQps);
+    }
+    if (!consistent) {
+        std::printf("FALHOU: o passeio em lote deu posicoes diferentes com numeros de threads diferentes\n");
+        return 1;
+    }
+
+    // Labirinto gerado: a saída tem de ser alcançável a partir do início
+    if (generated) {
+        Clock::time_point navStart = Clock::now();
+        NavGrid grid;
+        grid.build(maze);
+        NavGrid::Path path = grid.findPath(maze.startPosition, maze.exitPosition);
+        double navMs = std::chrono::duration<double, std::milli>(Clock::now() - navStart).count();
+        if (!path.found) {
+            std::printf("FALHOU: a saida do labirinto gerado nao e alcancavel a partir do inicio\n");
+            return 1;
+        }
+        std::printf("caminho         inicio -> saida %.0f unidades (%zu cantos), grelha e procura %.1f ms\n",
+                    path.length, path.points.size(), navMs);
+    }
+
+    if (options.pagesPerAxis > 0) {
+        if (!MazePager::bake(maze, options.model, options.pagesPerAxis)) {
+            std::cerr << "Falha ao escrever as paginas de " << options.model << std::endl;
+            return 2;
+        }
+        size_t budget = options.pageBudgetKiB > 0 ? options.pageBudgetKiB << 10 : maze.memoryBytes() * 2 / 3;
+        float loadDistance = options.pageDistance > 0.0f ? options.pageDistance : maze.modelSize / 16.0f;
+        MazePager pager(options.model, false, budget, 1, false);
+        if (!pager.open()) {
+            std::cerr << "Falha ao abrir o indice de paginas de " << options.model << std::endl;
+            return 2;
+        }
+        PagedResult paged = runPagedWalk(maze, pager, options, loadDistance);
+        std::printf("paginas         %zu, orcamento %zu KiB (labirinto completo %zu KiB), distancia %.0f\n",
+                    pager.pageCount(), budget >> 10, maze.memoryBytes() >> 10, loadDistance);
+        std::printf("paginado        %zu passos em %.1f ms (%.1f ms a espera de leituras), %u despejos\n",
+                    paged.steps, paged.ms, paged.waitMs, pager.evictedPages);
+        std::printf("residentes      %zu paginas, %llu KiB (maximo %zu paginas, %llu KiB)\n", pager.residentPages(),
+                    (unsigned long long)(pager.residentMemory() >> 10), paged.maxResidentPages,
+                    (unsigned long long)(paged.maxResidentBytes >> 10));
+        std::printf("fora do orcamento %zu passos com paginas proximas por carregar\n", paged.overBudget);
+        if (paged.mismatches > 0) {
+            std::printf("FALHOU: %zu passos paginados divergiram do labirinto completo\n", paged.mismatches);
+            return 1;
+        }
+    }
+
+    if (options.minQps > 0.0 && qps < options.minQps) {
+        std::printf("FALHOU: %.0f consultas/s abaixo do minimo %.0f\n", qps, options.minQps);
+        return 1;
+    }
+    return 0;
+}
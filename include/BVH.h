@@ -0,0 +1,202 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+/**
+ * @class BVH
+ * @brief Bounding Volume Hierarchy de caixas alinhadas com os eixos, construída com SAH por bins.
+ *
+ * A árvore não guarda as primitivas: build() devolve a permutação pela qual o chamador deve
+ * reordenar os seus dados, de forma a que cada folha corresponda a um intervalo contíguo
+ * [first, first + count). As consultas visitam esses intervalos.
+ */
+class BVH {
+public:
+    /**
+     * @struct Node
+     * @brief Nó de 32 bytes. Nós internos têm count == 0 e os filhos em leftFirst e leftFirst + 1;
+     * folhas têm count > 0 e a primeira primitiva em leftFirst.
+     */
+    struct Node {
+        glm::vec3 boundsMin;    ///< Mínimo da caixa do nó
+        uint32_t leftFirst;     ///< Filho esquerdo (nó interno) ou primeira primitiva (folha)
+        glm::vec3 boundsMax;    ///< Máximo da caixa do nó
+        uint32_t count;         ///< Número de primitivas (0 para nós internos)
+    };
+
+    static const uint32_t MAX_LEAF_SIZE = 4;    ///< Folhas com até este número de primitivas não são divididas
+    static const uint32_t MAX_DEPTH = 48;       ///< Profundidade máxima (limita a pilha das consultas)
+
+    std::vector<Node> nodes;    ///< Nós da árvore; nodes[0] é a raiz
+
+    /**
+     * @brief Constrói a árvore sobre as caixas das primitivas.
+     *
+     * @param primMin Mínimos das caixas das primitivas.
+     * @param primMax Máximos das caixas das primitivas.
+     * @param order Permutação resultante: a posição i das folhas corresponde à primitiva order[i].
+     */
+    void build(const std::vector<glm::vec3>& primMin, const std::vector<glm::vec3>& primMax, std::vector<uint32_t>& order) {
+        size_t count = primMin.size();
+        nodes.clear();
+        order.resize(count);
+        for (size_t i = 0; i < count; i++) order[i] = (uint32_t)i;
+        if (count == 0) return;
+
+        centroids.resize(count);
+        for (size_t i = 0; i < count; i++) centroids[i] = (primMin[i] + primMax[i]) * 0.5f;
+
+        nodes.reserve(2 * count / MAX_LEAF_SIZE + 1);
+        nodes.push_back(Node());
+        subdivide(0, 0, (uint32_t)count, 0, primMin, primMax, order);
+        centroids.clear();
+        centroids.shrink_to_fit();
+    }
+
+    /**
+     * @brief Visita as folhas cuja caixa interseta a caixa [queryMin, queryMax].
+     *
+     * @param visit Função bool(uint32_t first, uint32_t count); devolver true termina a consulta.
+     * @return true se alguma visita terminou a consulta.
+     */
+    template <typename Visitor>
+    bool query(const glm::vec3& queryMin, const glm::vec3& queryMax, Visitor&& visit) const {
+        if (nodes.empty()) return false;
+        uint32_t stack[MAX_DEPTH + 2];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (node.boundsMin.x > queryMax.x || node.boundsMax.x < queryMin.x ||
+                node.boundsMin.z > queryMax.z || node.boundsMax.z < queryMin.z ||
+                node.boundsMin.y > queryMax.y || node.boundsMax.y < queryMin.y) {
+                continue;
+            }
+            if (node.count > 0) {
+                if (visit(node.leftFirst, node.count)) return true;
+            } else {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+        return false;
+    }
+
+    /// Profundidade da árvore (para diagnóstico).
+    int depth(uint32_t nodeIndex = 0) const {
+        if (nodes.empty()) return 0;
+        const Node& node = nodes[nodeIndex];
+        if (node.count > 0) return 1;
+        return 1 + std::max(depth(node.leftFirst), depth(node.leftFirst + 1));
+    }
+
+private:
+    static const int BINS = 12;             ///< Número de bins da heurística SAH
+    std::vector<glm::vec3> centroids;       ///< Centroides das primitivas (apenas durante build)
+
+    static float area(const glm::vec3& lo, const glm::vec3& hi) {
+        glm::vec3 e = hi - lo;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    void subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t level,
+                   const std::vector<glm::vec3>& primMin, const std::vector<glm::vec3>& primMax,
+                   std::vector<uint32_t>& order) {
+        glm::vec3 lo(std::numeric_limits<float>::max()), hi(std::numeric_limits<float>::lowest());
+        glm::vec3 cLo = lo, cHi = hi;
+        for (uint32_t i = first; i < first + count; i++) {
+            lo = glm::min(lo, primMin[order[i]]);
+            hi = glm::max(hi, primMax[order[i]]);
+            cLo = glm::min(cLo, centroids[order[i]]);
+            cHi = glm::max(cHi, centroids[order[i]]);
+        }
+        nodes[nodeIndex].boundsMin = lo;
+        nodes[nodeIndex].boundsMax = hi;
+        nodes[nodeIndex].leftFirst = first;
+        nodes[nodeIndex].count = count;
+        if (count <= MAX_LEAF_SIZE || level >= MAX_DEPTH) return;
+
+        // Procurar o melhor plano de divisão (SAH) entre os limites dos bins, nos três eixos
+        int bestAxis = -1, bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = cHi[axis] - cLo[axis];
+            if (extent <= 0.0f) continue;
+
+            uint32_t binCount[BINS] = {};
+            glm::vec3 binMin[BINS], binMax[BINS];
+            for (int b = 0; b < BINS; b++) {
+                binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+                binMax[b] = glm::vec3(std::numeric_limits<float>::lowest());
+            }
+            float scale = BINS / extent;
+            for (uint32_t i = first; i < first + count; i++) {
+                uint32_t p = order[i];
+                int b = std::min(BINS - 1, (int)((centroids[p][axis] - cLo[axis]) * scale));
+                binCount[b]++;
+                binMin[b] = glm::min(binMin[b], primMin[p]);
+                binMax[b] = glm::max(binMax[b], primMax[p]);
+            }
+
+            // Varrimento da direita para a esquerda para obter as áreas acumuladas
+            float rightArea[BINS];
+            uint32_t rightCount[BINS];
+            glm::vec3 accMin(std::numeric_limits<float>::max()), accMax(std::numeric_limits<float>::lowest());
+            uint32_t accCount = 0;
+            for (int b = BINS - 1; b > 0; b--) {
+                accCount += binCount[b];
+                if (binCount[b]) {
+                    accMin = glm::min(accMin, binMin[b]);
+                    accMax = glm::max(accMax, binMax[b]);
+                }
+                rightCount[b] = accCount;
+                rightArea[b] = accCount ? area(accMin, accMax) : 0.0f;
+            }
+            accMin = glm::vec3(std::numeric_limits<float>::max());
+            accMax = glm::vec3(std::numeric_limits<float>::lowest());
+            accCount = 0;
+            for (int b = 0; b < BINS - 1; b++) {
+                accCount += binCount[b];
+                if (binCount[b]) {
+                    accMin = glm::min(accMin, binMin[b]);
+                    accMax = glm::max(accMax, binMax[b]);
+                }
+                if (accCount == 0 || rightCount[b + 1] == 0) continue;
+                float cost = accCount * area(accMin, accMax) + rightCount[b + 1] * rightArea[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+
+        // Dividir só compensa se o custo estimado for menor que testar todas as primitivas
+        float leafCost = count * area(lo, hi);
+        if (bestAxis < 0 || (bestCost >= leafCost && count <= 4 * MAX_LEAF_SIZE)) return;
+
+        float scale = BINS / (cHi[bestAxis] - cLo[bestAxis]);
+        uint32_t* begin = order.data() + first;
+        uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t p) {
+            return std::min(BINS - 1, (int)((centroids[p][bestAxis] - cLo[bestAxis]) * scale)) < bestSplit;
+        });
+        uint32_t leftCount = (uint32_t)(middle - begin);
+        if (leftCount == 0 || leftCount == count) return;
+
+        uint32_t left = (uint32_t)nodes.size();
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        nodes[nodeIndex].leftFirst = left;
+        nodes[nodeIndex].count = 0;
+        subdivide(left, first, leftCount, level + 1, primMin, primMax, order);
+        subdivide(left + 1, first + leftCount, count - leftCount, level + 1, primMin, primMax, order);
+    }
+};
+
+#endif
@@ -0,0 +1,364 @@
+#ifndef COLLISION_DATA_H
+#define COLLISION_DATA_H
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include "Simd.h"
+
+/**
+ * @class WallCollisionData
+ * @brief Dados pré-calculados dos triângulos de parede para o teste esfera-triângulo (layout SoA).
+ *
+ * Cada campo é um vetor separado, indexado pela mesma ordem dos triângulos (a das folhas da
+ * BVH), para que uma folha corresponda a leituras contíguas em cada vetor. Guarda o plano
+ * normalizado, as arestas e o inverso do denominador das coordenadas paramétricas, de forma
+ * a que o teste por consulta seja apenas produtos internos.
+ *
+ * Depois do último add(), finish() acrescenta SIMD_PADDING entradas que nunca colidem, para
+ * que os kernels de 4 lanes possam ler [i, i + 4) a partir de qualquer triângulo válido.
+ */
+class WallCollisionData {
+public:
+    std::vector<float> nx, ny, nz, d;       ///< Plano: dot(n, p) + d = distância com sinal
+    std::vector<float> ox, oy, oz;          ///< Vértice v0
+    std::vector<float> ux, uy, uz;          ///< Aresta u = v1 - v0
+    std::vector<float> vx, vy, vz;          ///< Aresta v = v2 - v0
+    std::vector<float> uu, uv, vv;          ///< Produtos internos das arestas
+    std::vector<float> invD;                ///< 1 / (uv² - uu·vv)
+
+    /// Margem paramétrica aceite fora do triângulo (evita passar pelas frestas entre triângulos).
+    static constexpr float EDGE_EPSILON = -0.01f;
+    static const size_t SIMD_PADDING = 3;   ///< Entradas extra no fim de cada vetor (ver finish())
+
+    /// Número de triângulos (sem o padding).
+    size_t size() const { return count; }
+
+    void clear() {
+        for (std::vector<float>* field : fields()) field->clear();
+        count = 0;
+    }
+
+    /// Acrescenta o padding final; chamar uma vez, depois de todos os add().
+    void finish() {
+        size_t triangles = count;
+        for (size_t i = 0; i < SIMD_PADDING; i++) add(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f));
+        count = triangles;
+    }
+
+    void reserve(size_t capacity) {
+        for (std::vector<float>* field : fields()) field->reserve(capacity);
+    }
+
+    /// Bytes alocados pelos campos (capacidade, incluindo o padding).
+    size_t memoryBytes() const {
+        size_t bytes = 0;
+        for (std::vector<float>* field : const_cast<WallCollisionData*>(this)->fields()) bytes += field->capacity() * sizeof(float);
+        return bytes;
+    }
+
+    /**
+     * @brief Acrescenta um triângulo.
+     *
+     * Triângulos degenerados ficam com um plano a distância infinita, pelo que nunca colidem.
+     */
+    void add(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+        glm::vec3 u = v1 - v0;
+        glm::vec3 v = v2 - v0;
+        glm::vec3 n = glm::cross(u, v);
+        float len = glm::length(n);
+        float dotUU = glm::dot(u, u), dotUV = glm::dot(u, v), dotVV = glm::dot(v, v);
+        float D = dotUV * dotUV - dotUU * dotVV;
+
+        bool degenerate = len <= 0.0f || std::abs(D) < 1e-6f;
+        n = degenerate ? glm::vec3(0.0f) : n / len;
+        nx.push_back(n.x); ny.push_back(n.y); nz.push_back(n.z);
+        d.push_back(degenerate ? std::numeric_limits<float>::infinity() : -glm::dot(n, v0));
+        ox.push_back(v0.x); oy.push_back(v0.y); oz.push_back(v0.z);
+        ux.push_back(u.x); uy.push_back(u.y); uz.push_back(u.z);
+        vx.push_back(v.x); vy.push_back(v.y); vz.push_back(v.z);
+        uu.push_back(dotUU); uv.push_back(dotUV); vv.push_back(dotVV);
+        invD.push_back(degenerate ? 0.0f : 1.0f / D);
+        count++;
+    }
+
+    /// Testa se a esfera toca o triângulo i (projeção do centro no plano dentro do triângulo).
+    bool intersectsSphere(size_t i, const glm::vec3& center, float radius) const {
+        float dist = nx[i] * center.x + ny[i] * center.y + nz[i] * center.z + d[i];
+        if (std::abs(dist) > radius) return false;
+
+        // w = P - v0, com P a projeção do centro no plano
+        float wx = center.x - dist * nx[i] - ox[i];
+        float wy = center.y - dist * ny[i] - oy[i];
+        float wz = center.z - dist * nz[i] - oz[i];
+        float wu = wx * ux[i] + wy * uy[i] + wz * uz[i];
+        float wv = wx * vx[i] + wy * vy[i] + wz * vz[i];
+        float s = (uv[i] * wv - vv[i] * wu) * invD[i];
+        float t = (uv[i] * wu - uu[i] * wv) * invD[i];
+        return s >= EDGE_EPSILON && t >= EDGE_EPSILON && (s + t) <= 1.0f - EDGE_EPSILON;
+    }
+
+    /**
+     * @brief Versão de 4 lanes de intersectsSphere() para os triângulos [first, first + 4).
+     * @return Máscara de 4 bits (bit k = triângulo first + k colide). O chamador deve
+     *         descartar os lanes além do fim da folha.
+     */
+    int intersectsSphere4(size_t first, const glm::vec3& center, float radius) const {
+        using namespace simd;
+        float4 cx = set1(center.x), cy = set1(center.y), cz = set1(center.z);
+        float4 Nx = load(&nx[first]), Ny = load(&ny[first]), Nz = load(&nz[first]);
+        float4 dist = Nx * cx + Ny * cy + Nz * cz + load(&d[first]);
+        Mask4 near = abs(dist) <= set1(radius);
+        if (bits(near) == 0) return 0;
+
+        float4 wx = cx - dist * Nx - load(&ox[first]);
+        float4 wy = cy - dist * Ny - load(&oy[first]);
+        float4 wz = cz - dist * Nz - load(&oz[first]);
+        float4 wu = wx * load(&ux[first]) + wy * load(&uy[first]) + wz * load(&uz[first]);
+        float4 wv = wx * load(&vx[first]) + wy * load(&vy[first]) + wz * load(&vz[first]);
+        float4 UU = load(&uu[first]), UV = load(&uv[first]), VV = load(&vv[first]), inv = load(&invD[first]);
+        float4 s = (UV * wv - VV * wu) * inv;
+        float4 t = (UV * wu - UU * wv) * inv;
+        float4 eps = set1(EDGE_EPSILON);
+        return bits(near & (s >= eps) & (t >= eps) & (s + t <= set1(1.0f - EDGE_EPSILON)));
+    }
+
+    /**
+     * @brief Tempo de impacto de uma esfera em movimento contra o triângulo i (face, arestas e vértices).
+     *
+     * A esfera parte de start e percorre start + velocity * t, com t em [0, 1]. Só se
+     * consideram contactos em que a esfera se aproxima do triângulo, para que uma esfera já
+     * encostada (ou ligeiramente dentro) se possa afastar.
+     *
+     * @param maxT Só são aceites impactos com t < maxT (o melhor encontrado até agora).
+     * @param t Tempo do impacto encontrado.
+     * @param normal Normal de contacto (do ponto de contacto para o centro da esfera), normalizada.
+     * @return true se houve impacto antes de maxT.
+     */
+    bool sweepSphere(size_t i, const glm::vec3& start, const glm::vec3& velocity, float radius,
+                     float maxT, float& t, glm::vec3& normal) const {
+        glm::vec3 n(nx[i], ny[i], nz[i]);
+        glm::vec3 p0(ox[i], oy[i], oz[i]);
+        glm::vec3 p1 = p0 + glm::vec3(ux[i], uy[i], uz[i]);
+        glm::vec3 p2 = p0 + glm::vec3(vx[i], vy[i], vz[i]);
+        if (std::isinf(d[i])) return false;
+
+        // Paredes com duas faces: usar a normal virada para a posição inicial
+        float startDist = glm::dot(n, start) + d[i];
+        if (startDist < 0.0f) { n = -n; startDist = -startDist; }
+        float nDotV = glm::dot(n, velocity);
+        if (nDotV >= 0.0f && startDist >= radius) return false;    // Nunca chega ao plano
+
+        // 1. Face: instante em que a esfera toca o plano (0 se já o interseta). Arestas e
+        // vértices nunca são tocados antes do plano, pelo que t0 >= maxT exclui o triângulo.
+        // Paralela ou a afastar-se mas já a intersetar o plano, só pode tocar arestas e vértices.
+        float t0 = 0.0f;
+        if (nDotV < 0.0f) {
+            t0 = std::max(0.0f, (radius - startDist) / nDotV);
+            if (t0 >= maxT) return false;
+
+            glm::vec3 center = start + velocity * t0;
+            glm::vec3 w = center - n * (startDist + nDotV * t0) - p0;
+            float wu = w.x * ux[i] + w.y * uy[i] + w.z * uz[i];
+            float wv = w.x * vx[i] + w.y * vy[i] + w.z * vz[i];
+            float s = (uv[i] * wv - vv[i] * wu) * invD[i];
+            float q = (uv[i] * wu - uu[i] * wv) * invD[i];
+            if (s >= 0.0f && q >= 0.0f && s + q <= 1.0f) {
+                t = t0;
+                normal = n;
+                return true;
+            }
+        }
+
+        // 2. Vértices e arestas (o ponto de contacto com o plano ficou fora do triângulo)
+        bool found = false;
+        float velSq = glm::dot(velocity, velocity);
+        float bestT = maxT;
+        glm::vec3 bestPoint;
+        const glm::vec3 corners[3] = {p0, p1, p2};
+        for (int c = 0; c < 3; c++) {
+            glm::vec3 toStart = start - corners[c];
+            float root;
+            if (lowestRoot(velSq, 2.0f * glm::dot(velocity, toStart), glm::dot(toStart, toStart) - radius * radius, bestT, root) &&
+                glm::dot(start + velocity * root - corners[c], velocity) < 0.0f) {
+                bestT = root;
+                bestPoint = corners[c];
+                found = true;
+            }
+        }
+        for (int e = 0; e < 3; e++) {
+            const glm::vec3& a = corners[e];
+            glm::vec3 edge = corners[(e + 1) % 3] - a;
+            glm::vec3 toVertex = a - start;
+            float edgeSq = glm::dot(edge, edge);
+            float edgeDotVel = glm::dot(edge, velocity);
+            float edgeDotToVertex = glm::dot(edge, toVertex);
+            float A = edgeSq * -velSq + edgeDotVel * edgeDotVel;
+            float B = edgeSq * (2.0f * glm::dot(velocity, toVertex)) - 2.0f * edgeDotVel * edgeDotToVertex;
+            float C = edgeSq * (radius * radius - glm::dot(toVertex, toVertex)) + edgeDotToVertex * edgeDotToVertex;
+            float root;
+            if (!lowestRoot(A, B, C, bestT, root)) continue;
+            float f = (edgeDotVel * root - edgeDotToVertex) / edgeSq;
+            if (f < 0.0f || f > 1.0f) continue;
+            glm::vec3 point = a + edge * f;
+            if (glm::dot(start + velocity * root - point, velocity) >= 0.0f) continue;
+            bestT = root;
+            bestPoint = point;
+            found = true;
+        }
+        if (!found) return false;
+
+        // Por arredondamento, uma raiz de aresta pode ficar ligeiramente antes de t0: o contacto
+        // é então o do plano (em t0, com a normal da face). Sem isto o resultado dependeria de
+        // maxT, ou seja, da ordem em que os triângulos são testados
+        if (bestT <= t0 && nDotV < 0.0f) {
+            t = t0;
+            normal = n;
+            return true;
+        }
+        t = bestT;
+        normal = start + velocity * bestT - bestPoint;
+        float len = glm::length(normal);
+        normal = len > 0.0f ? normal / len : n;
+        return true;
+    }
+
+private:
+    size_t count = 0;
+
+    /// Menor raiz de a·x² + b·x + c em [0, maxRoot).
+    static bool lowestRoot(float a, float b, float c, float maxRoot, float& root) {
+        if (std::abs(a) < 1e-12f) return false;
+        float det = b * b - 4.0f * a * c;
+        if (det < 0.0f) return false;
+        float sq = std::sqrt(det);
+        float r1 = (-b - sq) / (2.0f * a);
+        float r2 = (-b + sq) / (2.0f * a);
+        if (r1 > r2) std::swap(r1, r2);
+        if (r1 >= 0.0f && r1 < maxRoot) { root = r1; return true; }
+        if (r2 >= 0.0f && r2 < maxRoot) { root = r2; return true; }
+        return false;
+    }
+
+    std::vector<std::vector<float>*> fields() {
+        return {&nx, &ny, &nz, &d, &ox, &oy, &oz, &ux, &uy, &uz, &vx, &vy, &vz, &uu, &uv, &vv, &invD};
+    }
+};
+
+/**
+ * @class FloorCollisionData
+ * @brief Dados pré-calculados dos triângulos de chão para a altura por coordenadas baricêntricas (SoA).
+ *
+ * A projeção em XZ de cada triângulo é reduzida a um vértice de origem, duas arestas e os
+ * coeficientes do sistema 2x2 já divididos pelo determinante. Tal como WallCollisionData,
+ * termina com SIMD_PADDING entradas (degeneradas) acrescentadas por finish().
+ */
+class FloorCollisionData {
+public:
+    std::vector<float> ax, az;              ///< Vértice v0 projetado em XZ
+    std::vector<float> e0x, e0z, e1x, e1z;  ///< Arestas v1 - v0 e v2 - v0 em XZ
+    std::vector<float> k00, k01, k11;       ///< d00, d01 e d11 divididos pelo determinante
+    std::vector<float> y0, y1, y2;          ///< Alturas dos três vértices
+    std::vector<float> normalY;             ///< Componente vertical da normal (para o declive)
+
+    static const size_t SIMD_PADDING = 3;   ///< Entradas extra no fim de cada vetor (ver finish())
+
+    /// Número de triângulos (sem o padding).
+    size_t size() const { return count; }
+
+    void clear() {
+        for (std::vector<float>* field : fields()) field->clear();
+        count = 0;
+    }
+
+    /// Acrescenta o padding final; chamar uma vez, depois de todos os add().
+    void finish() {
+        size_t triangles = count;
+        for (size_t i = 0; i < SIMD_PADDING; i++) add(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), -1.0f);
+        count = triangles;
+    }
+
+    void reserve(size_t capacity) {
+        for (std::vector<float>* field : fields()) field->reserve(capacity);
+    }
+
+    /// Bytes alocados pelos campos (capacidade, incluindo o padding).
+    size_t memoryBytes() const {
+        size_t bytes = 0;
+        for (std::vector<float>* field : const_cast<FloorCollisionData*>(this)->fields()) bytes += field->capacity() * sizeof(float);
+        return bytes;
+    }
+
+    /**
+     * @brief Acrescenta um triângulo.
+     *
+     * Triângulos degenerados em XZ recebem coeficientes NaN, que fazem falhar todas as
+     * comparações do teste de inclusão.
+     */
+    void add(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float normalUp) {
+        glm::vec2 e0(v1.x - v0.x, v1.z - v0.z);
+        glm::vec2 e1(v2.x - v0.x, v2.z - v0.z);
+        float d00 = glm::dot(e0, e0), d01 = glm::dot(e0, e1), d11 = glm::dot(e1, e1);
+        float denom = d00 * d11 - d01 * d01;
+        float inv = std::abs(denom) < 1e-6f ? std::numeric_limits<float>::quiet_NaN() : 1.0f / denom;
+
+        ax.push_back(v0.x); az.push_back(v0.z);
+        e0x.push_back(e0.x); e0z.push_back(e0.y);
+        e1x.push_back(e1.x); e1z.push_back(e1.y);
+        k00.push_back(d00 * inv); k01.push_back(d01 * inv); k11.push_back(d11 * inv);
+        y0.push_back(v0.y); y1.push_back(v1.y); y2.push_back(v2.y);
+        normalY.push_back(normalUp);
+        count++;
+    }
+
+    /**
+     * @brief Altura do triângulo i no ponto (x, z).
+     * @return false se o ponto estiver fora da projeção do triângulo.
+     */
+    bool heightAt(size_t i, float x, float z, float& height) const {
+        float px = x - ax[i], pz = z - az[i];
+        float d20 = px * e0x[i] + pz * e0z[i];
+        float d21 = px * e1x[i] + pz * e1z[i];
+        float v = k11[i] * d20 - k01[i] * d21;
+        float w = k00[i] * d21 - k01[i] * d20;
+        float u = 1.0f - v - w;
+        if (!(u >= 0.0f && v >= 0.0f && w >= 0.0f)) return false;
+        height = u * y0[i] + v * y1[i] + w * y2[i];
+        return true;
+    }
+
+    /**
+     * @brief Versão de 4 lanes de heightAt() para os triângulos [first, first + 4).
+     *
+     * @param minNormalY Declive mínimo (normal.y); lanes abaixo são descartados.
+     * @param heights Alturas dos 4 lanes (só válidas nos lanes da máscara).
+     * @return Máscara de 4 bits dos triângulos que contêm (x, z).
+     */
+    int heightAt4(size_t first, float x, float z, float minNormalY, float heights[4]) const {
+        using namespace simd;
+        float4 px = set1(x) - load(&ax[first]);
+        float4 pz = set1(z) - load(&az[first]);
+        float4 d20 = px * load(&e0x[first]) + pz * load(&e0z[first]);
+        float4 d21 = px * load(&e1x[first]) + pz * load(&e1z[first]);
+        float4 K01 = load(&k01[first]);
+        float4 v = load(&k11[first]) * d20 - K01 * d21;
+        float4 w = load(&k00[first]) * d21 - K01 * d20;
+        float4 u = set1(1.0f) - v - w;
+        float4 zero = set1(0.0f);
+        int mask = bits((u >= zero) & (v >= zero) & (w >= zero) & (load(&normalY[first]) >= set1(minNormalY)));
+        if (mask) store(heights, u * load(&y0[first]) + v * load(&y1[first]) + w * load(&y2[first]));
+        return mask;
+    }
+
+private:
+    size_t count = 0;
+
+    std::vector<std::vector<float>*> fields() {
+        return {&ax, &az, &e0x, &e0z, &e1x, &e1z, &k00, &k01, &k11, &y0, &y1, &y2, &normalY};
+    }
+};
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef COMPRESSED_TEXTURE_H
+#define COMPRESSED_TEXTURE_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <sys/stat.h>
+
+// Formatos S3TC (GL_EXT_texture_compression_s3tc, não incluídos no glad core)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+/**
+ * @class CompressedTexture
+ * @brief Textura pré-comprimida (BC1-BC5) com a cadeia de mipmaps já calculada, lida de DDS ou KTX2.
+ *
+ * Os blocos ficam em memória exatamente como são enviados para glCompressedTexImage2D, pelo que
+ * não há descodificação nem glGenerateMipmap em runtime. BC1 ocupa 1/8 de RGBA8 e BC3 1/4.
+ *
+ * Orientação: o DDS guarda as linhas de cima para baixo; o KTX2 indica-a na chave
+ * KTXorientation ("rd" de cima para baixo, por omissão, ou "ru" de baixo para cima).
+ * Se for pedida a outra, os blocos são invertidos sem descomprimir, o que só é exato quando a
+ * altura de cada nível é múltipla de 4 (ou menor que 4); caso contrário load() falha e deve
+ * ser usado o PNG.
+ */
+class CompressedTexture {
+public:
+    /// Um nível de mipmap dentro de data.
+    struct Level {
+        int width = 0, height = 0;
+        size_t offset = 0, size = 0;
+    };
+
+    GLenum format = 0;              ///< Formato interno comprimido (0 se nada foi carregado)
+    int blockBytes = 0;             ///< 8 (BC1, BC4) ou 16 (BC2, BC3, BC5) bytes por bloco 4x4
+    std::vector<Level> levels;      ///< Nível 0 primeiro
+    std::vector<unsigned char> data;
+
+    /**
+     * @brief Lê um ficheiro .dds ou .ktx2 (pelo conteúdo, não pela extensão).
+     * @param bottomUp true para obter as linhas de baixo para cima (convenção do OpenGL).
+     */
+    bool load(const std::string& path, bool bottomUp) {
+        *this = CompressedTexture();
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        bool storedBottomUp = false;
+        bool ok = (bytes.size() >= 4 && std::memcmp(bytes.data(), "DDS ", 4) == 0)
+                ? parseDDS(bytes)
+                : parseKTX2(bytes, storedBottomUp);
+        if (!ok || levels.empty()) {
+            *this = CompressedTexture();
+            return false;
+        }
+        if (bottomUp != storedBottomUp && !flipVertically()) {
+            *this = CompressedTexture();
+            return false;
+        }
+        return true;
+    }
+
+    /// Tamanho em bytes de um nível w x h.
+    static size_t levelSize(int width, int height, int blockBytes) {
+        return (size_t)std::max(1, (width + 3) / 4) * std::max(1, (height + 3) / 4) * blockBytes;
+    }
+
+    /**
+     * @brief Versão comprimida de uma imagem: o mesmo caminho com .ktx2 ou .dds, se existir e
+     * não for mais antiga que a imagem original.
+     * @return Caminho encontrado, ou string vazia.
+     */
+    static std::string findFor(const std::string& imagePath) {
+        size_t dot = imagePath.find_last_of('.');
+        std::string stem = (dot == std::string::npos) ? imagePath : imagePath.substr(0, dot);
+        struct stat source;
+        bool hasSource = stat(imagePath.c_str(), &source) == 0;
+        for (const char* extension : { ".ktx2", ".dds" }) {
+            std::string candidate = stem + extension;
+            struct stat st;
+            if (stat(candidate.c_str(), &st) != 0) continue;
+            if (hasSource && st.st_mtime < source.st_mtime) continue;   // Desatualizada
+            return candidate;
+        }
+        return std::string();
+    }
+
+    /**
+     * @brief Verifica se o contexto atual suporta S3TC (chamar na thread do contexto OpenGL).
+     * BC4/BC5 (RGTC) fazem parte do OpenGL 3.0 e estão sempre disponíveis.
+     */
+    static bool s3tcSupported() {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) return true;
+        }
+        return false;
+    }
+
+    static bool isS3TC(GLenum format) {
+        return format >= GL_COMPRESSED_RGB_S3TC_DXT1_EXT && format <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+
+    /// Nome curto do formato (para mensagens).
+    static const char* formatName(GLenum format) {
+        switch (format) {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "BC1";
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return "BC2";
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+            case GL_COMPRESSED_RED_RGTC1: return "BC4";
+            case GL_COMPRESSED_RG_RGTC2: return "BC5";
+            default: return "?";
+        }
+    }
+
+    // Valores de vkFormat usados no KTX2
+    static const uint32_t VK_BC1_RGB_UNORM = 131;
+    static const uint32_t VK_BC1_RGBA_UNORM = 133;
+    static const uint32_t VK_BC2_UNORM = 135;
+    static const uint32_t VK_BC3_UNORM = 137;
+    static const uint32_t VK_BC4_UNORM = 139;
+    static const uint32_t VK_BC5_UNORM = 141;
+
+private:
+    template <typename T>
+    static T read(const std::vector<unsigned char>& bytes, size_t offset) {
+        T value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    bool setFormat(GLenum glFormat) {
+        format = glFormat;
+        blockBytes = (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ||
+                      format == GL_COMPRESSED_RED_RGTC1) ? 8 : 16;
+        return true;
+    }
+
+    /// Calcula os níveis contíguos a partir de offset e copia-os para data.
+    bool readContiguousLevels(const std::vector<unsigned char>& bytes, size_t offset, int width, int height, int count) {
+        for (int i = 0; i < count; i++) {
+            Level level;
+            level.width = std::max(1, width >> i);
+            level.height = std::max(1, height >> i);
+            level.offset = data.size();
+            level.size = levelSize(level.width, level.height, blockBytes);
+            if (offset + level.size > bytes.size()) return false;
+            data.insert(data.end(), bytes.begin() + offset, bytes.begin() + offset + level.size);
+            offset += level.size;
+            levels.push_back(level);
+        }
+        return true;
+    }
+
+    bool parseDDS(const std::vector<unsigned char>& bytes) {
+        const size_t HEADER = 4 + 124;
+        if (bytes.size() < HEADER) return false;
+        int height = (int)read<uint32_t>(bytes, 12);
+        int width = (int)read<uint32_t>(bytes, 16);
+        uint32_t mipCount = read<uint32_t>(bytes, 28);
+        uint32_t pixelFlags = read<uint32_t>(bytes, 80);
+        uint32_t fourCC = read<uint32_t>(bytes, 84);
+        uint32_t caps2 = read<uint32_t>(bytes, 112);
+        if (width <= 0 || height <= 0) return false;
+        if (caps2 & 0x200) return false;            // DDSCAPS2_CUBEMAP: as faces vêm em ficheiros separados
+        if (!(pixelFlags & 0x4)) return false;      // DDPF_FOURCC: só formatos comprimidos
+
+        auto code = [](const char* s) { return (uint32_t)s[0] | ((uint32_t)s[1] << 8) | ((uint32_t)s[2] << 16) | ((uint32_t)s[3] << 24); };
+        size_t offset = HEADER;
+        if (fourCC == code("DXT1")) setFormat((pixelFlags & 0x1) ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+        else if (fourCC == code("DXT3")) setFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT);
+        else if (fourCC == code("DXT5")) setFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+        else if (fourCC == code("ATI1") || fourCC == code("BC4U")) setFormat(GL_COMPRESSED_RED_RGTC1);
+        else if (fourCC == code("ATI2") || fourCC == code("BC5U")) setFormat(GL_COMPRESSED_RG_RGTC2);
+        else if (fourCC == code("DX10")) {
+            // Cabeçalho DXT10: formato DXGI, dimensão, flags, arraySize
+            if (bytes.size() < HEADER + 20) return false;
+            uint32_t dxgi = read<uint32_t>(bytes, HEADER);
+            if (read<uint32_t>(bytes, HEADER + 12) > 1) return false;
+            offset += 20;
+            switch (dxgi) {
+                case 71: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT); break;   // BC1_UNORM
+                case 74: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT); break;   // BC2_UNORM
+                case 77: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT); break;   // BC3_UNORM
+                case 80: setFormat(GL_COMPRESSED_RED_RGTC1); break;            // BC4_UNORM
+                case 83: setFormat(GL_COMPRESSED_RG_RGTC2); break;             // BC5_UNORM
+                default: return false;
+            }
+        } else {
+            return false;
+        }
+        return readContiguousLevels(bytes, offset, width, height, std::max(1u, mipCount));
+    }
+
+    bool parseKTX2(const std::vector<unsigned char>& bytes, bool& storedBottomUp) {
+        static const unsigned char IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        const size_t HEADER = 80;
+        if (bytes.size() < HEADER || std::memcmp(bytes.data(), IDENTIFIER, 12) != 0) return false;
+        uint32_t vkFormat = read<uint32_t>(bytes, 12);
+        int width = (int)read<uint32_t>(bytes, 20);
+        int height = (int)read<uint32_t>(bytes, 24);
+        uint32_t depth = read<uint32_t>(bytes, 28);
+        uint32_t layers = read<uint32_t>(bytes, 32);
+        uint32_t faces = read<uint32_t>(bytes, 36);
+        uint32_t levelCount = std::max(1u, read<uint32_t>(bytes, 40));
+        uint32_t supercompression = read<uint32_t>(bytes, 44);
+        uint32_t kvdOffset = read<uint32_t>(bytes, 56);
+        uint32_t kvdLength = read<uint32_t>(bytes, 60);
+        if (width <= 0 || height <= 0 || depth > 1 || layers > 1 || faces != 1 || supercompression != 0) return false;
+        if (bytes.size() < HEADER + (size_t)levelCount * 24) return false;
+
+        switch (vkFormat) {
+            case VK_BC1_RGB_UNORM: setFormat(GL_COMPRESSED_RGB_S3TC_DXT1_EXT); break;
+            case VK_BC1_RGBA_UNORM: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT); break;
+            case VK_BC2_UNORM: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT); break;
+            case VK_BC3_UNORM: setFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT); break;
+            case VK_BC4_UNORM: setFormat(GL_COMPRESSED_RED_RGTC1); break;
+            case VK_BC5_UNORM: setFormat(GL_COMPRESSED_RG_RGTC2); break;
+            default: return false;
+        }
+
+        // Pares chave/valor: só interessa KTXorientation
+        if ((size_t)kvdOffset + kvdLength <= bytes.size()) {
+            size_t p = kvdOffset, end = (size_t)kvdOffset + kvdLength;
+            while (p + 4 <= end) {
+                uint32_t length = read<uint32_t>(bytes, p);
+                if (p + 4 + length > end) break;
+                const char* entry = (const char*)bytes.data() + p + 4;
+                size_t keyLength = strnlen(entry, length);
+                if (std::string(entry, keyLength) == "KTXorientation" && keyLength + 2 < length) {
+                    storedBottomUp = entry[keyLength + 2] == 'u';   // "rd" / "ru": 2.º eixo (y)
+                }
+                p += 4 + ((length + 3) & ~3u);
+            }
+        }
+
+        // Índice de níveis: offsets absolutos no ficheiro, nível 0 primeiro
+        for (uint32_t i = 0; i < levelCount; i++) {
+            uint64_t offset = read<uint64_t>(bytes, HEADER + i * 24);
+            uint64_t length = read<uint64_t>(bytes, HEADER + i * 24 + 8);
+            Level level;
+            level.width = std::max(1, width >> i);
+            level.height = std::max(1, height >> i);
+            level.size = levelSize(level.width, level.height, blockBytes);
+            if (length < level.size || offset + level.size > bytes.size()) return false;
+            level.offset = data.size();
+            data.insert(data.end(), bytes.begin() + offset, bytes.begin() + offset + level.size);
+            levels.push_back(level);
+        }
+        return true;
+    }
+
+    /// Inverte as linhas de um bloco de alfa BC3/BC4 (índices de 3 bits, 12 bits por linha).
+    static void flipAlphaBlock(unsigned char* block, int rows) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 6; k++) bits |= (uint64_t)block[2 + k] << (8 * k);
+        uint64_t flipped = bits;
+        for (int r = 0; r < rows; r++) {
+            uint64_t row = (bits >> (12 * r)) & 0xFFF;
+            int target = rows - 1 - r;
+            flipped &= ~((uint64_t)0xFFF << (12 * target));
+            flipped |= row << (12 * target);
+        }
+        for (int k = 0; k < 6; k++) block[2 + k] = (unsigned char)(flipped >> (8 * k));
+    }
+
+    /// Inverte as linhas de um bloco de cor BC1 (índices de 2 bits, um byte por linha).
+    static void flipColorBlock(unsigned char* block, int rows) {
+        std::reverse(block + 4, block + 4 + rows);
+    }
+
+    /// Inverte as linhas de um bloco de alfa explícito BC2 (4 bits por texel, 2 bytes por linha).
+    static void flipExplicitAlphaBlock(unsigned char* block, int rows) {
+        for (int r = 0; r < rows / 2; r++) {
+            std::swap(block[2 * r], block[2 * (rows - 1 - r)]);
+            std::swap(block[2 * r + 1], block[2 * (rows - 1 - r) + 1]);
+        }
+    }
+
+    bool flipVertically() {
+        for (const Level& level : levels) {
+            if (level.height > 4 && level.height % 4 != 0) return false;
+        }
+        std::vector<unsigned char> row;
+        for (const Level& level : levels) {
+            int blocksX = std::max(1, (level.width + 3) / 4);
+            int blocksY = std::max(1, (level.height + 3) / 4);
+            int rows = std::min(4, level.height);
+            size_t rowBytes = (size_t)blocksX * blockBytes;
+            unsigned char* base = data.data() + level.offset;
+
+            // Ordem das linhas de blocos
+            row.resize(rowBytes);
+            for (int y = 0; y < blocksY / 2; y++) {
+                unsigned char* a = base + y * rowBytes;
+                unsigned char* b = base + (blocksY - 1 - y) * rowBytes;
+                std::memcpy(row.data(), a, rowBytes);
+                std::memcpy(a, b, rowBytes);
+                std::memcpy(b, row.data(), rowBytes);
+            }
+
+            // Linhas dentro de cada bloco
+            for (size_t k = 0; k < (size_t)blocksX * blocksY; k++) {
+                unsigned char* block = base + k * blockBytes;
+                switch (format) {
+                    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: flipColorBlock(block, rows); break;
+                    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: flipExplicitAlphaBlock(block, rows); flipColorBlock(block + 8, rows); break;
+                    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: flipAlphaBlock(block, rows); flipColorBlock(block + 8, rows); break;
+                    case GL_COMPRESSED_RED_RGTC1: flipAlphaBlock(block, rows); break;
+                    case GL_COMPRESSED_RG_RGTC2: flipAlphaBlock(block, rows); flipAlphaBlock(block + 8, rows); break;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+#endif
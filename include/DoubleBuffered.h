@@ -0,0 +1,41 @@
+#ifndef DOUBLE_BUFFERED_H
+#define DOUBLE_BUFFERED_H
+
+#include <mutex>
+
+/**
+ * @class DoubleBuffered
+ * @brief Valor partilhado entre duas threads: uma escreve versões completas, a outra lê a mais recente.
+ *
+ * O escritor preenche a cópia de trás sem bloquear o leitor e publica-a trocando o índice
+ * da frente; o leitor copia a frente. O mutex só protege a troca e a cópia, que são
+ * pequenas, pelo que nenhuma das threads espera pela outra durante o seu trabalho.
+ *
+ * @tparam T Tipo copiável (snapshot de estado).
+ */
+template <typename T>
+class DoubleBuffered {
+public:
+    DoubleBuffered() {}
+    explicit DoubleBuffered(const T& initial) { slots[0] = slots[1] = initial; }
+
+    /// Publica uma nova versão (apenas a thread escritora).
+    void publish(const T& value) {
+        slots[1 - front] = value;
+        std::lock_guard<std::mutex> lock(mutex);
+        front = 1 - front;
+    }
+
+    /// Cópia da versão publicada mais recente (apenas a thread leitora).
+    T read() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return slots[front];
+    }
+
+private:
+    T slots[2];
+    int front = 0;
+    mutable std::mutex mutex;
+};
+
+#endif
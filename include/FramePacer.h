@@ -0,0 +1,93 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+/**
+ * @class FramePacer
+ * @brief Modo de apresentação (vsync, vsync adaptativo, limite de frames ou sem limite) e espera entre frames.
+ *
+ * Em LIMITED o vsync fica desligado e wait() dorme até ao início do frame seguinte: dorme com
+ * sleep_for até SPIN_MARGIN antes do prazo (a granularidade do sleep do sistema não é fiável
+ * abaixo disso) e cede o processador até ao prazo exato. Como wait() é chamado depois do swap
+ * e antes de ler os eventos, a entrada é amostrada o mais tarde possível, logo antes de se
+ * desenhar o frame que a usa, em vez de ficar à espera dentro do driver como acontece com vsync.
+ *
+ * ADAPTIVE_VSYNC (intervalo -1) sincroniza quando o frame chega a tempo e apresenta logo quando
+ * se atrasa; sem a extensão *_EXT_swap_control_tear cai para VSYNC.
+ */
+class FramePacer {
+public:
+    enum Mode { VSYNC, ADAPTIVE_VSYNC, LIMITED, UNCAPPED, MODE_COUNT };
+
+    static constexpr double SPIN_MARGIN = 0.002;    ///< Segundos finais da espera feitos sem dormir
+
+    /**
+     * @param refreshRate Frequência do monitor (Hz), alvo dos modos com vsync e sem limite.
+     * @param frameLimit Frames por segundo em LIMITED (0: a frequência do monitor).
+     */
+    FramePacer(double refreshRate = 60.0, double frameLimit = 0.0)
+        : refreshRate(refreshRate > 0.0 ? refreshRate : 60.0), frameLimit(frameLimit) {}
+
+    /// Aplica o modo ao contexto atual (glfwSwapInterval).
+    void setMode(Mode value) {
+        bool tearSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                             glfwExtensionSupported("GLX_EXT_swap_control_tear");
+        active = value == ADAPTIVE_VSYNC && !tearSupported ? VSYNC : value;
+        glfwSwapInterval(active == VSYNC ? 1 : active == ADAPTIVE_VSYNC ? -1 : 0);
+        deadline = Clock::now();
+    }
+
+    /// Passa ao modo seguinte (tecla de alternância).
+    void nextMode() { setMode((Mode)((active + 1) % MODE_COUNT)); }
+
+    Mode mode() const { return active; }
+
+    static const char* modeName(Mode value) {
+        switch (value) {
+            case VSYNC: return "vsync";
+            case ADAPTIVE_VSYNC: return "vsync adaptativo";
+            case LIMITED: return "limite de frames";
+            default: return "sem limite";
+        }
+    }
+
+    /// Duração pretendida de um frame (segundos).
+    double targetFrameTime() const {
+        return 1.0 / (active == LIMITED && frameLimit > 0.0 ? frameLimit : refreshRate);
+    }
+
+    /**
+     * @brief Espera pelo início do próximo frame (só em LIMITED). Chamar depois de glfwSwapBuffers().
+     *
+     * Um frame que se atrasou mais do que um período recomeça a contagem, em vez de os
+     * seguintes correrem sem espera para recuperar.
+     */
+    void wait() {
+        if (active != LIMITED) return;
+        Clock::time_point now = Clock::now();
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(targetFrameTime()));
+        deadline += period;
+        if (now > deadline + period) {
+            deadline = now;
+            return;
+        }
+        Clock::duration margin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SPIN_MARGIN));
+        if (deadline - now > margin) std::this_thread::sleep_for(deadline - now - margin);
+        while (Clock::now() < deadline) std::this_thread::yield();
+    }
+
+    double refreshRate;     ///< Hz
+    double frameLimit;      ///< Frames por segundo em LIMITED (0: refreshRate)
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Mode active = VSYNC;
+    Clock::time_point deadline = Clock::now();
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/**
+ * @struct FrameData
+ * @brief Constantes por frame partilhadas pelos shaders, com o layout std140 do bloco FrameData.
+ *
+ * Os vec3 ocupam um vec4 inteiro (alinhamento de 16 bytes em std140); os quatro escalares
+ * formam um vec4. A ordem tem de coincidir com a declaração do bloco em GLSL.
+ */
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 flashLightSpace = glm::mat4(1.0f);    ///< projection * view do shadow map da lanterna
+    glm::vec4 viewPos;                  ///< xyz: posição da câmara
+    glm::vec4 flashLightPos;            ///< xyz: posição da lanterna (na mão, ligeiramente ao lado da câmara)
+    glm::vec4 flashLightDir;            ///< xyz: direção da lanterna
+    glm::vec4 topLightPos;              ///< xyz: posição da luz superior
+    float lightIntensity = 1.0f;        ///< Intensidade da luz ambiente (ciclo dia/noite)
+    float flashLightCutoff = 0.0f;      ///< Cosseno do cone interior da lanterna
+    float flashLightOuterCutoff = 0.0f; ///< Cosseno do cone exterior da lanterna
+    int flashLightOn = 0;               ///< bool em GLSL (4 bytes em std140)
+    glm::vec4 clusterScale = glm::vec4(0.0f);   ///< Clusters por pixel (xy) e escala/bias das fatias de profundidade (zw)
+    glm::ivec4 clusterGrid = glm::ivec4(0);     ///< Dimensões da grelha de clusters (xyz); w: luzes pontuais ativas
+    glm::vec4 flashShadowParams = glm::vec4(0.0f);  ///< x: sombras ativas (0/1), y: texel do mapa, z: offset na normal por unidade de distância
+};
+
+static_assert(sizeof(FrameData) == 3 * 64 + 8 * 16, "FrameData tem de seguir o layout std140");
+
+/**
+ * @class FrameUniforms
+ * @brief Uniform buffer com as FrameData, atualizado uma vez por frame e ligado a BINDING.
+ *
+ * Cada programa que declara o bloco liga-o com Shader::bindUniformBlock("FrameData", BINDING).
+ */
+class FrameUniforms {
+public:
+    static const GLuint BINDING = 0;    ///< Ponto de ligação do bloco FrameData
+
+    FrameUniforms() {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+    }
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    ~FrameUniforms() {
+        glDeleteBuffers(1, &UBO);
+    }
+
+    /// Envia as constantes do frame (uma só chamada para todos os shaders que usam o bloco).
+    void update(const FrameData& data) {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    GLuint UBO = 0;
+};
+
+#endif
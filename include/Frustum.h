@@ -0,0 +1,57 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+/**
+ * @class Frustum
+ * @brief Volume de visualização (6 planos) extraído de uma matriz projection * view.
+ *
+ * Os planos são obtidos diretamente das linhas da matriz (método de Gribb/Hartmann) e
+ * apontam para dentro do volume. Usado para descartar chunks do labirinto fora do ecrã.
+ */
+class Frustum {
+public:
+    glm::vec4 planes[6];    ///< Planos (normal.xyz, d): esquerda, direita, baixo, cima, perto, longe
+
+    /**
+     * @brief Constrói o frustum a partir da matriz combinada.
+     * @param viewProjection Matriz projection * view.
+     */
+    Frustum(const glm::mat4& viewProjection) {
+        // glm é column-major: linha i = (m[0][i], m[1][i], m[2][i], m[3][i])
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; i++) {
+            row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        }
+        planes[0] = row[3] + row[0];
+        planes[1] = row[3] - row[0];
+        planes[2] = row[3] + row[1];
+        planes[3] = row[3] - row[1];
+        planes[4] = row[3] + row[2];
+        planes[5] = row[3] - row[2];
+        for (int i = 0; i < 6; i++) {
+            float len = glm::length(glm::vec3(planes[i].x, planes[i].y, planes[i].z));
+            if (len > 0.0f) planes[i] = planes[i] / len;
+        }
+    }
+
+    /**
+     * @brief Testa se uma caixa alinhada com os eixos interseta (ou está dentro) do frustum.
+     *
+     * Teste conservador: para cada plano usa o vértice da caixa mais à frente na direção da normal.
+     */
+    bool intersectsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const {
+        for (int i = 0; i < 6; i++) {
+            glm::vec3 positive(planes[i].x >= 0.0f ? boxMax.x : boxMin.x,
+                               planes[i].y >= 0.0f ? boxMax.y : boxMin.y,
+                               planes[i].z >= 0.0f ? boxMax.z : boxMin.z);
+            if (planes[i].x * positive.x + planes[i].y * positive.y + planes[i].z * positive.z + planes[i].w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * @class InputTrace
+ * @brief Gravação da entrada consumida por cada tick de simulação, para repetir um percurso.
+ *
+ * Cada tick guarda exatamente o que simulationTick() leu (teclas de movimento, orientação e
+ * velocidade da câmara) mais o estado das teclas de alternância. Como a simulação é uma
+ * função do estado e da entrada de cada tick, repetir os ticks pela mesma ordem reproduz o
+ * mesmo percurso, independentemente do ritmo a que os frames foram desenhados na gravação.
+ *
+ * Formato do ficheiro: cabeçalho (MAGIC, VERSION, duração do tick, número de ticks) seguido
+ * dos Tick em binário (little-endian, como a cache do labirinto).
+ */
+class InputTrace {
+public:
+    static constexpr uint32_t MAGIC = 0x52545A4D;   ///< "MZTR" em little-endian
+    static constexpr uint32_t VERSION = 1;      ///< Incrementar sempre que Tick muda
+
+    /// Bits de Tick::flags.
+    enum Flag : uint32_t {
+        KEY_FORWARD = 1 << 0,
+        KEY_BACK = 1 << 1,
+        KEY_LEFT = 1 << 2,
+        KEY_RIGHT = 1 << 3,
+        KEY_SPRINT = 1 << 4,
+        NOCLIP = 1 << 5,
+        FLASHLIGHT = 1 << 6,
+        OCCLUSION = 1 << 7,
+        LOD = 1 << 8,
+        TORCHES = 1 << 9,
+        HINTS = 1 << 10
+    };
+
+    /**
+     * @struct Tick
+     * @brief Entrada de um tick de simulação.
+     */
+    struct Tick {
+        uint32_t flags = 0;     ///< Combinação de Flag
+        float front[3] = {};    ///< Camera::Front na amostragem
+        float right[3] = {};    ///< Camera::Right na amostragem
+        float speed = 0.0f;     ///< Camera::MovementSpeed
+        float yaw = 0.0f;       ///< Camera::Yaw (para repor a vista)
+        float pitch = 0.0f;     ///< Camera::Pitch
+    };
+
+    float tickDuration = 0.0f;  ///< Duração de cada tick (SIM_TICK da gravação)
+    std::vector<Tick> ticks;
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        uint32_t count = (uint32_t)ticks.size();
+        out.write((const char*)&MAGIC, sizeof(MAGIC));
+        out.write((const char*)&VERSION, sizeof(VERSION));
+        out.write((const char*)&tickDuration, sizeof(tickDuration));
+        out.write((const char*)&count, sizeof(count));
+        out.write((const char*)ticks.data(), (std::streamsize)(ticks.size() * sizeof(Tick)));
+        return (bool)out;
+    }
+
+    /// @return false (e traço vazio) se o ficheiro não existir ou for de outra versão.
+    bool load(const std::string& path) {
+        ticks.clear();
+        std::ifstream in(path, std::ios::binary);
+        uint32_t magic = 0, version = 0, count = 0;
+        in.read((char*)&magic, sizeof(magic));
+        in.read((char*)&version, sizeof(version));
+        in.read((char*)&tickDuration, sizeof(tickDuration));
+        in.read((char*)&count, sizeof(count));
+        if (!in || magic != MAGIC || version != VERSION) return false;
+        ticks.resize(count);
+        in.read((char*)ticks.data(), (std::streamsize)(ticks.size() * sizeof(Tick)));
+        if (!in) {
+            ticks.clear();
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shader_m.h>
+#include <FrameUniforms.h>
+
+/**
+ * @struct PointLight
+ * @brief Luz pontual (por exemplo uma tocha) com alcance finito.
+ */
+struct PointLight {
+    glm::vec3 position;                     ///< Posição no mundo
+    float radius = 300.0f;                  ///< Distância a partir da qual a luz não contribui
+    glm::vec3 color = glm::vec3(1.0f);      ///< Cor
+    float intensity = 1.0f;                 ///< Multiplicador da cor
+};
+
+/**
+ * @class LightClusters
+ * @brief Clustered forward shading: atribui as luzes pontuais a clusters do frustum da câmara.
+ *
+ * O frustum é dividido em CLUSTER_X x CLUSTER_Y tiles de ecrã e CLUSTER_Z fatias de
+ * profundidade em escala logarítmica. Em update(), cada luz é atribuída (na CPU) aos
+ * clusters que a sua esfera pode tocar; o fragment shader calcula o seu cluster a partir de
+ * gl_FragCoord e da profundidade e só percorre as luzes desse cluster, em vez de todas.
+ *
+ * Os resultados vão para três texture buffers (ligados às unidades FIRST_UNIT..FIRST_UNIT+2):
+ * os dados das luzes, o intervalo (offset, count) de cada cluster e a lista de índices de luz.
+ * As dimensões da grelha e as escalas seguem no bloco FrameData (ver apply()); com
+ * clusterGrid.w == 0 o shader fica só com a luz superior e a lanterna.
+ */
+class LightClusters {
+public:
+    static const int CLUSTER_X = 16;            ///< Tiles na horizontal
+    static const int CLUSTER_Y = 9;             ///< Tiles na vertical
+    static const int CLUSTER_Z = 24;            ///< Fatias de profundidade
+    static const int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+    static const int MAX_LIGHTS = 1024;         ///< Luzes consideradas por frame
+    static const int MAX_LIGHT_INDICES = 65536; ///< Mínimo de GL_MAX_TEXTURE_BUFFER_SIZE garantido pelo GL 3.3
+    static const int FIRST_UNIT = 1;            ///< Unidade de textura do primeiro texture buffer
+
+    LightClusters() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32I, GL_R32I };
+        for (int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    ~LightClusters() {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    /// Associa os samplers do shader às unidades dos texture buffers (uma vez, com o shader ativo).
+    static void bindSamplers(Shader& shader) {
+        shader.setInt("lightData", FIRST_UNIT);
+        shader.setInt("clusterRanges", FIRST_UNIT + 1);
+        shader.setInt("clusterLights", FIRST_UNIT + 2);
+    }
+
+    /**
+     * @brief Atribui as luzes aos clusters da vista atual e envia os resultados para a GPU.
+     * @param lights Luzes pontuais (apenas as primeiras MAX_LIGHTS).
+     * @param view, projection Matrizes da câmara (projeção em perspetiva).
+     * @param zNear, zFar Planos da projeção.
+     * @param width, height Tamanho do framebuffer (em pixels) onde o shader corre.
+     */
+    void update(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+                float zNear, float zFar, int width, int height) {
+        // A primeira fatia começa em zFar/1000 para não gastar fatias nos primeiros centímetros
+        sliceNear = std::max(zNear, zFar / 1000.0f);
+        sliceScale = CLUSTER_Z / std::log(zFar / sliceNear);
+        sliceBias = -std::log(sliceNear) * sliceScale;
+        viewportWidth = std::max(width, 1);
+        viewportHeight = std::max(height, 1);
+
+        lightData.clear();
+        lightRanges.clear();
+        std::fill(clusterCount.begin(), clusterCount.end(), 0);
+        size_t count = std::min(lights.size(), (size_t)MAX_LIGHTS);
+        for (size_t i = 0; i < count; i++) {
+            const PointLight& light = lights[i];
+            LightRange range;
+            if (!clusterRange(light, view, projection, zNear, zFar, range)) continue;
+            range.light = (int)lightData.size() / 2;
+            lightRanges.push_back(range);
+            lightData.push_back(glm::vec4(light.position, light.radius));
+            lightData.push_back(glm::vec4(light.color * light.intensity, 0.0f));
+            forEachCluster(range, [&](int cluster) { clusterCount[cluster]++; });
+        }
+
+        // Offsets por prefix sum; clusters que não cabem na lista ficam com menos luzes
+        int offset = 0;
+        for (int c = 0; c < CLUSTER_COUNT; c++) {
+            int n = std::min(clusterCount[c], MAX_LIGHT_INDICES - offset);
+            ranges[c * 2] = offset;
+            ranges[c * 2 + 1] = n;
+            clusterCount[c] = 0;
+            offset += n;
+        }
+        lightIndices.resize(offset);
+        for (const LightRange& range : lightRanges) {
+            forEachCluster(range, [&](int cluster) {
+                int& filled = clusterCount[cluster];
+                if (filled < ranges[cluster * 2 + 1]) lightIndices[ranges[cluster * 2] + filled++] = range.light;
+            });
+        }
+        assignedLights = (int)lightRanges.size();
+        indexCount = offset;
+
+        upload(0, lightData.data(), lightData.size() * sizeof(glm::vec4));
+        upload(1, ranges.data(), ranges.size() * sizeof(int32_t));
+        upload(2, lightIndices.data(), lightIndices.size() * sizeof(int32_t));
+    }
+
+    /// Escreve no bloco FrameData os parâmetros da grelha; enabled = false força o caminho sem luzes pontuais.
+    void apply(FrameData& data, bool enabled) const {
+        data.clusterScale = glm::vec4((float)CLUSTER_X / viewportWidth, (float)CLUSTER_Y / viewportHeight, sliceScale, sliceBias);
+        data.clusterGrid = glm::ivec4(CLUSTER_X, CLUSTER_Y, CLUSTER_Z, enabled && assignedLights > 0 ? 1 : 0);
+    }
+
+    /// Liga os três texture buffers às suas unidades.
+    void bind() const {
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + FIRST_UNIT + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    int visibleLights() const { return assignedLights; }    ///< Luzes que tocam o frustum no último update()
+    int lightIndexCount() const { return indexCount; }       ///< Entradas na lista de índices no último update()
+
+private:
+    /// Clusters (intervalos inclusivos) tocados por uma luz.
+    struct LightRange {
+        int x0, x1, y0, y1, z0, z1;
+        int light;
+    };
+
+    GLuint buffers[3] = {}, textures[3] = {};
+    std::vector<glm::vec4> lightData;                       ///< 2 texels por luz: (posição, raio), (cor, 0)
+    std::vector<int32_t> ranges = std::vector<int32_t>(CLUSTER_COUNT * 2);    ///< (offset, count) por cluster
+    std::vector<int32_t> lightIndices;                      ///< Índices de luz, agrupados por cluster
+    std::vector<int> clusterCount = std::vector<int>(CLUSTER_COUNT);
+    std::vector<LightRange> lightRanges;
+    float sliceNear = 1.0f, sliceScale = 1.0f, sliceBias = 0.0f;
+    int viewportWidth = 1, viewportHeight = 1;
+    int assignedLights = 0, indexCount = 0;
+
+    int slice(float depth) const {
+        return std::max(0, std::min(CLUSTER_Z - 1, (int)std::floor(std::log(depth) * sliceScale + sliceBias)));
+    }
+
+    /**
+     * @brief Intervalo de clusters que a esfera da luz pode tocar (conservador: caixa da esfera em espaço de vista).
+     * @return false se a luz estiver fora do frustum.
+     */
+    bool clusterRange(const PointLight& light, const glm::mat4& view, const glm::mat4& projection,
+                      float zNear, float zFar, LightRange& range) const {
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float depth = -center.z, r = light.radius;
+        if (depth + r < zNear || depth - r > zFar) return false;
+        float d0 = std::max(depth - r, zNear), d1 = std::min(depth + r, zFar);
+
+        // Projeção dos cantos da caixa: x/d é monótono em d, pelo que os extremos estão nos cantos
+        glm::vec2 lo(1e30f), hi(-1e30f);
+        for (float d : { d0, d1 }) {
+            for (float sx : { -r, r }) {
+                for (float sy : { -r, r }) {
+                    glm::vec2 ndc(projection[0][0] * (center.x + sx) / d, projection[1][1] * (center.y + sy) / d);
+                    lo = glm::min(lo, ndc);
+                    hi = glm::max(hi, ndc);
+                }
+            }
+        }
+        if (hi.x < -1.0f || lo.x > 1.0f || hi.y < -1.0f || lo.y > 1.0f) return false;
+
+        auto tile = [](float ndc, int tiles) {
+            return std::max(0, std::min(tiles - 1, (int)std::floor((ndc * 0.5f + 0.5f) * tiles)));
+        };
+        range.x0 = tile(lo.x, CLUSTER_X);
+        range.x1 = tile(hi.x, CLUSTER_X);
+        range.y0 = tile(lo.y, CLUSTER_Y);
+        range.y1 = tile(hi.y, CLUSTER_Y);
+        range.z0 = slice(d0);
+        range.z1 = slice(d1);
+        return true;
+    }
+
+    template <typename F>
+    static void forEachCluster(const LightRange& range, F&& f) {
+        for (int z = range.z0; z <= range.z1; z++)
+            for (int y = range.y0; y <= range.y1; y++)
+                for (int x = range.x0; x <= range.x1; x++)
+                    f((z * CLUSTER_Y + y) * CLUSTER_X + x);
+    }
+
+    /// Orfana e reescreve um dos texture buffers (nunca com tamanho 0).
+    void upload(int index, const void* data, size_t size) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)std::max(size, (size_t)16), nullptr, GL_STREAM_DRAW);
+        if (size) glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)size, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
@@ -7,12 +7,24 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <tiny_obj_loader.h>
+#include <shader_m.h>
+#include <MazeCache.h>
+#include <MeshOptimizer.h>
+#include <Frustum.h>
+#include <BVH.h>
+#include <CollisionData.h>
+#include <ThreadPool.h>
+#include <ObjParser.h>
+#include <MazeGenerator.h>
 
 // Auxiliar para verificar se um ponto está no triângulo (2D XZ)
 bool isPointInTriangle(glm::vec2 p, glm::vec2 a, glm::vec2 b, glm::vec2 c) {
@@ -35,15 +47,48 @@ bool isPointInTriangle(glm::vec2 p, glm::vec2 a, glm::vec2 b, glm::vec2 c) {
  * @brief Gere o modelo 3D do labirinto, deteção de colisões e particionamento espacial.
  * 
  * Esta classe lida com o carregamento do labirinto (ficheiro OBJ), classificando triângulos como chão ou paredes,
- * e organizando-os numa grelha espacial (Spatial Hashing) para deteção de colisões eficiente.
+ * e organizando-os em Bounding Volume Hierarchies (BVH) para deteção de colisões eficiente.
  */
 class Maze {
 public:
-    unsigned int VAO;   ///< Vertex Array Object para o labirinto
-    unsigned int VBO;   ///< Vertex Buffer Object para o labirinto
-    unsigned int exitVAO, exitVBO; ///< VAO/VBO para o marcador de saída
+    unsigned int VAO = 0;   ///< Vertex Array Object para o labirinto
+    unsigned int VBO = 0;   ///< Vertex Buffer Object para o labirinto
+    unsigned int EBO = 0;   ///< Element Buffer Object (índices) para o labirinto
     
-    std::vector<float> vertices; ///< Dados de vértices intercalados (Posição, Normal, TexCoords)
+    static const int VERTEX_FLOATS = 9;     ///< Floats por vértice (Posição 3, Normal 3, TexCoords 2, Material 1)
+
+    /**
+     * @brief Materiais fixos: camadas da array de texturas dos materiais (materialTextures acrescenta as seguintes).
+     */
+    enum Material {
+        MATERIAL_WALL = 0,
+        MATERIAL_FLOOR = 1,
+        MATERIAL_GATE = 2,
+        MATERIAL_FIRST_CUSTOM = 3   ///< Primeira camada dos materiais do MTL com textura difusa
+    };
+
+    /**
+     * @struct PackedVertex
+     * @brief Vértice compacto (16 bytes em vez de 36) usado quando packedVertices está ativo.
+     *
+     * A posição e as UVs são quantizadas para 16 bits relativamente aos seus intervalos
+     * (packPosOffset/packPosScale e packUVOffset/packUVScale), que o vertex shader usa para
+     * reconstruir os valores. A normal usa o formato GL_INT_2_10_10_10_REV. O material ocupa
+     * o quarto componente da posição, que de outra forma seria padding.
+     */
+    struct PackedVertex {
+        uint16_t position[4];   ///< x, y, z normalizados (unorm16) + material (inteiro)
+        uint32_t normal;        ///< Normal snorm 10:10:10:2
+        uint16_t texCoords[2];  ///< u, v normalizados (unorm16)
+    };
+
+    bool packedVertices;        ///< Usar o formato compacto de vértices no VBO
+    glm::vec3 packPosOffset = glm::vec3(0.0f), packPosScale = glm::vec3(1.0f); ///< Desquantização da posição
+    glm::vec2 packUVOffset = glm::vec2(0.0f), packUVScale = glm::vec2(1.0f);   ///< Desquantização das UVs
+
+    std::vector<float> vertices; ///< Dados de vértices únicos intercalados (Posição, Normal, TexCoords, Material)
+    std::vector<std::string> materialTextures;  ///< Texturas dos materiais do MTL (camada MATERIAL_FIRST_CUSTOM + i)
+    std::vector<unsigned int> indices; ///< Triângulos indexados (3 índices por triângulo)
     
     /**
      * @struct Triangle
@@ -58,129 +103,270 @@ public:
     std::vector<Triangle> floorTriangles;   ///< Lista de triângulos classificados como chão navegável
     std::vector<Triangle> wallTriangles;    ///< Lista de triângulos classificados como obstáculos
 
+    static const int LOD_LEVELS = 3;                    ///< Níveis de detalhe por chunk (0 = geometria original)
+    static constexpr float LOD_CELL_SIZES[LOD_LEVELS] = { 0.0f, 4.0f, 12.0f };   ///< Célula de agrupamento de vértices por nível
+    static constexpr float LOD_DISTANCE_PER_CELL = 250.0f;  ///< Distância de troca de nível por unidade de célula (~3 px a 800x600)
+    static constexpr float LOD_HYSTERESIS = 0.1f;       ///< Margem relativa em volta das distâncias de troca
+
+    /**
+     * @struct Chunk
+     * @brief Bloco espacial (XZ) da geometria, desenhado e descartado de forma independente.
+     *
+     * Os chunks dividem a extensão XZ do labirinto numa grelha CHUNK_DIM x CHUNK_DIM e cada
+     * nível de detalhe de um chunk corresponde a um intervalo contíguo do index buffer (os do
+     * nível 0 ficam todos no início, pela ordem dos chunks, e os simplificados a seguir).
+     */
+    struct Chunk {
+        glm::vec3 minBounds;        ///< Mínimo da caixa delimitadora dos triângulos do chunk
+        glm::vec3 maxBounds;        ///< Máximo da caixa delimitadora dos triângulos do chunk
+        unsigned int indexOffset[LOD_LEVELS];   ///< Primeiro índice de cada nível no index buffer
+        unsigned int indexCount[LOD_LEVELS];    ///< Número de índices de cada nível
+    };
+
+    static const int CHUNK_DIM = 16;    ///< Chunks por eixo (XZ)
+    std::vector<Chunk> chunks;          ///< Chunks não vazios, por ordem do index buffer
+    unsigned int visibleChunks = 0;     ///< Chunks desenhados no último draw() com frustum
+    unsigned int occludedChunks = 0;    ///< Chunks dentro do frustum mas ocultos no último drawOcclusionCulled()
+
+    /**
+     * @struct ChunkOcclusion
+     * @brief Estado de occlusion culling de um chunk (não vai para a cache).
+     */
+    struct ChunkOcclusion {
+        GLuint query = 0;       ///< Query GL_ANY_SAMPLES_PASSED sobre a caixa do chunk
+        bool visible = true;    ///< Visibilidade segundo a última query resolvida
+        bool pending = false;   ///< Existe uma query emitida cujo resultado ainda não foi lido
+    };
+    std::vector<ChunkOcclusion> chunkOcclusion;    ///< Um por chunk (criado no primeiro uso)
+    unsigned int boxVAO = 0, boxVBO = 0;            ///< Cubo unitário [0,1]^3 usado como proxy de oclusão
+
+    std::vector<unsigned char> chunkLod;    ///< Nível de detalhe atual de cada chunk (não vai para a cache)
+
     glm::vec3 startPosition;    ///< Posição inicial calculada para o jogador
     glm::vec3 exitPosition;     ///< Posição do portão de saída
     float modelSize;            ///< Tamanho diagonal da caixa delimitadora do labirinto
     
     glm::vec3 minBounds;        ///< Mínimo (x,y,z) da caixa delimitadora do labirinto
     glm::vec3 maxBounds;        ///< Máximo (x,y,z) da caixa delimitadora do labirinto
+    float groundPlaneY = std::numeric_limits<float>::lowest();  ///< Altura do plano de addFloor (lowest se não houver)
 
     /**
      * @brief Construtor que carrega e processa o modelo do labirinto.
      * 
+     * Tenta primeiro a cache binária (`<filepath>.bake`); se não existir ou estiver desatualizada,
+     * processa o OBJ e escreve uma nova cache para os arranques seguintes.
+     *
+     * Só faz trabalho de CPU (geometria, colisões, posições de início e saída), pelo que pode
+     * ser usado sem contexto OpenGL; para desenhar é preciso chamar uploadToGPU() depois.
+     *
      * @param filepath Caminho para o ficheiro .obj.
+     * @param packed Se true, o VBO usa o formato compacto PackedVertex (metade da largura de banda).
      */
-    Maze(const std::string& filepath) {
-        loadModel(filepath);
-        calculateBounds();
-        addFloor();
-        setupMesh();
-        initExitMarker();
+    Maze(const std::string& filepath, bool packed = false) : packedVertices(packed) {
+        std::string cachePath = filepath + ".bake";
+        if (!loadCache(cachePath, filepath)) {
+            bool loaded = loadModel(filepath);
+            calculateBounds();
+            addFloor();
+            buildIndexBuffer();
+            buildCollisionBVH();
+            buildChunks();
+            buildChunkLods();
+            if (loaded) saveCache(cachePath, filepath);
+        }
+        buildCollisionData();
         setRandomStartAndExit();
-        buildSpatialGrid();
     }
 
-    void loadModel(const std::string& filepath) {
-        tinyobj::ObjReaderConfig reader_config;
-        reader_config.mtl_search_path = "models/"; 
-
-        tinyobj::ObjReader reader;
-
-        if (!reader.ParseFromFile(filepath, reader_config)) {
-            if (!reader.Error().empty()) {
-                std::cerr << "TinyObjReader: " << reader.Error() << std::endl;
-            }
-            return;
-        }
+    /**
+     * @brief Constrói um labirinto gerado (ver MazeGenerator), sem passar por OBJ nem cache.
+     *
+     * A geometria do gerador já vem com as paredes fundidas, pelo que a construção é dominada
+     * pela BVH e pelos chunks e fica na ordem dos milissegundos para labirintos de centenas de
+     * células.
+     *
+     * @param params Parâmetros do gerador.
+     * @param packed Se true, o VBO usa o formato compacto PackedVertex.
+     */
+    explicit Maze(const MazeGenerator::Params& params, bool packed = false) : packedVertices(packed) {
+        MazeGenerator::Layout layout = MazeGenerator::generate(params, CHUNK_DIM);
+        addQuads(layout.quads);
+        calculateBounds();
+        buildIndexBuffer();
+        buildCollisionBVH();
+        buildChunks();
+        buildChunkLods();
+        buildCollisionData();
+        startPosition = layout.start + glm::vec3(0.0f, 50.0f, 0.0f);
+        exitPosition = layout.exit;
+    }
 
-        if (!reader.Warning().empty()) {
-            std::cout << "TinyObjReader: " << reader.Warning() << std::endl;
-        }
+    /**
+     * @brief Labirinto vazio, para preencher com loadCache() (páginas do MazePager).
+     */
+    Maze() : packedVertices(false), startPosition(0.0f), exitPosition(0.0f), modelSize(0.0f),
+             minBounds(0.0f), maxBounds(0.0f) {}
 
-        auto& attrib = reader.GetAttrib();
-        auto& shapes = reader.GetShapes();
+    /**
+     * @brief Cria os buffers OpenGL do labirinto.
+     *
+     * Requer um contexto OpenGL ativo na thread atual. Modo headless (benchmarks, servidores)
+     * simplesmente não a chama.
+     */
+    void uploadToGPU() {
+        setupMesh();
+    }
 
-        for (size_t s = 0; s < shapes.size(); s++) {
-            size_t index_offset = 0;
-            for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-                size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
+    /**
+     * @brief Apaga os objetos OpenGL do labirinto e do occlusion culling.
+     *
+     * Os dados de CPU (geometria e colisões) ficam intactos. Requer o contexto na thread atual.
+     */
+    void releaseGPU() {
+        for (ChunkOcclusion& occ : chunkOcclusion) glDeleteQueries(1, &occ.query);
+        chunkOcclusion.clear();
+        GLuint arrays[2] = { VAO, boxVAO };
+        GLuint buffers[3] = { VBO, EBO, boxVBO };
+        glDeleteVertexArrays(2, arrays);
+        glDeleteBuffers(3, buffers);
+        VAO = VBO = EBO = boxVAO = boxVBO = 0;
+    }
 
-                if (fv != 3) {
-                    index_offset += fv;
-                    continue;
-                }
+    /**
+     * @brief Lê o OBJ (em paralelo, ver ObjParser) e gera os vértices e os triângulos de colisão.
+     *
+     * Cada triângulo é classificado (chão/parede, material) e escrito diretamente na sua
+     * posição final do vetor de vértices, também em paralelo; as listas de chão e de parede
+     * mantêm a ordem do ficheiro.
+     */
+    bool loadModel(const std::string& filepath) {
+        const std::string mtlSearchPath = "models/";
+        ThreadPool pool;
+        ObjParser::Mesh mesh;
+        std::string error;
+        if (!ObjParser::load(filepath, mtlSearchPath, mesh, &pool, &error)) {
+            std::cerr << "ObjParser: " << error << std::endl;
+            return false;
+        }
+        if (!mesh.warning.empty()) {
+            std::cout << "ObjParser: " << mesh.warning << std::endl;
+        }
 
-                Triangle tri;
-                glm::vec3 faceNormal;
-                
-                for (size_t v = 0; v < fv; v++) {
-                    tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-                    
-                    float vx = attrib.vertices[3 * idx.vertex_index + 0];
-                    float vy = attrib.vertices[3 * idx.vertex_index + 1];
-                    float vz = attrib.vertices[3 * idx.vertex_index + 2];
-
-                    if (v == 0) tri.v0 = glm::vec3(vx, vy, vz);
-                    if (v == 1) tri.v1 = glm::vec3(vx, vy, vz);
-                    if (v == 2) tri.v2 = glm::vec3(vx, vy, vz);
-                }
-                
-                // Calcular normal da face
-                glm::vec3 edge1 = tri.v1 - tri.v0;
-                glm::vec3 edge2 = tri.v2 - tri.v0;
-                faceNormal = glm::normalize(glm::cross(edge1, edge2));
-                
-                tri.normal = faceNormal;
-                tri.centroid = (tri.v0 + tri.v1 + tri.v2) / 3.0f;
+        // Materiais com textura difusa ganham uma camada própria; os restantes seguem a
+        // classificação chão/parede
+        std::vector<int> materialLayers(mesh.materials.size(), -1);
+        for (size_t m = 0; m < mesh.materials.size(); m++) {
+            if (mesh.materials[m].diffuse_texname.empty()) continue;
+            std::string path = mtlSearchPath + mesh.materials[m].diffuse_texname;
+            auto found = std::find(materialTextures.begin(), materialTextures.end(), path);
+            materialLayers[m] = MATERIAL_FIRST_CUSTOM + (int)(found - materialTextures.begin());
+            if (found == materialTextures.end()) materialTextures.push_back(path);
+        }
 
-                // Classificar como chão ou parede
-                bool isFloor = (tri.normal.y > 0.7f);
-                if (isFloor) {
-                    floorTriangles.push_back(tri);
-                } else {
-                    wallTriangles.push_back(tri);
-                }
+        size_t triCount = mesh.triangleCount();
+        vertices.resize(triCount * 3 * VERTEX_FLOATS);
+        size_t blockCount = (triCount + LOAD_GRAIN - 1) / LOAD_GRAIN;
+        std::vector<std::vector<Triangle>> blockFloors(blockCount), blockWalls(blockCount);
+        pool.parallelFor(blockCount, 1, [&](size_t firstBlock, size_t lastBlock) {
+            for (size_t b = firstBlock; b < lastBlock; b++) {
+                for (size_t t = b * LOAD_GRAIN; t < std::min(triCount, (b + 1) * LOAD_GRAIN); t++) {
+                    glm::vec3 corners[3];
+                    for (int v = 0; v < 3; v++) {
+                        const float* p = &mesh.positions[(size_t)mesh.indices[t * 3 + v] * 3];
+                        corners[v] = glm::vec3(p[0], p[1], p[2]);
+                    }
 
-                // Adicionar vértices com normal e UV calculados
-                for (size_t v = 0; v < fv; v++) {
-                    tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-                    
-                    float vx = attrib.vertices[3 * idx.vertex_index + 0];
-                    float vy = attrib.vertices[3 * idx.vertex_index + 1];
-                    float vz = attrib.vertices[3 * idx.vertex_index + 2];
-
-                    vertices.push_back(vx); 
-                    vertices.push_back(vy); 
-                    vertices.push_back(vz);
-                    
-                    vertices.push_back(faceNormal.x);
-                    vertices.push_back(faceNormal.y);
-                    vertices.push_back(faceNormal.z);
-
-                    // UV mapping básico
-                    float scale = 0.01f; // Atualizado para 0.01f para corrigir o tiling
-                    if (isFloor) {
-                        vertices.push_back(vx * scale);
-                        vertices.push_back(vz * scale);
-                    } else {
-                        // Mapeamento planar para paredes (usar X ou Z dependendo da orientação da parede)
-                        // Heurística simples: se normal.x é maior, usa Z, senão usa X
-                        if (std::abs(faceNormal.x) > std::abs(faceNormal.z)) {
-                            vertices.push_back(vz * scale);
+                    // Calcular normal da face
+                    Triangle tri;
+                    tri.v0 = corners[0];
+                    tri.v1 = corners[1];
+                    tri.v2 = corners[2];
+                    glm::vec3 faceNormal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+                    tri.normal = faceNormal;
+                    tri.centroid = (tri.v0 + tri.v1 + tri.v2) / 3.0f;
+
+                    // Classificar como chão ou parede
+                    bool isFloor = (tri.normal.y > 0.7f);
+                    (isFloor ? blockFloors[b] : blockWalls[b]).push_back(tri);
+
+                    // Material do triângulo (o limiar de 0.5 é o que o shader usava para escolher a textura do chão)
+                    int materialId = mesh.materialIds[t];
+                    int layer = (materialId >= 0 && materialId < (int)materialLayers.size()) ? materialLayers[materialId] : -1;
+                    if (layer < 0) layer = faceNormal.y > 0.5f ? MATERIAL_FLOOR : MATERIAL_WALL;
+
+                    // Vértices com normal e UV calculados, já na posição final
+                    float* out = &vertices[t * 3 * VERTEX_FLOATS];
+                    for (const glm::vec3& c : corners) {
+                        *out++ = c.x;
+                        *out++ = c.y;
+                        *out++ = c.z;
+                        *out++ = faceNormal.x;
+                        *out++ = faceNormal.y;
+                        *out++ = faceNormal.z;
+
+                        // UV mapping básico
+                        float scale = 0.01f; // Atualizado para 0.01f para corrigir o tiling
+                        if (isFloor) {
+                            *out++ = c.x * scale;
+                            *out++ = c.z * scale;
                         } else {
-                            vertices.push_back(vx * scale);
+                            // Mapeamento planar para paredes (usar X ou Z dependendo da orientação da parede)
+                            // Heurística simples: se normal.x é maior, usa Z, senão usa X
+                            *out++ = (std::abs(faceNormal.x) > std::abs(faceNormal.z) ? c.z : c.x) * scale;
+                            *out++ = c.y * scale;
                         }
-                        vertices.push_back(vy * scale);
+                        *out++ = (float)layer;
                     }
                 }
+            }
+        });
 
-                index_offset += fv;
+        size_t floorCount = 0, wallCount = 0;
+        for (size_t b = 0; b < blockCount; b++) {
+            floorCount += blockFloors[b].size();
+            wallCount += blockWalls[b].size();
+        }
+        floorTriangles.reserve(floorTriangles.size() + floorCount);
+        wallTriangles.reserve(wallTriangles.size() + wallCount);
+        for (size_t b = 0; b < blockCount; b++) {
+            floorTriangles.insert(floorTriangles.end(), blockFloors[b].begin(), blockFloors[b].end());
+            wallTriangles.insert(wallTriangles.end(), blockWalls[b].begin(), blockWalls[b].end());
+        }
+        return true;
+    }
+
+    /**
+     * @brief Acrescenta quads (dois triângulos cada) com a mesma classificação e UVs de loadModel().
+     */
+    void addQuads(const std::vector<MazeGenerator::Quad>& quads) {
+        vertices.reserve(vertices.size() + quads.size() * 6 * VERTEX_FLOATS);
+        static const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+        const float scale = 0.01f;
+        for (const MazeGenerator::Quad& quad : quads) {
+            glm::vec3 normal = glm::normalize(glm::cross(quad.corners[1] - quad.corners[0], quad.corners[2] - quad.corners[0]));
+            for (int t = 0; t < 2; t++) {
+                Triangle tri;
+                tri.v0 = quad.corners[corners[t * 3]];
+                tri.v1 = quad.corners[corners[t * 3 + 1]];
+                tri.v2 = quad.corners[corners[t * 3 + 2]];
+                tri.normal = normal;
+                tri.centroid = (tri.v0 + tri.v1 + tri.v2) / 3.0f;
+                (quad.floor ? floorTriangles : wallTriangles).push_back(tri);
+
+                for (const glm::vec3& c : { tri.v0, tri.v1, tri.v2 }) {
+                    float u = quad.floor ? c.x : (std::abs(normal.x) > std::abs(normal.z) ? c.z : c.x);
+                    float v = quad.floor ? c.z : c.y;
+                    const float vertex[VERTEX_FLOATS] = { c.x, c.y, c.z, normal.x, normal.y, normal.z, u * scale, v * scale,
+                                                          (float)(quad.floor ? MATERIAL_FLOOR : MATERIAL_WALL) };
+                    vertices.insert(vertices.end(), vertex, vertex + VERTEX_FLOATS);
+                }
             }
         }
     }
 
     void addFloor() {
         float y = minBounds.y;
+        groundPlaneY = y;
         float expand = 100.0f; 
         float minX = minBounds.x - expand;
         float maxX = maxBounds.x + expand;
@@ -199,100 +385,358 @@ public:
             vertices.push_back(v0.x); vertices.push_back(v0.y); vertices.push_back(v0.z);
             vertices.push_back(0); vertices.push_back(1); vertices.push_back(0);
             vertices.push_back(v0.x * scale); vertices.push_back(v0.z * scale); // UV
+            vertices.push_back((float)MATERIAL_FLOOR);
 
             vertices.push_back(v1.x); vertices.push_back(v1.y); vertices.push_back(v1.z);
             vertices.push_back(0); vertices.push_back(1); vertices.push_back(0);
             vertices.push_back(v1.x * scale); vertices.push_back(v1.z * scale); // UV
+            vertices.push_back((float)MATERIAL_FLOOR);
 
             vertices.push_back(v2.x); vertices.push_back(v2.y); vertices.push_back(v2.z);
             vertices.push_back(0); vertices.push_back(1); vertices.push_back(0);
             vertices.push_back(v2.x * scale); vertices.push_back(v2.z * scale); // UV
+            vertices.push_back((float)MATERIAL_FLOOR);
+        };
+
+        // Um quad por chunk, para que o chão também seja descartado pelo frustum culling
+        auto edgeX = [&](int i) { return i == CHUNK_DIM ? maxX : minX + i * (maxX - minX) / CHUNK_DIM; };
+        auto edgeZ = [&](int j) { return j == CHUNK_DIM ? maxZ : minZ + j * (maxZ - minZ) / CHUNK_DIM; };
+        for (int i = 0; i < CHUNK_DIM; i++) {
+            for (int j = 0; j < CHUNK_DIM; j++) {
+                float x0 = edgeX(i), x1 = edgeX(i + 1);
+                float z0 = edgeZ(j), z1 = edgeZ(j + 1);
+                addTri(glm::vec3(x0, y, z1), glm::vec3(x1, y, z1), glm::vec3(x1, y, z0));
+                addTri(glm::vec3(x0, y, z1), glm::vec3(x1, y, z0), glm::vec3(x0, y, z0));
+            }
+        }
+    }
+
+    /**
+     * @brief Converte a lista de vértices não indexada em vértices únicos + index buffer.
+     *
+     * Vértices com posição, normal e UV idênticos são soldados; os triângulos são depois
+     * reordenados para a cache pós-transformação e os vértices pela ordem de primeiro uso.
+     */
+    void buildIndexBuffer() {
+        size_t originalCount = vertices.size() / VERTEX_FLOATS;
+        MeshOptimizer::weld(vertices, VERTEX_FLOATS, indices);
+        std::cout << "Vertices: " << originalCount << " -> " << vertices.size() / VERTEX_FLOATS << std::endl;
+    }
+
+    /**
+     * @brief Agrupa os triângulos do index buffer em chunks XZ e calcula a caixa de cada chunk.
+     *
+     * Cada triângulo pertence ao chunk do seu centroide. O index buffer é reordenado por chunk
+     * (mantendo os chunks contíguos), a ordem dentro de cada chunk é otimizada para a cache de
+     * vértices e por fim os vértices são reordenados pela ordem de primeiro uso.
+     */
+    void buildChunks() {
+        float chunkSizeX = std::max(maxBounds.x - minBounds.x, 0.1f) / CHUNK_DIM;
+        float chunkSizeZ = std::max(maxBounds.z - minBounds.z, 0.1f) / CHUNK_DIM;
+        size_t triCount = indices.size() / 3;
+        size_t vertexCount = vertices.size() / VERTEX_FLOATS;
+
+        auto position = [&](unsigned int idx) {
+            const float* v = &vertices[(size_t)idx * VERTEX_FLOATS];
+            return glm::vec3(v[0], v[1], v[2]);
         };
 
-        addTri(glm::vec3(minX, y, maxZ), glm::vec3(maxX, y, maxZ), glm::vec3(maxX, y, minZ));
-        addTri(glm::vec3(minX, y, maxZ), glm::vec3(maxX, y, minZ), glm::vec3(minX, y, minZ));
+        // Ordenação por contagem (estável) dos triângulos pelo chunk do centroide
+        std::vector<unsigned int> triChunk(triCount);
+        std::vector<unsigned int> chunkStart(CHUNK_DIM * CHUNK_DIM + 1, 0);
+        for (size_t t = 0; t < triCount; t++) {
+            glm::vec3 c = (position(indices[t * 3]) + position(indices[t * 3 + 1]) + position(indices[t * 3 + 2])) / 3.0f;
+            int cx = std::max(0, std::min(CHUNK_DIM - 1, (int)((c.x - minBounds.x) / chunkSizeX)));
+            int cz = std::max(0, std::min(CHUNK_DIM - 1, (int)((c.z - minBounds.z) / chunkSizeZ)));
+            triChunk[t] = (unsigned int)(cx * CHUNK_DIM + cz);
+            chunkStart[triChunk[t] + 1]++;
+        }
+        for (int c = 0; c < CHUNK_DIM * CHUNK_DIM; c++) chunkStart[c + 1] += chunkStart[c];
+
+        std::vector<unsigned int> sorted(indices.size());
+        std::vector<unsigned int> fill(chunkStart.begin(), chunkStart.end() - 1);
+        for (size_t t = 0; t < triCount; t++) {
+            unsigned int dst = fill[triChunk[t]]++;
+            for (int k = 0; k < 3; k++) sorted[dst * 3 + k] = indices[t * 3 + k];
+        }
+        indices.swap(sorted);
+
+        float acmrBefore = MeshOptimizer::acmr(indices, vertexCount);
+        chunks.clear();
+        // Cada chunk é otimizado com índices locais (densos), para não custar O(vértices) por chunk
+        std::vector<unsigned int> range, touched, local(vertexCount);
+        for (int c = 0; c < CHUNK_DIM * CHUNK_DIM; c++) {
+            unsigned int first = chunkStart[c] * 3, last = chunkStart[c + 1] * 3;
+            if (first == last) continue;
+
+            touched.assign(indices.begin() + first, indices.begin() + last);
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+            for (size_t k = 0; k < touched.size(); k++) local[touched[k]] = (unsigned int)k;
+            range.resize(last - first);
+            for (unsigned int i = first; i < last; i++) range[i - first] = local[indices[i]];
+            MeshOptimizer::optimizeVertexCache(range, touched.size());
+            for (unsigned int i = first; i < last; i++) indices[i] = touched[range[i - first]];
+
+            Chunk chunk;
+            chunk.minBounds = glm::vec3(std::numeric_limits<float>::max());
+            chunk.maxBounds = glm::vec3(std::numeric_limits<float>::lowest());
+            for (unsigned int i = first; i < last; i++) {
+                chunk.minBounds = glm::min(chunk.minBounds, position(indices[i]));
+                chunk.maxBounds = glm::max(chunk.maxBounds, position(indices[i]));
+            }
+            for (int level = 0; level < LOD_LEVELS; level++) {
+                chunk.indexOffset[level] = first;
+                chunk.indexCount[level] = last - first;
+            }
+            chunks.push_back(chunk);
+        }
+        MeshOptimizer::optimizeVertexFetch(vertices, VERTEX_FLOATS, indices);
+
+        std::cout << "Chunks: " << chunks.size() << " (ACMR " << acmrBefore << " -> "
+                  << MeshOptimizer::acmr(indices, vertexCount) << ")" << std::endl;
     }
 
+    /**
+     * @brief Gera os níveis de detalhe simplificados de cada chunk por agrupamento de vértices.
+     *
+     * No nível l, os vértices de um chunk que caem na mesma célula de lado LOD_CELL_SIZES[l]
+     * (grelha global), com a normal na mesma direção quantizada e o mesmo material, são
+     * fundidos num só (média dos atributos) e os triângulos degenerados desaparecem. Como
+     * superfícies com orientações diferentes nunca se fundem, as arestas e silhuetas das
+     * paredes mantêm-se. Os vértices partilhados com outro chunk ficam fixos, pelo que chunks
+     * vizinhos em níveis diferentes continuam a encaixar sem fendas.
+     */
+    void buildChunkLods() {
+        size_t baseVertexCount = vertices.size() / VERTEX_FLOATS;
+        const unsigned int SHARED = ~0u, UNUSED = ~0u - 1;
+        std::vector<unsigned int> owner(baseVertexCount, UNUSED);
+        for (size_t c = 0; c < chunks.size(); c++) {
+            for (unsigned int i = 0; i < chunks[c].indexCount[0]; i++) {
+                unsigned int& o = owner[indices[chunks[c].indexOffset[0] + i]];
+                o = (o == UNUSED || o == (unsigned int)c) ? (unsigned int)c : SHARED;
+            }
+        }
+
+        std::unordered_map<uint64_t, unsigned int> clusterOf;
+        std::unordered_map<unsigned int, unsigned int> remap;
+        std::vector<float> sums;
+        std::vector<unsigned int> counts, lodIndices;
+        size_t triangles[LOD_LEVELS] = {};
+        for (int level = 1; level < LOD_LEVELS; level++) {
+            float cell = LOD_CELL_SIZES[level];
+            for (size_t c = 0; c < chunks.size(); c++) {
+                Chunk& chunk = chunks[c];
+                clusterOf.clear();
+                remap.clear();
+                sums.clear();
+                counts.clear();
+                unsigned int first = chunk.indexOffset[0], count = chunk.indexCount[0];
+
+                // Agrupar os vértices do chunk
+                for (unsigned int i = first; i < first + count; i++) {
+                    unsigned int v = indices[i];
+                    if (remap.count(v)) continue;
+                    const float* p = &vertices[(size_t)v * VERTEX_FLOATS];
+                    uint64_t key;
+                    if (owner[v] == SHARED) {
+                        key = (1ull << 63) | v;
+                    } else {
+                        auto quantize = [&](int k) { return (uint64_t)std::min(65535, std::max(0, (int)((p[k] - minBounds[k]) / cell))); };
+                        auto bucket = [&](int k) { return (uint64_t)(std::lround(p[3 + k] * 2.0f) + 2); };   // 5 valores por eixo
+                        uint64_t normalBucket = (bucket(0) * 5 + bucket(1)) * 5 + bucket(2);
+                        key = quantize(0) | (quantize(1) << 16) | (quantize(2) << 32) | (normalBucket << 48) |
+                              ((uint64_t)std::min(255, (int)p[8]) << 55);
+                    }
+                    auto found = clusterOf.find(key);
+                    unsigned int cluster;
+                    if (found == clusterOf.end()) {
+                        cluster = (unsigned int)counts.size();
+                        clusterOf.emplace(key, cluster);
+                        counts.push_back(0);
+                        sums.insert(sums.end(), VERTEX_FLOATS, 0.0f);
+                    } else {
+                        cluster = found->second;
+                    }
+                    remap.emplace(v, cluster);
+                    counts[cluster]++;
+                    for (int k = 0; k < VERTEX_FLOATS; k++) sums[(size_t)cluster * VERTEX_FLOATS + k] += p[k];
+                }
+
+                // Um vértice novo por grupo (média; a normal é renormalizada e o material mantém-se)
+                unsigned int base = (unsigned int)(vertices.size() / VERTEX_FLOATS);
+                for (size_t g = 0; g < counts.size(); g++) {
+                    float* sum = &sums[g * VERTEX_FLOATS];
+                    for (int k = 0; k < VERTEX_FLOATS; k++) sum[k] /= counts[g];
+                    glm::vec3 n = glm::normalize(glm::vec3(sum[3], sum[4], sum[5]));
+                    sum[3] = n.x; sum[4] = n.y; sum[5] = n.z;
+                    sum[8] = std::round(sum[8]);
+                    vertices.insert(vertices.end(), sum, sum + VERTEX_FLOATS);
+                }
+
+                // Triângulos que sobrevivem (nem degenerados nem virados ao contrário)
+                lodIndices.clear();
+                for (unsigned int i = first; i < first + count; i += 3) {
+                    unsigned int a = base + remap[indices[i]], b = base + remap[indices[i + 1]], d = base + remap[indices[i + 2]];
+                    if (a == b || b == d || a == d) continue;
+                    glm::vec3 before = glm::cross(vertexPosition(indices[i + 1]) - vertexPosition(indices[i]),
+                                                  vertexPosition(indices[i + 2]) - vertexPosition(indices[i]));
+                    glm::vec3 after = glm::cross(vertexPosition(b) - vertexPosition(a), vertexPosition(d) - vertexPosition(a));
+                    if (glm::dot(before, after) <= 0.0f) continue;
+                    lodIndices.push_back(a);
+                    lodIndices.push_back(b);
+                    lodIndices.push_back(d);
+                }
+                // Otimizar só sobre os vértices novos do chunk (índices locais)
+                for (unsigned int& idx : lodIndices) idx -= base;
+                MeshOptimizer::optimizeVertexCache(lodIndices, counts.size());
+                for (unsigned int& idx : lodIndices) idx += base;
+                chunk.indexOffset[level] = (unsigned int)indices.size();
+                chunk.indexCount[level] = (unsigned int)lodIndices.size();
+                indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+                triangles[level] += lodIndices.size() / 3;
+            }
+        }
+        MeshOptimizer::optimizeVertexFetch(vertices, VERTEX_FLOATS, indices);
+
+        triangles[0] = 0;
+        for (const Chunk& chunk : chunks) triangles[0] += chunk.indexCount[0] / 3;
+        std::cout << "LOD: triangulos";
+        for (int level = 0; level < LOD_LEVELS; level++) std::cout << (level ? " -> " : " ") << triangles[level];
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Escolhe o nível de detalhe de cada chunk pela distância da câmara à sua caixa.
+     *
+     * O nível l cobre distâncias a partir de LOD_CELL_SIZES[l] * LOD_DISTANCE_PER_CELL. Um
+     * chunk só muda de nível quando sai desse intervalo alargado por LOD_HYSTERESIS, para
+     * não alternar entre níveis (popping) quando a câmara está perto de uma fronteira.
+     *
+     * @param viewPos Posição da câmara.
+     * @param enabled false põe todos os chunks no nível 0.
+     */
+    void selectLod(const glm::vec3& viewPos, bool enabled = true) {
+        chunkLod.resize(chunks.size(), 0);
+        for (size_t i = 0; i < chunks.size(); i++) {
+            if (!enabled) {
+                chunkLod[i] = 0;
+                continue;
+            }
+            glm::vec3 closest = glm::clamp(viewPos, chunks[i].minBounds, chunks[i].maxBounds);
+            float distance = glm::distance(viewPos, closest);
+            int level = chunkLod[i];
+            while (level + 1 < LOD_LEVELS && distance > LOD_CELL_SIZES[level + 1] * LOD_DISTANCE_PER_CELL * (1.0f + LOD_HYSTERESIS)) level++;
+            while (level > 0 && distance < LOD_CELL_SIZES[level] * LOD_DISTANCE_PER_CELL * (1.0f - LOD_HYSTERESIS)) level--;
+            chunkLod[i] = (unsigned char)level;
+        }
+    }
+
+    glm::vec3 vertexPosition(unsigned int v) const {
+        const float* p = &vertices[(size_t)v * VERTEX_FLOATS];
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    /// Nível de detalhe atual de um chunk (0 antes do primeiro selectLod()).
+    int lodOf(size_t chunk) const { return chunk < chunkLod.size() ? chunkLod[chunk] : 0; }
+
     void setupMesh() {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
 
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        if (packedVertices) {
+            std::vector<PackedVertex> packed = packVertices();
+            glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+        setupVertexAttributes(packedVertices);
+    }
 
-        // Position
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    /**
+     * @brief Configura os atributos (Position=0, Normal=1, TexCoords=2, Material=3) do VAO atualmente ligado.
+     * @param packed Formato PackedVertex em vez de floats intercalados.
+     */
+    static void setupVertexAttributes(bool packed) {
+        if (packed) {
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+            glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
+            glVertexAttribPointer(3, 1, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PackedVertex), (void*)(offsetof(PackedVertex, position) + 3 * sizeof(uint16_t)));
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(6 * sizeof(float)));
+            glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(8 * sizeof(float)));
+        }
         glEnableVertexAttribArray(0);
-        
-        // Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
-
-        // Texture Coords
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
+        glEnableVertexAttribArray(3);
     }
 
-    void initExitMarker() {
-        float cubeVertices[] = {
-            // Pos                  // Normal           // TexCoords
-            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-             0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-             0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-            -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-
-            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-             0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
-             0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-             0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-            -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-
-            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-            -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-            -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-             0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-             0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-             0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-             0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-             0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-             0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-
-            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-             0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-             0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-             -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-             -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
-        };
+    /**
+     * @brief Converte os vértices para PackedVertex e calcula os intervalos de desquantização.
+     *
+     * Os intervalos vêm dos próprios vértices (o chão de addFloor ultrapassa minBounds/maxBounds).
+     */
+    std::vector<PackedVertex> packVertices() {
+        size_t count = vertices.size() / VERTEX_FLOATS;
+        glm::vec3 pMin(std::numeric_limits<float>::max()), pMax(std::numeric_limits<float>::lowest());
+        glm::vec2 tMin(std::numeric_limits<float>::max()), tMax(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < count; i++) {
+            const float* v = &vertices[i * VERTEX_FLOATS];
+            pMin = glm::min(pMin, glm::vec3(v[0], v[1], v[2]));
+            pMax = glm::max(pMax, glm::vec3(v[0], v[1], v[2]));
+            tMin = glm::min(tMin, glm::vec2(v[6], v[7]));
+            tMax = glm::max(tMax, glm::vec2(v[6], v[7]));
+        }
+        packPosOffset = pMin;
+        packPosScale = glm::max(pMax - pMin, glm::vec3(1e-6f));
+        packUVOffset = tMin;
+        packUVScale = glm::max(tMax - tMin, glm::vec2(1e-6f));
 
-        glGenVertexArrays(1, &exitVAO);
-        glGenBuffers(1, &exitVBO);
+        auto unorm16 = [](float value, float offset, float scale) {
+            return (uint16_t)std::lround(std::min(std::max((value - offset) / scale, 0.0f), 1.0f) * 65535.0f);
+        };
+        auto snorm10 = [](float value) {
+            return (uint32_t)((int)std::lround(std::min(std::max(value, -1.0f), 1.0f) * 511.0f) & 0x3FF);
+        };
 
-        glBindVertexArray(exitVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, exitVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+        std::vector<PackedVertex> packed(count);
+        for (size_t i = 0; i < count; i++) {
+            const float* v = &vertices[i * VERTEX_FLOATS];
+            PackedVertex& p = packed[i];
+            for (int k = 0; k < 3; k++) p.position[k] = unorm16(v[k], packPosOffset[k], packPosScale[k]);
+            p.position[3] = (uint16_t)v[8];
+            p.normal = snorm10(v[3]) | (snorm10(v[4]) << 10) | (snorm10(v[5]) << 20);
+            p.texCoords[0] = unorm16(v[6], packUVOffset.x, packUVScale.x);
+            p.texCoords[1] = unorm16(v[7], packUVOffset.y, packUVScale.y);
+        }
+        return packed;
+    }
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+    /// Define os uniformes de desquantização do vertex shader (identidade para floats).
+    /// As localizações são resolvidas uma vez por programa: isto corre uma vez por chunk no occlusion culling.
+    void setVertexDequantization(Shader& shader, glm::vec3 posOffset, glm::vec3 posScale, glm::vec2 uvOffset, glm::vec2 uvScale) {
+        if (dequantization.program != shader.ID) {
+            dequantization.program = shader.ID;
+            dequantization.posOffset = shader.getUniformLocation("posOffset");
+            dequantization.posScale = shader.getUniformLocation("posScale");
+            dequantization.uvOffset = shader.getUniformLocation("uvOffset");
+            dequantization.uvScale = shader.getUniformLocation("uvScale");
+        }
+        shader.setVec3(dequantization.posOffset, posOffset);
+        shader.setVec3(dequantization.posScale, posScale);
+        shader.setVec2(dequantization.uvOffset, uvOffset);
+        shader.setVec2(dequantization.uvScale, uvScale);
     }
 
     void calculateBounds() {
@@ -303,7 +747,7 @@ public:
         float maxY = std::numeric_limits<float>::lowest();
         float maxZ = std::numeric_limits<float>::lowest();
 
-        for (size_t i = 0; i < vertices.size(); i += 8) { // Atualizado para stride 8
+        for (size_t i = 0; i < vertices.size(); i += VERTEX_FLOATS) {
             float x = vertices[i];
             float y = vertices[i+1];
             float z = vertices[i+2];
@@ -330,20 +774,144 @@ public:
 
     void draw(Shader& shader) {
         // shader.setVec3("objectColor", 0.7f, 0.7f, 0.7f); 
+        setVertexDequantization(shader, packPosOffset, packPosScale, packUVOffset, packUVScale);
         glBindVertexArray(VAO);
-        // Dividir por 8 agora em vez de 6 ou usar apenas vertices.size() / 8
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 8);
+        // Só o nível 0: os índices dos níveis simplificados vêm depois do último chunk
+        GLsizei count = chunks.empty() ? (GLsizei)indices.size()
+                                       : (GLsizei)(chunks.back().indexOffset[0] + chunks.back().indexCount[0]);
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)0);
     }
 
-    void drawExit(Shader& shader) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, exitPosition);
-        model = glm::scale(model, glm::vec3(5.0f));
-        shader.setMat4("model", model);
-        shader.setVec3("objectColor", 0.0f, 1.0f, 0.0f);
-        
-        glBindVertexArray(exitVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+    /**
+     * @brief Desenha apenas os chunks que intersetam o frustum da câmara.
+     *
+     * Chunks visíveis contíguos no index buffer são juntos numa só sub-chamada, e todos são
+     * submetidos com um único glMultiDrawElements.
+     *
+     * @param shader Shader de iluminação (já ativo).
+     * @param frustum Frustum de projection * view.
+     */
+    void draw(Shader& shader, const Frustum& frustum) {
+        setVertexDequantization(shader, packPosOffset, packPosScale, packUVOffset, packUVScale);
+
+        drawCounts.clear();
+        drawOffsets.clear();
+        visibleChunks = 0;
+        unsigned int lastEnd = ~0u;
+        for (const Chunk& chunk : chunks) {
+            if (!frustum.intersectsAABB(chunk.minBounds, chunk.maxBounds)) continue;
+            visibleChunks++;
+            int level = lodOf(&chunk - chunks.data());
+            if (chunk.indexOffset[level] == lastEnd) {
+                drawCounts.back() += (GLsizei)chunk.indexCount[level];
+            } else {
+                drawCounts.push_back((GLsizei)chunk.indexCount[level]);
+                drawOffsets.push_back((const void*)(chunk.indexOffset[level] * sizeof(unsigned int)));
+            }
+            lastEnd = chunk.indexOffset[level] + chunk.indexCount[level];
+        }
+        if (drawCounts.empty()) return;
+
+        glBindVertexArray(VAO);
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), (GLsizei)drawCounts.size());
+    }
+
+    /**
+     * @brief Desenha os chunks dentro do frustum usando occlusion queries de hardware.
+     *
+     * 1. Os chunks visíveis no frame anterior são desenhados normalmente (servem de oclusores).
+     * 2. Para todos os chunks do frustum é emitida uma query sobre a sua caixa (sem escrita de cor
+     *    nem de profundidade), contra a profundidade já escrita. O resultado decide a visibilidade
+     *    no frame seguinte.
+     * 3. Os chunks que estavam ocultos são desenhados com conditional rendering sobre a sua query,
+     *    pelo que aparecem no próprio frame em que ficam visíveis (sem "popping").
+     *
+     * @param shader Shader de iluminação (já ativo).
+     * @param frustum Frustum de projection * view.
+     * @param viewPos Posição da câmara (chunks que a contêm são sempre visíveis).
+     */
+    void drawOcclusionCulled(Shader& shader, const Frustum& frustum, const glm::vec3& viewPos) {
+        if (chunkOcclusion.size() != chunks.size()) initOcclusionQueries();
+
+        const float boxMargin = 2.0f; // Evita z-fighting entre a caixa e as faces do próprio chunk
+        frameChunks.clear();
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ChunkOcclusion& occ = chunkOcclusion[i];
+            if (occ.pending) {
+                GLuint available = 0;
+                glGetQueryObjectuiv(occ.query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint samplesPassed = 0;
+                    glGetQueryObjectuiv(occ.query, GL_QUERY_RESULT, &samplesPassed);
+                    occ.visible = samplesPassed != 0;
+                    occ.pending = false;
+                }
+            }
+            if (!frustum.intersectsAABB(chunks[i].minBounds, chunks[i].maxBounds)) {
+                occ.visible = false;
+                continue;
+            }
+            glm::vec3 lo = chunks[i].minBounds - glm::vec3(boxMargin * 4.0f);
+            glm::vec3 hi = chunks[i].maxBounds + glm::vec3(boxMargin * 4.0f);
+            if (viewPos.x >= lo.x && viewPos.y >= lo.y && viewPos.z >= lo.z &&
+                viewPos.x <= hi.x && viewPos.y <= hi.y && viewPos.z <= hi.z) {
+                occ.visible = true;
+            }
+            frameChunks.push_back((unsigned int)i);
+        }
+
+        // 1. Oclusores: chunks visíveis no frame anterior
+        setVertexDequantization(shader, packPosOffset, packPosScale, packUVOffset, packUVScale);
+        drawCounts.clear();
+        drawOffsets.clear();
+        unsigned int lastEnd = ~0u;
+        visibleChunks = 0;
+        for (unsigned int i : frameChunks) {
+            if (!chunkOcclusion[i].visible) continue;
+            visibleChunks++;
+            int level = lodOf(i);
+            if (chunks[i].indexOffset[level] == lastEnd) {
+                drawCounts.back() += (GLsizei)chunks[i].indexCount[level];
+            } else {
+                drawCounts.push_back((GLsizei)chunks[i].indexCount[level]);
+                drawOffsets.push_back((const void*)(chunks[i].indexOffset[level] * sizeof(unsigned int)));
+            }
+            lastEnd = chunks[i].indexOffset[level] + chunks[i].indexCount[level];
+        }
+        glBindVertexArray(VAO);
+        if (!drawCounts.empty()) {
+            glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), (GLsizei)drawCounts.size());
+        }
+
+        // 2. Queries sobre as caixas de todos os chunks do frustum
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(boxVAO);
+        for (unsigned int i : frameChunks) {
+            glm::vec3 lo = chunks[i].minBounds - glm::vec3(boxMargin);
+            glm::vec3 hi = chunks[i].maxBounds + glm::vec3(boxMargin);
+            setVertexDequantization(shader, lo, hi - lo, glm::vec2(0.0f), glm::vec2(1.0f));
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, chunkOcclusion[i].query);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            chunkOcclusion[i].pending = true;
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+
+        // 3. Chunks antes ocultos: desenhados apenas se a caixa passou o teste de profundidade
+        setVertexDequantization(shader, packPosOffset, packPosScale, packUVOffset, packUVScale);
+        glBindVertexArray(VAO);
+        occludedChunks = 0;
+        for (unsigned int i : frameChunks) {
+            if (chunkOcclusion[i].visible) continue;
+            occludedChunks++;
+            int level = lodOf(i);
+            glBeginConditionalRender(chunkOcclusion[i].query, GL_QUERY_WAIT);
+            glDrawElements(GL_TRIANGLES, (GLsizei)chunks[i].indexCount[level], GL_UNSIGNED_INT,
+                           (void*)(chunks[i].indexOffset[level] * sizeof(unsigned int)));
+            glEndConditionalRender();
+        }
     }
 
     void setRandomStartAndExit() {
@@ -354,7 +922,7 @@ public:
         glm::vec3 center(0.0f, 0.0f, 0.0f);
         
         for(const auto& tri : floorTriangles) {
-            if (tri.centroid.y <= minBounds.y + 1.0f) continue;
+            if (tri.centroid.y <= groundPlaneY + 1.0f) continue;
 
             float d = glm::distance(glm::vec2(tri.centroid.x, tri.centroid.z), glm::vec2(center.x, center.z));
             if (d < minStartDist) {
@@ -371,161 +939,426 @@ public:
         std::cout << "Saida: " << exitPosition.x << " " << exitPosition.y << " " << exitPosition.z << std::endl;
     }
 
-    // Constantes e Membros da Grelha Espacial
-    static const int GRID_DIM = 128;
-    std::vector<size_t> z_wallGrid[GRID_DIM][GRID_DIM];
-    std::vector<size_t> z_floorGrid[GRID_DIM][GRID_DIM];
-    float z_gridCellSizeX = 1.0f;
-    float z_gridCellSizeZ = 1.0f;
-
-    void buildSpatialGrid() {
-        float width = maxBounds.x - minBounds.x;
-        float depth = maxBounds.z - minBounds.z;
-        if (width < 0.1f) width = 1.0f;
-        if (depth < 0.1f) depth = 1.0f;
-        
-        z_gridCellSizeX = width / GRID_DIM;
-        z_gridCellSizeZ = depth / GRID_DIM;
-        
-        // Preencher Grelha de Paredes
-        for(size_t i = 0; i < wallTriangles.size(); i++) {
-             addTriangleToGrid(wallTriangles[i], i, z_wallGrid);
+    /**
+     * @brief Posições para tochas: no máximo uma por célula XZ de lado spacing, sobre o chão do labirinto.
+     *
+     * Em cada célula é escolhido o triângulo de chão (excluindo o plano de addFloor) mais
+     * próximo do centro da célula; a tocha fica height unidades acima do seu centroide.
+     */
+    std::vector<glm::vec3> torchPositions(float spacing, float height) const {
+        int cellsX = std::max(1, (int)((maxBounds.x - minBounds.x) / spacing));
+        int cellsZ = std::max(1, (int)((maxBounds.z - minBounds.z) / spacing));
+        std::vector<const Triangle*> best(cellsX * cellsZ, nullptr);
+        std::vector<float> bestDistance(cellsX * cellsZ, std::numeric_limits<float>::max());
+        for (const Triangle& tri : floorTriangles) {
+            if (tri.centroid.y <= groundPlaneY + 1.0f) continue;
+            int cx = std::min(cellsX - 1, std::max(0, (int)((tri.centroid.x - minBounds.x) / spacing)));
+            int cz = std::min(cellsZ - 1, std::max(0, (int)((tri.centroid.z - minBounds.z) / spacing)));
+            glm::vec2 cellCenter(minBounds.x + (cx + 0.5f) * spacing, minBounds.z + (cz + 0.5f) * spacing);
+            float d = glm::distance(glm::vec2(tri.centroid.x, tri.centroid.z), cellCenter);
+            int cell = cx * cellsZ + cz;
+            if (d < bestDistance[cell]) {
+                bestDistance[cell] = d;
+                best[cell] = &tri;
+            }
         }
-        
-        // Preencher Grelha de Chão
-        for(size_t i = 0; i < floorTriangles.size(); i++) {
-             addTriangleToGrid(floorTriangles[i], i, z_floorGrid);
+
+        std::vector<glm::vec3> positions;
+        for (const Triangle* tri : best) {
+            if (tri) positions.push_back(tri->centroid + glm::vec3(0.0f, height, 0.0f));
         }
+        return positions;
     }
-    
-    void addTriangleToGrid(const Triangle& tri, size_t idx, std::vector<size_t> (&grid)[GRID_DIM][GRID_DIM]) {
-         float minX = std::min({tri.v0.x, tri.v1.x, tri.v2.x});
-         float maxX = std::max({tri.v0.x, tri.v1.x, tri.v2.x});
-         float minZ = std::min({tri.v0.z, tri.v1.z, tri.v2.z});
-         float maxZ = std::max({tri.v0.z, tri.v1.z, tri.v2.z});
-         
-         int startX = (int)((minX - minBounds.x) / z_gridCellSizeX);
-         int endX   = (int)((maxX - minBounds.x) / z_gridCellSizeX);
-         int startZ = (int)((minZ - minBounds.z) / z_gridCellSizeZ);
-         int endZ   = (int)((maxZ - minBounds.z) / z_gridCellSizeZ);
-         
-         // Limitar indices (Clamp)
-         startX = std::max(0, std::min(GRID_DIM-1, startX));
-         endX   = std::max(0, std::min(GRID_DIM-1, endX));
-         startZ = std::max(0, std::min(GRID_DIM-1, startZ));
-         endZ   = std::max(0, std::min(GRID_DIM-1, endZ));
-         
-         for(int x = startX; x <= endX; x++) {
-             for(int z = startZ; z <= endZ; z++) {
-                 grid[x][z].push_back(idx);
-             }
-         }
+
+    // Estruturas de Aceleração para Colisões
+    BVH wallBVH;    ///< BVH sobre wallTriangles (que fica ordenado pelas folhas da árvore)
+    BVH floorBVH;   ///< BVH sobre floorTriangles (que fica ordenado pelas folhas da árvore)
+    static constexpr float MAX_STEP_HEIGHT = 15.0f;   ///< Maior subida de chão aceite num passo (degraus mais altos bloqueiam)
+    static const size_t BATCH_GRAIN = 256;  ///< Consultas por tarefa nas versões em lote
+    static const size_t LOAD_GRAIN = 4096;  ///< Triângulos por tarefa em loadModel()
+    WallCollisionData wallData;     ///< Dados de colisão pré-calculados de wallTriangles (mesma ordem)
+    FloorCollisionData floorData;   ///< Dados de altura pré-calculados de floorTriangles (mesma ordem)
+
+    /**
+     * @brief Constrói as BVHs de paredes e chão e reordena os triângulos pela ordem das folhas.
+     *
+     * Ao contrário de uma grelha fixa, a árvore adapta-se à distribuição dos triângulos, pelo
+     * que o custo das consultas cresce de forma logarítmica com o tamanho do nível.
+     */
+    void buildCollisionBVH() {
+        // O teste de parede aceita pontos até 1% (em coordenadas paramétricas) fora
+        // do triângulo; as caixas das paredes são alargadas para incluir essa margem
+        buildBVH(wallTriangles, wallBVH, 0.03f);
+        buildBVH(floorTriangles, floorBVH, 0.0f);
     }
 
+    /**
+     * @param edgeMargin Alargamento das caixas, em fração da maior aresta do triângulo.
+     */
+    void buildBVH(std::vector<Triangle>& triangles, BVH& bvh, float edgeMargin) {
+        std::vector<glm::vec3> triMin(triangles.size()), triMax(triangles.size());
+        for (size_t i = 0; i < triangles.size(); i++) {
+            const Triangle& tri = triangles[i];
+            float maxEdge = std::max({glm::length(tri.v1 - tri.v0), glm::length(tri.v2 - tri.v0), glm::length(tri.v2 - tri.v1)});
+            glm::vec3 margin(edgeMargin * maxEdge);
+            triMin[i] = glm::min(glm::min(tri.v0, tri.v1), tri.v2) - margin;
+            triMax[i] = glm::max(glm::max(tri.v0, tri.v1), tri.v2) + margin;
+        }
+        std::vector<uint32_t> order;
+        bvh.build(triMin, triMax, order);
 
+        std::vector<Triangle> sorted(triangles.size());
+        for (size_t i = 0; i < order.size(); i++) sorted[i] = triangles[order[i]];
+        triangles.swap(sorted);
+    }
+
+    /**
+     * @brief Pré-calcula os dados de colisão (planos, arestas, determinantes) dos triângulos.
+     *
+     * Feito uma vez no arranque, depois de os triângulos estarem na ordem das folhas da BVH.
+     */
+    void buildCollisionData() {
+        wallData.clear();
+        wallData.reserve(wallTriangles.size() + WallCollisionData::SIMD_PADDING);
+        for (const Triangle& tri : wallTriangles) wallData.add(tri.v0, tri.v1, tri.v2);
+        wallData.finish();
+
+        floorData.clear();
+        floorData.reserve(floorTriangles.size() + FloorCollisionData::SIMD_PADDING);
+        for (const Triangle& tri : floorTriangles) floorData.add(tri.v0, tri.v1, tri.v2, tri.normal.y);
+        floorData.finish();
+    }
+
+    /**
+     * @brief Bytes de CPU ocupados pela geometria, triângulos, BVHs e dados de colisão (capacidade dos vetores).
+     *
+     * Não inclui os buffers na GPU nem o estado por frame (LOD, occlusion, listas de desenho).
+     */
+    size_t memoryBytes() const {
+        return vertices.capacity() * sizeof(float) + indices.capacity() * sizeof(unsigned int) +
+               chunks.capacity() * sizeof(Chunk) +
+               (floorTriangles.capacity() + wallTriangles.capacity()) * sizeof(Triangle) +
+               (wallBVH.nodes.capacity() + floorBVH.nodes.capacity()) * sizeof(BVH::Node) +
+               wallData.memoryBytes() + floorData.memoryBytes();
+    }
 
     float getFloorHeight(glm::vec3 pos, bool checkSlope = true) {
-        if (z_gridCellSizeX <= 0 || z_gridCellSizeZ <= 0) return -99999.0f;
-        
-        int gx = (int)((pos.x - minBounds.x) / z_gridCellSizeX);
-        int gz = (int)((pos.z - minBounds.z) / z_gridCellSizeZ);
-        
         float bestY = -std::numeric_limits<float>::max();
         bool found = false;
         const float MAX_WALKABLE_SLOPE = 0.5f;
-
-        // Verificar vizinhança 3x3
-        int range = 1;
-
-        for(int x = gx - range; x <= gx + range; x++) {
-            for(int z = gz - range; z <= gz + range; z++) {
-                if(x >= 0 && x < GRID_DIM && z >= 0 && z < GRID_DIM) {
-                    for(size_t idx : z_floorGrid[x][z]) {
-                        const auto& tri = floorTriangles[idx];
-                        if (checkSlope && tri.normal.y < MAX_WALKABLE_SLOPE) continue;
-                        
-                        float u, v, w;
-                        barycentric(glm::vec2(pos.x, pos.z), 
-                                    glm::vec2(tri.v0.x, tri.v0.z), 
-                                    glm::vec2(tri.v1.x, tri.v1.z), 
-                                    glm::vec2(tri.v2.x, tri.v2.z), u, v, w);
-                        
-                        if (u >= 0 && v >= 0 && w >= 0) {
-                            float height = u * tri.v0.y + v * tri.v1.y + w * tri.v2.y;
-                            if (height > bestY) {
-                                bestY = height;
-                                found = true;
-                            }
-                        }
+        float minNormalY = checkSlope ? MAX_WALKABLE_SLOPE : std::numeric_limits<float>::lowest();
+
+        // Coluna vertical em (x, z): apenas folhas cuja caixa contém o ponto em XZ.
+        // Cada folha é testada 4 triângulos de cada vez (o padding garante leituras válidas).
+        glm::vec3 queryMin(pos.x, std::numeric_limits<float>::lowest(), pos.z);
+        glm::vec3 queryMax(pos.x, std::numeric_limits<float>::max(), pos.z);
+        floorBVH.query(queryMin, queryMax, [&](uint32_t first, uint32_t count) {
+            for (uint32_t k = 0; k < count; k += 4) {
+                float heights[4];
+                int mask = floorData.heightAt4(first + k, pos.x, pos.z, minNormalY, heights) & simd::firstLanes(count - k);
+                for (int lane = 0; mask; lane++, mask >>= 1) {
+                    if ((mask & 1) && heights[lane] > bestY) {
+                        bestY = heights[lane];
+                        found = true;
                     }
                 }
             }
-        }
+            return false;
+        });
         
         if (!found) return -99999.0f;
         return bestY;
     }
 
     bool checkWallCollision(glm::vec3 position, float radius = 1.0f) {
-        if (z_gridCellSizeX <= 0 || z_gridCellSizeZ <= 0) return false;
+        // Apenas folhas cuja caixa interseta a caixa da esfera
+        return wallBVH.query(position - glm::vec3(radius), position + glm::vec3(radius), [&](uint32_t first, uint32_t count) {
+            for (uint32_t k = 0; k < count; k += 4) {
+                if (wallData.intersectsSphere4(first + k, position, radius) & simd::firstLanes(count - k))
+                    return true;
+            }
+            return false;
+        });
+    }
 
-        int gx = (int)((position.x - minBounds.x) / z_gridCellSizeX);
-        int gz = (int)((position.z - minBounds.z) / z_gridCellSizeZ);
-        
-        // Intervalo dinâmico baseado no raio para garantir que verificamos todas as células relevantes
-        int rangeX = (int)(radius / z_gridCellSizeX) + 1;
-        int rangeZ = (int)(radius / z_gridCellSizeZ) + 1;
-        
-        for(int x = gx - rangeX; x <= gx + rangeX; x++) {
-            for(int z = gz - rangeZ; z <= gz + rangeZ; z++) {
-                if(x >= 0 && x < GRID_DIM && z >= 0 && z < GRID_DIM) {
-                    for(size_t idx : z_wallGrid[x][z]) {
-                        if (checkTriangleCollision(position, radius, wallTriangles[idx].v0, wallTriangles[idx].v1, wallTriangles[idx].v2)) 
-                            return true;
-                    }
+    /**
+     * @brief Versão em lote de checkWallCollision(): uma esfera por posição.
+     *
+     * As estruturas de colisão são só de leitura depois da construção, pelo que os blocos
+     * correm em paralelo sem sincronização.
+     *
+     * @param positions Centros das esferas (count elementos).
+     * @param radii Raios (count elementos), ou nullptr para usar radius em todas.
+     * @param results Saída: results[i] indica se a esfera i toca uma parede.
+     * @param pool Pool onde distribuir o trabalho; nullptr corre na thread atual.
+     */
+    void checkWallCollisionBatch(const glm::vec3* positions, const float* radii, size_t count, bool* results,
+                                 ThreadPool* pool = nullptr, float radius = 1.0f) {
+        auto run = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) results[i] = checkWallCollision(positions[i], radii ? radii[i] : radius);
+        };
+        if (pool) pool->parallelFor(count, BATCH_GRAIN, run);
+        else run(0, count);
+    }
+
+    /**
+     * @brief Versão em lote de getFloorHeight().
+     *
+     * @param heights Saída: altura do chão sob cada posição (-99999 se não houver chão).
+     * @param pool Pool onde distribuir o trabalho; nullptr corre na thread atual.
+     */
+    void getFloorHeightBatch(const glm::vec3* positions, size_t count, float* heights,
+                             ThreadPool* pool = nullptr, bool checkSlope = true) {
+        auto run = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) heights[i] = getFloorHeight(positions[i], checkSlope);
+        };
+        if (pool) pool->parallelFor(count, BATCH_GRAIN, run);
+        else run(0, count);
+    }
+
+    /**
+     * @struct SweepHit
+     * @brief Primeiro contacto de uma esfera em movimento com as paredes.
+     */
+    struct SweepHit {
+        float t = 1.0f;         ///< Fração do deslocamento percorrida até ao contacto, em [0, 1]
+        glm::vec3 normal;       ///< Normal de contacto (aponta para fora da parede)
+    };
+
+    /**
+     * @brief Desloca uma esfera de start até start + delta e devolve o primeiro contacto com as paredes.
+     *
+     * Teste contínuo (face, arestas e vértices): ao contrário de checkWallCollision() em
+     * posições discretas, não deixa atravessar paredes finas em deslocamentos longos.
+     *
+     * @return true se houve contacto; hit fica com o instante e a normal.
+     */
+    bool sweepSphere(const glm::vec3& start, const glm::vec3& delta, float radius, SweepHit& hit) {
+        glm::vec3 end = start + delta;
+        glm::vec3 queryMin = glm::min(start, end) - glm::vec3(radius);
+        glm::vec3 queryMax = glm::max(start, end) + glm::vec3(radius);
+        bool found = false;
+        hit.t = 1.0f;
+        wallBVH.query(queryMin, queryMax, [&](uint32_t first, uint32_t count) {
+            for (uint32_t k = first; k < first + count; k++) {
+                float t;
+                glm::vec3 normal;
+                if (wallData.sweepSphere(k, start, delta, radius, found ? hit.t : 1.0f, t, normal)) {
+                    hit.t = t;
+                    hit.normal = normal;
+                    found = true;
                 }
             }
+            return false;
+        });
+        return found;
+    }
+
+    /**
+     * @brief Move uma esfera com resposta de deslizamento: em cada contacto, o resto do
+     * deslocamento é projetado no plano tangente e o varrimento repete-se.
+     *
+     * @param maxIterations Número máximo de contactos tratados (3 chega para cantos).
+     * @return Posição final.
+     */
+    glm::vec3 moveAndSlide(glm::vec3 position, glm::vec3 delta, float radius, int maxIterations = 3) {
+        return slide(position, delta, radius, maxIterations,
+                     [this](const glm::vec3& start, const glm::vec3& d, float r, SweepHit& hit) { return sweepSphere(start, d, r, hit); });
+    }
+
+    /**
+     * @brief Ciclo de moveAndSlide() sobre um teste de varrimento qualquer (por exemplo várias páginas).
+     * @param sweep Função bool(start, delta, radius, SweepHit&) com a semântica de sweepSphere().
+     */
+    template <typename Sweep>
+    static glm::vec3 slide(glm::vec3 position, glm::vec3 delta, float radius, int maxIterations, Sweep&& sweep) {
+        const float SKIN = 0.05f;   // Distância mantida à parede, evita começar o varrimento seguinte em contacto
+        for (int i = 0; i < maxIterations; i++) {
+            float length = glm::length(delta);
+            if (length < 1e-4f) break;
+
+            SweepHit hit;
+            if (!sweep(position, delta, radius, hit)) {
+                position += delta;
+                break;
+            }
+            glm::vec3 direction = delta / length;
+            position += direction * std::max(0.0f, hit.t * length - SKIN);
+
+            glm::vec3 remaining = delta * (1.0f - hit.t);
+            delta = remaining - hit.normal * glm::dot(remaining, hit.normal);
         }
-        return false;
+        return position;
+    }
+
+    /**
+     * @brief Carrega da cache binária os vértices, índices, chunks (com os níveis de detalhe),
+     * triângulos de chão e parede, as duas BVHs, os materiais e os limites.
+     *
+     * Os dados SoA de colisão não vão para a cache: são refeitos pelo chamador com buildCollisionData().
+     *
+     * @return false se a cache não existir, for de outra versão, não corresponder ao OBJ ou
+     *         tiver BVHs, índices ou chunks inconsistentes (os vetores ficam vazios).
+     */
+    bool loadCache(const std::string& cachePath, const std::string& sourcePath) {
+        MazeCache cache;
+        if (!cache.open(cachePath, sourcePath)) return false;
+
+        CacheMeta meta;
+        std::vector<char> materialNames;
+        if (!cache.readValue(MazeCache::TAG_META, meta) ||
+            !cache.read(MazeCache::TAG_VERTICES, vertices) ||
+            !cache.read(MazeCache::TAG_INDICES, indices) ||
+            !cache.read(MazeCache::TAG_CHUNKS, chunks) ||
+            !cache.read(MazeCache::TAG_FLOOR, floorTriangles) ||
+            !cache.read(MazeCache::TAG_WALLS, wallTriangles) ||
+            !cache.read(MazeCache::TAG_WALL_BVH, wallBVH.nodes) ||
+            !cache.read(MazeCache::TAG_FLOOR_BVH, floorBVH.nodes) ||
+            !validBVH(wallBVH, wallTriangles.size()) ||
+            !cache.read(MazeCache::TAG_MATERIALS, materialNames) ||
+            !validBVH(floorBVH, floorTriangles.size()) ||
+            !validGeometry()) {
+            vertices.clear();
+            indices.clear();
+            chunks.clear();
+            floorTriangles.clear();
+            wallTriangles.clear();
+            wallBVH.nodes.clear();
+            floorBVH.nodes.clear();
+            return false;
+        }
+
+        materialTextures.clear();
+        std::string name;
+        for (char c : materialNames) {
+            if (c != '\n') { name += c; continue; }
+            materialTextures.push_back(name);
+            name.clear();
+        }
+
+        minBounds = meta.minBounds;
+        maxBounds = meta.maxBounds;
+        modelSize = meta.modelSize;
+        groundPlaneY = meta.groundPlaneY;
+        std::cout << "Labirinto carregado da cache: " << cachePath << std::endl;
+        return true;
+    }
+
+    /// Escreve o estado processado do labirinto para a cache binária.
+    bool saveCache(const std::string& cachePath, const std::string& sourcePath) {
+        CacheMeta meta;
+        meta.minBounds = minBounds;
+        meta.maxBounds = maxBounds;
+        meta.modelSize = modelSize;
+        meta.groundPlaneY = groundPlaneY;
+
+        std::vector<char> materialNames;
+        for (const std::string& name : materialTextures) {
+            materialNames.insert(materialNames.end(), name.begin(), name.end());
+            materialNames.push_back('\n');
+        }
+
+        MazeCache::Writer writer;
+        writer.addValue(MazeCache::TAG_META, meta);
+        writer.add(MazeCache::TAG_VERTICES, vertices);
+        writer.add(MazeCache::TAG_INDICES, indices);
+        writer.add(MazeCache::TAG_CHUNKS, chunks);
+        writer.add(MazeCache::TAG_FLOOR, floorTriangles);
+        writer.add(MazeCache::TAG_WALLS, wallTriangles);
+        writer.add(MazeCache::TAG_WALL_BVH, wallBVH.nodes);
+        writer.add(MazeCache::TAG_FLOOR_BVH, floorBVH.nodes);
+        writer.add(MazeCache::TAG_MATERIALS, materialNames);
+        if (!writer.write(cachePath, sourcePath)) {
+            std::cout << "Aviso: nao foi possivel escrever a cache " << cachePath << std::endl;
+            return false;
+        }
+        return true;
     }
 
 private:
-    void barycentric(glm::vec2 p, glm::vec2 a, glm::vec2 b, glm::vec2 c, float &u, float &v, float &w) {
-        glm::vec2 v0 = b - a, v1 = c - a, v2 = p - a;
-        float d00 = glm::dot(v0, v0);
-        float d01 = glm::dot(v0, v1);
-        float d11 = glm::dot(v1, v1);
-        float d20 = glm::dot(v2, v0);
-        float d21 = glm::dot(v2, v1);
-        float denom = d00 * d11 - d01 * d01;
-        if (std::abs(denom) < 1e-6) { u = -1; v = -1; w = -1; return; }
-        v = (d11 * d20 - d01 * d21) / denom;
-        w = (d00 * d21 - d01 * d20) / denom;
-        u = 1.0f - v - w;
-    }
-
-    bool checkTriangleCollision(glm::vec3 sphereCenter, float sphereRadius, glm::vec3 v0, glm::vec3 v1, glm::vec3 v2) {
-        glm::vec3 N = glm::normalize(glm::cross(v1 - v0, v2 - v0));
-        float dist = glm::dot(sphereCenter - v0, N);
-        if (std::abs(dist) > sphereRadius) return false;
-        glm::vec3 P = sphereCenter - dist * N;
-        
-        glm::vec3 u = v1 - v0;
-        glm::vec3 v = v2 - v0;
-        glm::vec3 w = P - v0;
-        float uu = glm::dot(u, u);
-        float uv = glm::dot(u, v);
-        float vv = glm::dot(v, v);
-        float wu = glm::dot(w, u);
-        float wv = glm::dot(w, v);
-        float D = uv * uv - uu * vv;
-        if (std::abs(D) < 1e-6) return false;
-        float s = (uv * wv - vv * wu) / D;
-        float t = (uv * wu - uu * wv) / D;
-        
-        // Usar um pequeno epsilon para evitar passar pelas frestas entre triângulos
-        float epsilon = -0.01f; 
-        return (s >= epsilon && t >= epsilon && (s + t) <= 1.0f - epsilon);
+    std::vector<GLsizei> drawCounts;        ///< Contagens para glMultiDrawElements (reutilizado entre frames)
+    std::vector<const void*> drawOffsets;   ///< Offsets para glMultiDrawElements (reutilizado entre frames)
+    std::vector<unsigned int> frameChunks;  ///< Chunks dentro do frustum no frame atual
+
+    /// Localizações dos uniformes de desquantização do último programa usado.
+    struct DequantizationUniforms {
+        unsigned int program = 0;
+        GLint posOffset = -1, posScale = -1, uvOffset = -1, uvScale = -1;
+    };
+    DequantizationUniforms dequantization;
+
+    /// Cria uma query por chunk e o cubo unitário usado como proxy.
+    void initOcclusionQueries() {
+        chunkOcclusion.assign(chunks.size(), ChunkOcclusion());
+        for (ChunkOcclusion& occ : chunkOcclusion) glGenQueries(1, &occ.query);
+
+        if (boxVAO == 0) {
+            float cube[36 * 3];
+            // 12 triângulos do cubo [0,1]^3 a partir dos 8 cantos
+            static const int corners[36] = {
+                0, 1, 3, 0, 3, 2,   4, 6, 7, 4, 7, 5,   0, 4, 5, 0, 5, 1,
+                2, 3, 7, 2, 7, 6,   0, 2, 6, 0, 6, 4,   1, 5, 7, 1, 7, 3
+            };
+            for (int i = 0; i < 36; i++) {
+                cube[i * 3 + 0] = (float)((corners[i] >> 2) & 1);
+                cube[i * 3 + 1] = (float)((corners[i] >> 1) & 1);
+                cube[i * 3 + 2] = (float)(corners[i] & 1);
+            }
+            glGenVertexArrays(1, &boxVAO);
+            glGenBuffers(1, &boxVBO);
+            glBindVertexArray(boxVAO);
+            glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+        }
+    }
+
+    /// Dados escalares guardados na secção META da cache.
+    struct CacheMeta {
+        glm::vec3 minBounds;
+        glm::vec3 maxBounds;
+        float modelSize;
+        float groundPlaneY;
+    };
+
+    /**
+     * @brief Verifica se uma BVH lida da cache é consistente com o número de triângulos.
+     *
+     * Como build() cria os filhos depois do pai, os de um nó interno têm de vir depois dele
+     * (o que exclui ciclos), e nenhum nó pode passar de BVH::MAX_DEPTH, que dimensiona a pilha
+     * de BVH::query().
+     */
+    bool validBVH(const BVH& bvh, size_t triangleCount) const {
+        if (bvh.nodes.empty()) return triangleCount == 0;
+        std::vector<uint32_t> level(bvh.nodes.size(), 0);
+        for (size_t i = 0; i < bvh.nodes.size(); i++) {
+            const BVH::Node& node = bvh.nodes[i];
+            if (node.count > 0) {
+                if ((size_t)node.leftFirst + node.count > triangleCount) return false;
+                continue;
+            }
+            if (node.leftFirst <= i || (size_t)node.leftFirst + 1 >= bvh.nodes.size() || level[i] >= BVH::MAX_DEPTH) return false;
+            level[node.leftFirst] = std::max(level[node.leftFirst], level[i] + 1);
+            level[node.leftFirst + 1] = std::max(level[node.leftFirst + 1], level[i] + 1);
+        }
+        return true;
+    }
+
+    /// Verifica se os índices e os intervalos dos chunks (todos os níveis) lidos da cache cabem nos vetores.
+    bool validGeometry() const {
+        if (vertices.size() % VERTEX_FLOATS != 0 || indices.size() % 3 != 0) return false;
+        size_t vertexCount = vertices.size() / VERTEX_FLOATS;
+        for (unsigned int index : indices) {
+            if (index >= vertexCount) return false;
+        }
+        for (const Chunk& chunk : chunks) {
+            for (int level = 0; level < LOD_LEVELS; level++) {
+                if (chunk.indexCount[level] % 3 != 0 ||
+                    (size_t)chunk.indexOffset[level] + chunk.indexCount[level] > indices.size()) return false;
+            }
+        }
+        return true;
     }
 };
 
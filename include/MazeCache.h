@@ -0,0 +1,294 @@
+#ifndef MAZE_CACHE_H
+#define MAZE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class MazeCache
+ * @brief Formato binário "baked" do labirinto (cache de arranque).
+ *
+ * O ficheiro é composto por um cabeçalho, uma tabela de secções e os dados de cada secção
+ * (alinhados a 16 bytes). O cabeçalho guarda o tamanho, mtime e hash FNV-1a do ficheiro OBJ
+ * de origem, para que a cache seja invalidada automaticamente quando o modelo muda.
+ * A leitura é feita por mmap: cada secção é apenas um ponteiro para a zona mapeada.
+ */
+class MazeCache {
+public:
+    static const uint32_t MAGIC = 0x4B425A4D;   ///< "MZBK" em little-endian
+    static const uint32_t VERSION = 7;          ///< Incrementar sempre que o conteúdo das secções muda
+
+    /// Identificadores (FourCC) das secções
+    enum Tag : uint32_t {
+        TAG_META     = 0x4154454D, ///< "META" - limites e tamanho do modelo
+        TAG_VERTICES = 0x58545256, ///< "VRTX" - vértices únicos intercalados
+        TAG_INDICES  = 0x58444E49, ///< "INDX" - index buffer (uint32), ordenado por chunk
+        TAG_CHUNKS   = 0x4B4E4843, ///< "CHNK" - chunks (caixa + intervalo do index buffer)
+        TAG_FLOOR    = 0x524C4C46, ///< "FLLR" - triângulos de chão (ordem das folhas da BVH)
+        TAG_WALLS    = 0x4C4C4157, ///< "WALL" - triângulos de parede (ordem das folhas da BVH)
+        TAG_WALL_BVH  = 0x48565657, ///< "WWVH" - nós da BVH de paredes
+        TAG_FLOOR_BVH = 0x48564646, ///< "FFVH" - nós da BVH de chão
+        TAG_MATERIALS = 0x4C52544D, ///< "MTRL" - texturas dos materiais do MTL (caminhos separados por '\n')
+        TAG_PAGES     = 0x45474150  ///< "PAGE" - índice de páginas do MazePager (caixa e tamanho de cada página)
+    };
+
+    /**
+     * @struct SourceStamp
+     * @brief Identificação do ficheiro de origem usada para validar a cache.
+     */
+    struct SourceStamp {
+        uint64_t size = 0;      ///< Tamanho do ficheiro em bytes
+        int64_t mtime = 0;      ///< Data de modificação (segundos desde epoch)
+        uint64_t hash = 0;      ///< Hash FNV-1a do conteúdo (0 se ainda não calculado)
+    };
+
+    MazeCache() {}
+    MazeCache(const MazeCache&) = delete;
+    MazeCache& operator=(const MazeCache&) = delete;
+    ~MazeCache() { close(); }
+
+    /**
+     * @brief Obtém tamanho e mtime de um ficheiro (sem ler o conteúdo).
+     * @return false se o ficheiro não existir.
+     */
+    static bool statSource(const std::string& path, SourceStamp& stamp) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return false;
+        stamp.size = (uint64_t)st.st_size;
+        stamp.mtime = (int64_t)st.st_mtime;
+        stamp.hash = 0;
+        return true;
+    }
+
+    /// Hash FNV-1a 64 bits do conteúdo de um ficheiro.
+    static uint64_t hashFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        uint64_t h = 1469598103934665603ull;
+        char buffer[1 << 16];
+        while (file) {
+            file.read(buffer, sizeof(buffer));
+            std::streamsize n = file.gcount();
+            for (std::streamsize i = 0; i < n; i++) {
+                h ^= (unsigned char)buffer[i];
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    }
+
+    /**
+     * @brief Mapeia o ficheiro de cache e valida-o contra o ficheiro de origem.
+     *
+     * Se o tamanho coincidir mas o mtime não (ex.: checkout do git), compara o hash do conteúdo
+     * antes de rejeitar a cache.
+     *
+     * @param cachePath Caminho do ficheiro baked.
+     * @param sourcePath Caminho do OBJ de origem.
+     * @return true se a cache existe, é desta versão e corresponde ao OBJ atual.
+     */
+    bool open(const std::string& cachePath, const std::string& sourcePath) {
+        close();
+
+        SourceStamp source;
+        if (!statSource(sourcePath, source)) return false;
+        if (!map(cachePath)) return false;
+
+        if (mappedSize < sizeof(Header)) { close(); return false; }
+        const Header* header = (const Header*)mapped;
+        if (header->magic != MAGIC || header->version != VERSION) { close(); return false; }
+        if (header->source.size != source.size) { close(); return false; }
+        if (header->source.mtime != source.mtime && header->source.hash != hashFile(sourcePath)) {
+            close();
+            return false;
+        }
+
+        // Comparações feitas por subtração, para que valores corrompidos não deem a volta
+        if (header->sectionCount > (mappedSize - sizeof(Header)) / sizeof(SectionEntry)) { close(); return false; }
+        const SectionEntry* table = (const SectionEntry*)(mapped + sizeof(Header));
+        for (uint32_t i = 0; i < header->sectionCount; i++) {
+            if (table[i].offset > mappedSize || table[i].size > mappedSize - table[i].offset) { close(); return false; }
+        }
+        return true;
+    }
+
+    /// Liberta o mapeamento (os ponteiros devolvidos por section() deixam de ser válidos).
+    void close() {
+#ifndef _WIN32
+        if (mapped) munmap((void*)mapped, mappedSize);
+#else
+        delete[] mapped;
+#endif
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+
+    /**
+     * @brief Procura uma secção na cache aberta.
+     * @param tag Identificador da secção.
+     * @param data Ponteiro para os dados (dentro da zona mapeada).
+     * @param size Tamanho em bytes.
+     */
+    bool section(uint32_t tag, const void*& data, size_t& size) const {
+        if (!mapped) return false;
+        const Header* header = (const Header*)mapped;
+        const SectionEntry* table = (const SectionEntry*)(mapped + sizeof(Header));
+        for (uint32_t i = 0; i < header->sectionCount; i++) {
+            if (table[i].tag == tag) {
+                data = mapped + table[i].offset;
+                size = (size_t)table[i].size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Copia uma secção para um vetor de elementos trivialmente copiáveis.
+    template <typename T>
+    bool read(uint32_t tag, std::vector<T>& out) const {
+        const void* data;
+        size_t size;
+        if (!section(tag, data, size) || size % sizeof(T) != 0) return false;
+        out.resize(size / sizeof(T));
+        if (size) std::memcpy(out.data(), data, size);
+        return true;
+    }
+
+    /// Copia uma secção de tamanho fixo (uma única struct).
+    template <typename T>
+    bool readValue(uint32_t tag, T& out) const {
+        const void* data;
+        size_t size;
+        if (!section(tag, data, size) || size != sizeof(T)) return false;
+        std::memcpy(&out, data, sizeof(T));
+        return true;
+    }
+
+    /**
+     * @class Writer
+     * @brief Acumula secções em memória e escreve o ficheiro de cache de uma só vez.
+     */
+    class Writer {
+    public:
+        void add(uint32_t tag, const void* data, size_t size) {
+            sections.push_back({tag, std::vector<char>((const char*)data, (const char*)data + size)});
+        }
+
+        template <typename T>
+        void add(uint32_t tag, const std::vector<T>& values) {
+            add(tag, values.data(), values.size() * sizeof(T));
+        }
+
+        template <typename T>
+        void addValue(uint32_t tag, const T& value) {
+            add(tag, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Escreve a cache para um ficheiro temporário e renomeia-o (escrita atómica).
+         * @param cachePath Caminho do ficheiro baked.
+         * @param sourcePath OBJ de origem (para o carimbo de validação).
+         */
+        bool write(const std::string& cachePath, const std::string& sourcePath) const {
+            Header header;
+            if (!statSource(sourcePath, header.source)) return false;
+            header.source.hash = hashFile(sourcePath);
+            header.magic = MAGIC;
+            header.version = VERSION;
+            header.sectionCount = (uint32_t)sections.size();
+
+            std::vector<SectionEntry> table(sections.size());
+            uint64_t offset = align(sizeof(Header) + table.size() * sizeof(SectionEntry));
+            for (size_t i = 0; i < sections.size(); i++) {
+                table[i].tag = sections[i].tag;
+                table[i].offset = offset;
+                table[i].size = sections[i].bytes.size();
+                offset = align(offset + table[i].size);
+            }
+
+            std::string tmpPath = cachePath + ".tmp";
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)table.data(), table.size() * sizeof(SectionEntry));
+            uint64_t written = sizeof(Header) + table.size() * sizeof(SectionEntry);
+            static const char padding[16] = {};
+            for (size_t i = 0; i < sections.size(); i++) {
+                out.write(padding, table[i].offset - written);
+                out.write(sections[i].bytes.data(), sections[i].bytes.size());
+                written = table[i].offset + table[i].size;
+            }
+            out.close();
+            if (!out) {
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+            return std::rename(tmpPath.c_str(), cachePath.c_str()) == 0;
+        }
+
+    private:
+        struct PendingSection {
+            uint32_t tag;
+            std::vector<char> bytes;
+        };
+        std::vector<PendingSection> sections;
+
+        static uint64_t align(uint64_t v) { return (v + 15) & ~uint64_t(15); }
+    };
+
+private:
+    struct Header {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        SourceStamp source;
+        uint32_t sectionCount = 0;
+        uint32_t reserved = 0;
+    };
+
+    struct SectionEntry {
+        uint32_t tag = 0;
+        uint32_t reserved = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+
+    bool map(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) return false;
+        mapped = (const char*)ptr;
+        mappedSize = (size_t)st.st_size;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        size_t size = (size_t)file.tellg();
+        char* buffer = new char[size];
+        file.seekg(0);
+        file.read(buffer, size);
+        mapped = buffer;
+        mappedSize = size;
+        return (bool)file;
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef MAZE_GENERATOR_H
+#define MAZE_GENERATOR_H
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+/**
+ * @class MazeGenerator
+ * @brief Gerador de labirintos em grelha (recursive backtracker) com geometria já simplificada.
+ *
+ * Cada célula da grelha width x height liga-se às vizinhas por passagens escolhidas por uma
+ * procura em profundidade aleatória (std::mt19937 com a semente dada), o que dá um labirinto
+ * perfeito: existe exatamente um caminho entre quaisquer duas células.
+ *
+ * As paredes são quads sem espessura (o labirinto é desenhado sem culling e as colisões são
+ * de dupla face). Arestas de parede consecutivas na mesma linha da grelha são fundidas num só
+ * quad, pelo que uma parede reta tem 2 triângulos qualquer que seja o seu comprimento. O chão,
+ * todo coplanar, é um retângulo dividido apenas em floorTiles x floorTiles quads, para que
+ * continue a ser descartado por chunks.
+ */
+class MazeGenerator {
+public:
+    /**
+     * @struct Params
+     * @brief Parâmetros de um labirinto gerado.
+     */
+    struct Params {
+        uint32_t seed = 1;              ///< Semente (o mesmo conjunto de parâmetros gera sempre o mesmo labirinto)
+        int width = 16;                 ///< Células em X
+        int height = 16;                ///< Células em Z
+        float cellSize = 150.0f;        ///< Lado de cada célula
+        float wallHeight = 150.0f;      ///< Altura das paredes
+    };
+
+    /// Bits de passagem de cada célula.
+    enum Passage : uint8_t {
+        PASSAGE_NORTH = 1,  ///< Para -Z
+        PASSAGE_SOUTH = 2,  ///< Para +Z
+        PASSAGE_WEST = 4,   ///< Para -X
+        PASSAGE_EAST = 8    ///< Para +X
+    };
+
+    /**
+     * @struct Quad
+     * @brief Retângulo de geometria; os cantos seguem o sentido anti-horário visto da face da frente.
+     */
+    struct Quad {
+        glm::vec3 corners[4];
+        bool floor;             ///< Chão (caso contrário, parede)
+    };
+
+    /**
+     * @struct Layout
+     * @brief Resultado da geração: a grelha, a geometria e os pontos de início e saída.
+     */
+    struct Layout {
+        int width = 0, height = 0;
+        float cellSize = 0.0f;
+        std::vector<uint8_t> passages;  ///< Bits Passage de cada célula (x + z * width)
+        std::vector<Quad> quads;        ///< Chão e paredes fundidos
+        glm::vec3 start;                ///< Centro da célula (0, 0), ao nível do chão
+        glm::vec3 exit;                 ///< Centro da célula mais distante do início (pelo caminho), ao nível do chão
+
+        /// Centro de uma célula, ao nível do chão.
+        glm::vec3 cellCenter(int x, int z) const { return glm::vec3((x + 0.5f) * cellSize, 0.0f, (z + 0.5f) * cellSize); }
+    };
+
+    /**
+     * @param params Parâmetros do labirinto.
+     * @param floorTiles Divisões por eixo do retângulo do chão.
+     */
+    static Layout generate(const Params& params, int floorTiles = 16) {
+        Layout layout;
+        int w = layout.width = std::max(1, params.width);
+        int h = layout.height = std::max(1, params.height);
+        float s = layout.cellSize = params.cellSize;
+        layout.passages.assign((size_t)w * h, 0);
+        carve(layout, params.seed);
+
+        // Chão
+        float sizeX = w * s, sizeZ = h * s;
+        int tilesX = std::max(1, std::min(floorTiles, w)), tilesZ = std::max(1, std::min(floorTiles, h));
+        for (int i = 0; i < tilesX; i++) {
+            for (int j = 0; j < tilesZ; j++) {
+                float x0 = sizeX * i / tilesX, x1 = sizeX * (i + 1) / tilesX;
+                float z0 = sizeZ * j / tilesZ, z1 = sizeZ * (j + 1) / tilesZ;
+                layout.quads.push_back({ { glm::vec3(x0, 0.0f, z1), glm::vec3(x1, 0.0f, z1),
+                                           glm::vec3(x1, 0.0f, z0), glm::vec3(x0, 0.0f, z0) }, true });
+            }
+        }
+
+        // Paredes ao longo de X (linhas z = j * s) e de Z (linhas x = i * s), fundidas por linha
+        auto wallAlongX = [&](int j, int i) {
+            return j == 0 || j == h || !(layout.passages[i + (j - 1) * w] & PASSAGE_SOUTH);
+        };
+        auto wallAlongZ = [&](int i, int j) {
+            return i == 0 || i == w || !(layout.passages[(i - 1) + j * w] & PASSAGE_EAST);
+        };
+        float top = params.wallHeight;
+        for (int j = 0; j <= h; j++) {
+            for (int i = 0; i < w;) {
+                if (!wallAlongX(j, i)) { i++; continue; }
+                int first = i;
+                while (i < w && wallAlongX(j, i)) i++;
+                float z = j * s;
+                layout.quads.push_back({ { glm::vec3(first * s, 0.0f, z), glm::vec3(i * s, 0.0f, z),
+                                           glm::vec3(i * s, top, z), glm::vec3(first * s, top, z) }, false });
+            }
+        }
+        for (int i = 0; i <= w; i++) {
+            for (int j = 0; j < h;) {
+                if (!wallAlongZ(i, j)) { j++; continue; }
+                int first = j;
+                while (j < h && wallAlongZ(i, j)) j++;
+                float x = i * s;
+                layout.quads.push_back({ { glm::vec3(x, 0.0f, j * s), glm::vec3(x, 0.0f, first * s),
+                                           glm::vec3(x, top, first * s), glm::vec3(x, top, j * s) }, false });
+            }
+        }
+
+        layout.start = layout.cellCenter(0, 0);
+        int farthest = farthestCell(layout, 0);
+        layout.exit = layout.cellCenter(farthest % w, farthest / w);
+        return layout;
+    }
+
+private:
+    /// Procura em profundidade aleatória (iterativa) a partir da célula (0, 0).
+    static void carve(Layout& layout, uint32_t seed) {
+        int w = layout.width, h = layout.height;
+        std::mt19937 rng(seed);
+        std::vector<bool> visited((size_t)w * h, false);
+        std::vector<int> stack;
+        stack.push_back(0);
+        visited[0] = true;
+        while (!stack.empty()) {
+            int cell = stack.back();
+            int x = cell % w, z = cell / w;
+            int options[4], count = 0;
+            if (z > 0 && !visited[cell - w]) options[count++] = 0;
+            if (z + 1 < h && !visited[cell + w]) options[count++] = 1;
+            if (x > 0 && !visited[cell - 1]) options[count++] = 2;
+            if (x + 1 < w && !visited[cell + 1]) options[count++] = 3;
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            static const int dx[4] = { 0, 0, -1, 1 }, dz[4] = { -1, 1, 0, 0 };
+            static const uint8_t bits[4] = { PASSAGE_NORTH, PASSAGE_SOUTH, PASSAGE_WEST, PASSAGE_EAST };
+            static const uint8_t opposite[4] = { PASSAGE_SOUTH, PASSAGE_NORTH, PASSAGE_EAST, PASSAGE_WEST };
+            int d = options[rng() % count];
+            int next = (x + dx[d]) + (z + dz[d]) * w;
+            layout.passages[cell] |= bits[d];
+            layout.passages[next] |= opposite[d];
+            visited[next] = true;
+            stack.push_back(next);
+        }
+    }
+
+    /// Célula com o caminho mais longo a partir de from (procura em largura sobre as passagens).
+    static int farthestCell(const Layout& layout, int from) {
+        int w = layout.width;
+        std::vector<int> distance(layout.passages.size(), -1), queue;
+        queue.reserve(layout.passages.size());
+        queue.push_back(from);
+        distance[from] = 0;
+        int farthest = from;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int cell = queue[head];
+            if (distance[cell] > distance[farthest]) farthest = cell;
+            uint8_t open = layout.passages[cell];
+            int neighbours[4] = { cell - w, cell + w, cell - 1, cell + 1 };
+            static const uint8_t bits[4] = { PASSAGE_NORTH, PASSAGE_SOUTH, PASSAGE_WEST, PASSAGE_EAST };
+            for (int d = 0; d < 4; d++) {
+                if (!(open & bits[d]) || distance[neighbours[d]] >= 0) continue;
+                distance[neighbours[d]] = distance[cell] + 1;
+                queue.push_back(neighbours[d]);
+            }
+        }
+        return farthest;
+    }
+};
+
+#endif
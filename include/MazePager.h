@@ -0,0 +1,482 @@
+#ifndef MAZE_PAGER_H
+#define MAZE_PAGER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <shader_m.h>
+#include <Frustum.h>
+#include <Maze.h>
+#include <MazeCache.h>
+#include <ThreadPool.h>
+
+/**
+ * @class MazePager
+ * @brief Carregamento por páginas de labirintos que não cabem (ou não convém ter) todos em memória.
+ *
+ * bake() divide um labirinto já processado em pagesPerAxis x pagesPerAxis páginas XZ. Cada
+ * página é um ficheiro no formato baked normal (MazeCache, lido com Maze::loadCache), com os
+ * seus chunks e níveis de detalhe, os triângulos de colisão cujo centroide cai na página e as
+ * respetivas BVHs; um ficheiro de índice guarda a caixa e o tamanho de cada página.
+ *
+ * Em update() (thread do contexto OpenGL), as páginas a menos de loadDistance da câmara são
+ * pedidas por ordem de distância e lidas num ThreadPool; as que já chegaram ganham o seu VBO/EBO
+ * e entram no conjunto residente. Enquanto houver espaço no orçamento de memória as páginas
+ * distantes ficam carregadas; quando uma página nova não cabe, saem primeiro as mais afastadas.
+ * Sem uploadToGPU (benchmarks, servidores) as páginas ficam só com os dados de CPU e update()
+ * pode ser chamado sem contexto OpenGL.
+ *
+ * O orçamento conta a memória de CPU de cada página instalada (Maze::memoryBytes(): geometria,
+ * triângulos, BVHs e dados SoA); antes de uma página ser lida pela primeira vez, o tamanho do
+ * seu ficheiro serve de estimativa.
+ *
+ * As consultas de colisão (getFloorHeight(), moveAndSlide()) podem correr noutra thread: usam
+ * uma cópia atómica do conjunto residente, pelo que uma página despejada só é libertada quando
+ * a última consulta que a usa termina.
+ */
+class MazePager {
+public:
+    static const int DEFAULT_PAGES_PER_AXIS = 4;                ///< Páginas por eixo em bake()
+    static const size_t DEFAULT_MEMORY_BUDGET = 256u << 20;     ///< Orçamento por omissão (bytes de páginas residentes)
+
+    /**
+     * @struct PageEntry
+     * @brief Entrada do índice: caixa de uma página e o tamanho do seu ficheiro.
+     */
+    struct PageEntry {
+        glm::vec3 minBounds;    ///< Caixa da geometria e das colisões da página
+        glm::vec3 maxBounds;
+        uint32_t id;            ///< Número do ficheiro da página (pagePath)
+        uint32_t reserved;
+        uint64_t bytes;         ///< Tamanho do ficheiro (estimativa do custo até a página ser lida)
+    };
+
+    std::vector<std::string> materialTextures;  ///< Como Maze::materialTextures (iguais em todas as páginas)
+    glm::vec3 startPosition = glm::vec3(0.0f);  ///< Posição inicial do labirinto completo
+    glm::vec3 exitPosition = glm::vec3(0.0f);   ///< Posição do portão de saída
+    glm::vec3 minBounds = glm::vec3(0.0f);      ///< Caixa do labirinto completo
+    glm::vec3 maxBounds = glm::vec3(0.0f);
+    float modelSize = 0.0f;                     ///< Diagonal da caixa do labirinto completo
+    unsigned int visibleChunks = 0;             ///< Chunks desenhados no último draw(), somando as páginas
+
+    /**
+     * @param sourcePath Ficheiro de origem do labirinto (o mesmo dado a bake()).
+     * @param packed Formato PackedVertex nos VBOs das páginas.
+     * @param memoryBudget Bytes de páginas residentes a partir dos quais as distantes são despejadas.
+     * @param threadCount Threads de leitura.
+     * @param uploadToGPU Se false, as páginas não criam VBO/EBO (só colisões; dispensa o contexto OpenGL).
+     */
+    explicit MazePager(const std::string& sourcePath, bool packed = false, size_t memoryBudget = DEFAULT_MEMORY_BUDGET,
+                       unsigned threadCount = 1, bool uploadToGPU = true)
+        : sourcePath(sourcePath), packedVertices(packed), uploadToGPU(uploadToGPU), memoryBudget(memoryBudget),
+          resident(std::make_shared<PageSet>()), pool(new ThreadPool(threadCount)) {}
+
+    MazePager(const MazePager&) = delete;
+    MazePager& operator=(const MazePager&) = delete;
+
+    /// Espera pelas leituras em curso e apaga os buffers das páginas residentes (requer o contexto com uploadToGPU).
+    ~MazePager() {
+        pool.reset();
+        if (!uploadToGPU) return;
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) page->maze->releaseGPU();
+    }
+
+    static std::string indexPath(const std::string& sourcePath) { return sourcePath + ".pages.bake"; }
+    static std::string pagePath(const std::string& sourcePath, uint32_t id) {
+        return sourcePath + ".page" + std::to_string(id) + ".bake";
+    }
+
+    /**
+     * @brief Escreve as páginas e o índice de um labirinto já processado.
+     *
+     * Cada chunk vai inteiro para a página do centroide do seu primeiro triângulo, e cada
+     * triângulo de colisão para a do seu centroide. Páginas vazias não são escritas.
+     *
+     * @param maze Labirinto completo (com chunks e BVHs).
+     * @param sourcePath Ficheiro de origem (carimbo de validação das páginas).
+     * @param pagesPerAxis Páginas por eixo XZ.
+     * @return false se algum ficheiro não pôde ser escrito.
+     */
+    static bool bake(const Maze& maze, const std::string& sourcePath, int pagesPerAxis = DEFAULT_PAGES_PER_AXIS) {
+        pagesPerAxis = std::max(1, pagesPerAxis);
+        int pageCount = pagesPerAxis * pagesPerAxis;
+        glm::vec2 pageSize(std::max(maze.maxBounds.x - maze.minBounds.x, 0.1f) / pagesPerAxis,
+                           std::max(maze.maxBounds.z - maze.minBounds.z, 0.1f) / pagesPerAxis);
+        auto pageOf = [&](const glm::vec3& p) {
+            int px = std::max(0, std::min(pagesPerAxis - 1, (int)((p.x - maze.minBounds.x) / pageSize.x)));
+            int pz = std::max(0, std::min(pagesPerAxis - 1, (int)((p.z - maze.minBounds.z) / pageSize.y)));
+            return px * pagesPerAxis + pz;
+        };
+
+        std::vector<std::vector<size_t>> pageChunks(pageCount);
+        for (size_t c = 0; c < maze.chunks.size(); c++) {
+            const unsigned int* tri = &maze.indices[maze.chunks[c].indexOffset[0]];
+            glm::vec3 centroid = (maze.vertexPosition(tri[0]) + maze.vertexPosition(tri[1]) + maze.vertexPosition(tri[2])) / 3.0f;
+            pageChunks[pageOf(centroid)].push_back(c);
+        }
+        std::vector<std::vector<const Maze::Triangle*>> pageFloors(pageCount), pageWalls(pageCount);
+        for (const Maze::Triangle& tri : maze.floorTriangles) pageFloors[pageOf(tri.centroid)].push_back(&tri);
+        for (const Maze::Triangle& tri : maze.wallTriangles) pageWalls[pageOf(tri.centroid)].push_back(&tri);
+
+        std::vector<PageEntry> entries;
+        std::vector<unsigned int> local(maze.vertices.size() / Maze::VERTEX_FLOATS, ~0u);
+        for (int p = 0; p < pageCount; p++) {
+            if (pageChunks[p].empty() && pageFloors[p].empty() && pageWalls[p].empty()) continue;
+
+            Maze page;
+            page.materialTextures = maze.materialTextures;
+            page.modelSize = maze.modelSize;
+            page.groundPlaneY = maze.groundPlaneY;
+            glm::vec3 lo(std::numeric_limits<float>::max()), hi(std::numeric_limits<float>::lowest());
+
+            // Índices com vértices renumerados; o nível 0 de todos os chunks primeiro, como no Maze
+            std::vector<unsigned int> used;
+            page.chunks.resize(pageChunks[p].size());
+            for (int level = 0; level < Maze::LOD_LEVELS; level++) {
+                for (size_t k = 0; k < pageChunks[p].size(); k++) {
+                    const Maze::Chunk& source = maze.chunks[pageChunks[p][k]];
+                    Maze::Chunk& chunk = page.chunks[k];
+                    chunk.minBounds = source.minBounds;
+                    chunk.maxBounds = source.maxBounds;
+                    chunk.indexOffset[level] = (unsigned int)page.indices.size();
+                    chunk.indexCount[level] = source.indexCount[level];
+                    for (unsigned int i = 0; i < source.indexCount[level]; i++) {
+                        unsigned int v = maze.indices[source.indexOffset[level] + i];
+                        if (local[v] == ~0u) {
+                            local[v] = (unsigned int)used.size();
+                            used.push_back(v);
+                        }
+                        page.indices.push_back(local[v]);
+                    }
+                    lo = glm::min(lo, source.minBounds);
+                    hi = glm::max(hi, source.maxBounds);
+                }
+            }
+            page.vertices.reserve(used.size() * Maze::VERTEX_FLOATS);
+            for (unsigned int v : used) {
+                const float* data = &maze.vertices[(size_t)v * Maze::VERTEX_FLOATS];
+                page.vertices.insert(page.vertices.end(), data, data + Maze::VERTEX_FLOATS);
+                local[v] = ~0u;
+            }
+
+            for (const Maze::Triangle* tri : pageFloors[p]) page.floorTriangles.push_back(*tri);
+            for (const Maze::Triangle* tri : pageWalls[p]) page.wallTriangles.push_back(*tri);
+            for (const std::vector<Maze::Triangle>* list : { &page.floorTriangles, &page.wallTriangles }) {
+                for (const Maze::Triangle& tri : *list) {
+                    lo = glm::min(lo, glm::min(glm::min(tri.v0, tri.v1), tri.v2));
+                    hi = glm::max(hi, glm::max(glm::max(tri.v0, tri.v1), tri.v2));
+                }
+            }
+            page.minBounds = lo;
+            page.maxBounds = hi;
+            page.buildCollisionBVH();
+
+            PageEntry entry;
+            entry.minBounds = lo;
+            entry.maxBounds = hi;
+            entry.id = (uint32_t)p;
+            entry.reserved = 0;
+            MazeCache::SourceStamp stamp;
+            if (!page.saveCache(pagePath(sourcePath, entry.id), sourcePath) ||
+                !MazeCache::statSource(pagePath(sourcePath, entry.id), stamp)) return false;
+            entry.bytes = stamp.size;
+            entries.push_back(entry);
+        }
+
+        IndexMeta meta;
+        meta.minBounds = maze.minBounds;
+        meta.maxBounds = maze.maxBounds;
+        meta.startPosition = maze.startPosition;
+        meta.exitPosition = maze.exitPosition;
+        meta.modelSize = maze.modelSize;
+        meta.pagesPerAxis = pagesPerAxis;
+
+        std::vector<char> materialNames;
+        for (const std::string& name : maze.materialTextures) {
+            materialNames.insert(materialNames.end(), name.begin(), name.end());
+            materialNames.push_back('\n');
+        }
+
+        MazeCache::Writer writer;
+        writer.addValue(MazeCache::TAG_META, meta);
+        writer.add(MazeCache::TAG_PAGES, entries);
+        writer.add(MazeCache::TAG_MATERIALS, materialNames);
+        if (!writer.write(indexPath(sourcePath), sourcePath)) {
+            std::cout << "Aviso: nao foi possivel escrever o indice de paginas " << indexPath(sourcePath) << std::endl;
+            return false;
+        }
+
+        uint64_t total = 0;
+        for (const PageEntry& entry : entries) total += entry.bytes;
+        std::cout << "Paginas: " << entries.size() << " (" << (total >> 10) << " KiB)" << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief Lê o índice de páginas.
+     * @return false se o índice não existir, for de outra versão ou não corresponder à origem.
+     */
+    bool open() {
+        MazeCache cache;
+        IndexMeta meta;
+        std::vector<char> materialNames;
+        if (!cache.open(indexPath(sourcePath), sourcePath) ||
+            !cache.readValue(MazeCache::TAG_META, meta) ||
+            !cache.read(MazeCache::TAG_PAGES, entries) ||
+            !cache.read(MazeCache::TAG_MATERIALS, materialNames)) {
+            entries.clear();
+            return false;
+        }
+
+        materialTextures.clear();
+        std::string name;
+        for (char c : materialNames) {
+            if (c != '\n') { name += c; continue; }
+            materialTextures.push_back(name);
+            name.clear();
+        }
+        minBounds = meta.minBounds;
+        maxBounds = meta.maxBounds;
+        startPosition = meta.startPosition;
+        exitPosition = meta.exitPosition;
+        modelSize = meta.modelSize;
+        states.assign(entries.size(), NOT_LOADED);
+        footprint.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) footprint[i] = entries[i].bytes;
+        return true;
+    }
+
+    /**
+     * @brief Pede as páginas próximas, instala as que chegaram e despeja as distantes se preciso.
+     *
+     * Chamar uma vez por frame na thread do contexto OpenGL (em qualquer thread sem uploadToGPU).
+     *
+     * @param viewPos Posição da câmara.
+     * @param loadDistance Distância (XZ, à caixa da página) até à qual as páginas são pedidas.
+     * @param maxUploadBytes Bytes de páginas instalados neste frame (pelo menos uma é sempre instalada).
+     */
+    void update(const glm::vec3& viewPos, float loadDistance, size_t maxUploadBytes = 16u << 20) {
+        // Páginas desejadas, da mais próxima para a mais distante, até esgotar o orçamento
+        distances.resize(entries.size());
+        order.clear();
+        for (size_t i = 0; i < entries.size(); i++) {
+            distances[i] = distanceXZ(viewPos, entries[i]);
+            if (distances[i] <= loadDistance && states[i] != FAILED) order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return distances[a] < distances[b]; });
+        wanted.assign(entries.size(), false);
+        uint64_t planned = 0;
+        skipped = 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            size_t i = order[k];
+            if (planned + footprint[i] > memoryBudget && planned > 0) {
+                skipped = (unsigned int)(order.size() - k);
+                break;
+            }
+            planned += footprint[i];
+            wanted[i] = true;
+            if (states[i] == NOT_LOADED) requestLoad(i);
+        }
+
+        // Instalar as páginas lidas
+        size_t installed = 0;
+        bool changed = false;
+        std::vector<std::shared_ptr<Page>> pages = *std::atomic_load(&resident);
+        while (installed < maxUploadBytes) {
+            std::shared_ptr<Page> page;
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                if (ready.empty()) break;
+                page = ready.front();
+                ready.pop_front();
+            }
+            loading--;
+            size_t index = page->entry;
+            if (!page->maze) {
+                states[index] = FAILED;
+                continue;
+            }
+            if (!wanted[index]) {
+                states[index] = NOT_LOADED;     // A câmara afastou-se entretanto
+                continue;
+            }
+            footprint[index] = page->bytes;
+            while (residentBytes + page->bytes > memoryBudget && evictFarthest(pages)) {}
+            if (uploadToGPU) page->maze->setupMesh();
+            pages.push_back(page);
+            residentBytes += page->bytes;
+            states[index] = RESIDENT;
+            installed += page->bytes;
+            changed = true;
+        }
+        if (changed) std::atomic_store(&resident, std::make_shared<const PageSet>(std::move(pages)));
+    }
+
+    /// Seleciona o nível de detalhe dos chunks de todas as páginas residentes (ver Maze::selectLod).
+    void selectLod(const glm::vec3& viewPos, bool enabled = true) {
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) page->maze->selectLod(viewPos, enabled);
+    }
+
+    /// Desenha os chunks visíveis das páginas residentes que intersetam o frustum.
+    void draw(Shader& shader, const Frustum& frustum) {
+        visibleChunks = 0;
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) {
+            Maze& maze = *page->maze;
+            if (!frustum.intersectsAABB(maze.minBounds, maze.maxBounds)) continue;
+            maze.draw(shader, frustum);
+            visibleChunks += maze.visibleChunks;
+        }
+    }
+
+    /// Como draw(), com o occlusion culling de cada página (Maze::drawOcclusionCulled).
+    void drawOcclusionCulled(Shader& shader, const Frustum& frustum, const glm::vec3& viewPos) {
+        visibleChunks = 0;
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) {
+            Maze& maze = *page->maze;
+            if (!frustum.intersectsAABB(maze.minBounds, maze.maxBounds)) continue;
+            maze.drawOcclusionCulled(shader, frustum, viewPos);
+            visibleChunks += maze.visibleChunks;
+        }
+    }
+
+    /// Maior altura de chão sob pos nas páginas residentes (-99999 se não houver), como Maze::getFloorHeight.
+    float getFloorHeight(const glm::vec3& pos, bool checkSlope = true) const {
+        float best = -99999.0f;
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) {
+            Maze& maze = *page->maze;
+            if (pos.x < maze.minBounds.x || pos.x > maze.maxBounds.x || pos.z < maze.minBounds.z || pos.z > maze.maxBounds.z) continue;
+            best = std::max(best, maze.getFloorHeight(pos, checkSlope));
+        }
+        return best;
+    }
+
+    /// Primeiro contacto com as paredes das páginas residentes, como Maze::sweepSphere.
+    bool sweepSphere(const glm::vec3& start, const glm::vec3& delta, float radius, Maze::SweepHit& hit) const {
+        glm::vec3 queryMin = glm::min(start, start + delta) - glm::vec3(radius);
+        glm::vec3 queryMax = glm::max(start, start + delta) + glm::vec3(radius);
+        bool found = false;
+        hit.t = 1.0f;
+        for (const std::shared_ptr<Page>& page : *std::atomic_load(&resident)) {
+            Maze& maze = *page->maze;
+            if (maze.maxBounds.x < queryMin.x || maze.maxBounds.y < queryMin.y || maze.maxBounds.z < queryMin.z ||
+                maze.minBounds.x > queryMax.x || maze.minBounds.y > queryMax.y || maze.minBounds.z > queryMax.z) continue;
+            Maze::SweepHit pageHit;
+            if (maze.sweepSphere(start, delta, radius, pageHit) && (!found || pageHit.t < hit.t)) {
+                hit = pageHit;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    /// Maze::moveAndSlide sobre as páginas residentes.
+    glm::vec3 moveAndSlide(glm::vec3 position, glm::vec3 delta, float radius, int maxIterations = 3) const {
+        return Maze::slide(position, delta, radius, maxIterations,
+                           [this](const glm::vec3& start, const glm::vec3& d, float r, Maze::SweepHit& hit) { return sweepSphere(start, d, r, hit); });
+    }
+
+    size_t pageCount() const { return entries.size(); }
+    size_t residentPages() const { return std::atomic_load(&resident)->size(); }
+    uint64_t residentMemory() const { return residentBytes; }    ///< Bytes de CPU das páginas residentes (Maze::memoryBytes)
+    unsigned int pendingLoads() const { return loading; }        ///< Páginas pedidas e ainda não instaladas
+    unsigned int skippedPages() const { return skipped; }        ///< Páginas a menos de loadDistance que não couberam no orçamento (último update)
+    unsigned int evictedPages = 0;                               ///< Páginas despejadas desde o início
+
+private:
+    /// Dados escalares da secção META do índice.
+    struct IndexMeta {
+        glm::vec3 minBounds;
+        glm::vec3 maxBounds;
+        glm::vec3 startPosition;
+        glm::vec3 exitPosition;
+        float modelSize;
+        int pagesPerAxis;
+    };
+
+    /// Uma página lida: o Maze com a sua geometria e colisões (maze nulo se a leitura falhou).
+    struct Page {
+        size_t entry = 0;
+        uint64_t bytes = 0;     ///< Maze::memoryBytes() depois de buildCollisionData()
+        std::unique_ptr<Maze> maze;
+    };
+    typedef std::vector<std::shared_ptr<Page>> PageSet;
+
+    enum PageState : unsigned char { NOT_LOADED, LOADING, RESIDENT, FAILED };
+
+    std::string sourcePath;
+    bool packedVertices;
+    bool uploadToGPU;
+    uint64_t memoryBudget;
+    std::vector<PageEntry> entries;
+    std::vector<PageState> states;
+    std::vector<uint64_t> footprint;    ///< Custo de cada página: a medida da última leitura, ou o tamanho do ficheiro
+    std::vector<float> distances;
+    std::vector<size_t> order;
+    std::vector<bool> wanted;
+    uint64_t residentBytes = 0;
+    unsigned int loading = 0;
+    unsigned int skipped = 0;
+
+    std::shared_ptr<const PageSet> resident;    ///< Trocado com atomic_store; lido por qualquer thread
+    std::mutex readyMutex;
+    std::deque<std::shared_ptr<Page>> ready;    ///< Páginas lidas à espera de update()
+    std::unique_ptr<ThreadPool> pool;           ///< Último membro: é destruído (e espera pelas leituras) primeiro
+
+    static float distanceXZ(const glm::vec3& p, const PageEntry& entry) {
+        float dx = std::max({ entry.minBounds.x - p.x, 0.0f, p.x - entry.maxBounds.x });
+        float dz = std::max({ entry.minBounds.z - p.z, 0.0f, p.z - entry.maxBounds.z });
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    void requestLoad(size_t index) {
+        states[index] = LOADING;
+        loading++;
+        std::string path = pagePath(sourcePath, entries[index].id);
+        pool->submit([this, index, path]() {
+            std::shared_ptr<Page> page = std::make_shared<Page>();
+            page->entry = index;
+            std::unique_ptr<Maze> maze(new Maze());
+            maze->packedVertices = packedVertices;
+            if (maze->loadCache(path, sourcePath)) {
+                maze->buildCollisionData();
+                page->bytes = maze->memoryBytes();
+                page->maze = std::move(maze);
+            } else {
+                std::cout << "Aviso: pagina invalida ou desatualizada " << path << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(page);
+        });
+    }
+
+    /// Despeja a página residente mais distante que já não é desejada; false se não houver nenhuma.
+    bool evictFarthest(std::vector<std::shared_ptr<Page>>& pages) {
+        size_t victim = pages.size();
+        for (size_t i = 0; i < pages.size(); i++) {
+            size_t entry = pages[i]->entry;
+            if (wanted[entry]) continue;
+            if (victim == pages.size() || distances[entry] > distances[pages[victim]->entry]) victim = i;
+        }
+        if (victim == pages.size()) return false;
+
+        size_t entry = pages[victim]->entry;
+        if (uploadToGPU) pages[victim]->maze->releaseGPU();
+        residentBytes -= pages[victim]->bytes;
+        pages.erase(pages.begin() + victim);
+        states[entry] = NOT_LOADED;
+        evictedPages++;
+        return true;
+    }
+};
+
+#endif
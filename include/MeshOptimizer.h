@@ -0,0 +1,204 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * @class MeshOptimizer
+ * @brief Utilitários para converter geometria não indexada em geometria indexada e otimizada.
+ *
+ * - weld(): junta vértices com atributos idênticos (posição, normal, UV) e gera o index buffer.
+ * - optimizeVertexCache(): reordena os triângulos para a cache pós-transformação da GPU
+ *   (algoritmo "Linear-Speed Vertex Cache Optimisation" de Tom Forsyth).
+ * - optimizeVertexFetch(): reordena os vértices pela ordem de primeiro uso, para leituras sequenciais.
+ */
+class MeshOptimizer {
+public:
+    /**
+     * @brief Junta vértices idênticos (comparação bit a bit dos atributos).
+     *
+     * @param vertices Vértices intercalados não indexados; substituídos pelos vértices únicos.
+     * @param stride Número de floats por vértice.
+     * @param indices Index buffer resultante (um índice por vértice original).
+     */
+    static void weld(std::vector<float>& vertices, size_t stride, std::vector<unsigned int>& indices) {
+        size_t count = vertices.size() / stride;
+        std::unordered_map<std::string, unsigned int> unique;
+        unique.reserve(count);
+        std::vector<float> welded;
+        welded.reserve(vertices.size());
+        indices.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            std::string key((const char*)&vertices[i * stride], stride * sizeof(float));
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                unsigned int index = (unsigned int)(welded.size() / stride);
+                unique.emplace(std::move(key), index);
+                welded.insert(welded.end(), vertices.begin() + i * stride, vertices.begin() + (i + 1) * stride);
+                indices[i] = index;
+            } else {
+                indices[i] = it->second;
+            }
+        }
+        vertices.swap(welded);
+    }
+
+    /**
+     * @brief Reordena triângulos para maximizar os acertos na cache de vértices pós-transformação.
+     *
+     * @param indices Lista de triângulos (3 índices cada), reordenada no próprio vetor.
+     * @param vertexCount Número de vértices referenciados.
+     */
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+        size_t triCount = indices.size() / 3;
+        if (triCount == 0) return;
+
+        // Adjacência vértice -> triângulos (CSR)
+        std::vector<unsigned int> valence(vertexCount, 0);
+        for (unsigned int idx : indices) valence[idx]++;
+        std::vector<unsigned int> adjOffset(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++) adjOffset[v + 1] = adjOffset[v] + valence[v];
+        std::vector<unsigned int> adjacency(indices.size());
+        std::vector<unsigned int> fill(adjOffset.begin(), adjOffset.end() - 1);
+        for (size_t t = 0; t < triCount; t++) {
+            for (int k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+        }
+
+        std::vector<int> cachePos(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) vertexScore[v] = score(-1, valence[v]);
+
+        std::vector<float> triScore(triCount);
+        std::vector<char> emitted(triCount, 0);
+        for (size_t t = 0; t < triCount; t++) {
+            triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        }
+
+        std::vector<unsigned int> cache, nextCache;
+        cache.reserve(CACHE_SIZE + 3);
+        nextCache.reserve(CACHE_SIZE + 3);
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+
+        size_t scanCursor = 0;
+        long best = -1;
+        for (size_t emittedCount = 0; emittedCount < triCount; emittedCount++) {
+            if (best < 0) {
+                // Sem candidatos na cache: recomeçar a partir do próximo triângulo por emitir
+                while (emitted[scanCursor]) scanCursor++;
+                best = (long)scanCursor;
+            }
+
+            unsigned int tri[3] = {indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+            output.insert(output.end(), tri, tri + 3);
+            emitted[best] = 1;
+
+            // Remover o triângulo da adjacência dos seus vértices
+            for (unsigned int v : tri) {
+                unsigned int* begin = &adjacency[adjOffset[v]];
+                unsigned int* end = begin + valence[v];
+                for (unsigned int* it = begin; it != end; ++it) {
+                    if (*it == (unsigned int)best) {
+                        *it = *(end - 1);
+                        break;
+                    }
+                }
+                valence[v]--;
+            }
+
+            // Atualizar cache LRU: vértices do triângulo vão para o topo
+            nextCache.assign(tri, tri + 3);
+            for (unsigned int v : cache) {
+                if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+            }
+            for (size_t i = 0; i < nextCache.size(); i++) {
+                cachePos[nextCache[i]] = i < CACHE_SIZE ? (int)i : -1;
+            }
+
+            // Recalcular pontuações dos vértices afetados e dos seus triângulos
+            best = -1;
+            float bestScore = -1.0f;
+            for (unsigned int v : nextCache) {
+                vertexScore[v] = score(cachePos[v], valence[v]);
+            }
+            for (unsigned int v : nextCache) {
+                for (unsigned int a = adjOffset[v]; a < adjOffset[v] + valence[v]; a++) {
+                    unsigned int t = adjacency[a];
+                    triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                    if (triScore[t] > bestScore) {
+                        bestScore = triScore[t];
+                        best = (long)t;
+                    }
+                }
+            }
+
+            if (nextCache.size() > CACHE_SIZE) nextCache.resize(CACHE_SIZE);
+            cache.swap(nextCache);
+        }
+        indices.swap(output);
+    }
+
+    /**
+     * @brief Reordena os vértices pela ordem em que o index buffer os usa pela primeira vez.
+     */
+    static void optimizeVertexFetch(std::vector<float>& vertices, size_t stride, std::vector<unsigned int>& indices) {
+        size_t count = vertices.size() / stride;
+        std::vector<unsigned int> remap(count, ~0u);
+        std::vector<float> reordered;
+        reordered.reserve(vertices.size());
+        unsigned int next = 0;
+        for (unsigned int& idx : indices) {
+            if (remap[idx] == ~0u) {
+                remap[idx] = next++;
+                reordered.insert(reordered.end(), vertices.begin() + idx * stride, vertices.begin() + (idx + 1) * stride);
+            }
+            idx = remap[idx];
+        }
+        vertices.swap(reordered);
+    }
+
+    /**
+     * @brief Número médio de vértices transformados por triângulo (ACMR) numa cache FIFO.
+     * Útil para medir o efeito de optimizeVertexCache() (1.0 é excelente, 3.0 é o pior caso).
+     */
+    static float acmr(const std::vector<unsigned int>& indices, size_t vertexCount, size_t fifoSize = 16) {
+        if (indices.empty()) return 0.0f;
+        std::vector<size_t> stamp(vertexCount, 0);
+        size_t time = fifoSize + 1, misses = 0;
+        for (unsigned int idx : indices) {
+            if (time - stamp[idx] > fifoSize) {
+                stamp[idx] = time++;
+                misses++;
+            }
+        }
+        return (float)misses / (float)(indices.size() / 3);
+    }
+
+private:
+    static const size_t CACHE_SIZE = 32;    ///< Tamanho da cache LRU simulada
+
+    /// Pontuação de um vértice segundo a posição na cache e o número de triângulos por emitir.
+    static float score(int position, unsigned int remaining) {
+        if (remaining == 0) return -1.0f;
+        float s = 0.0f;
+        if (position >= 0) {
+            if (position < 3) {
+                s = 0.75f;  // Os três vértices do último triângulo têm pontuação fixa
+            } else {
+                float scaler = 1.0f / (CACHE_SIZE - 3);
+                s = std::pow(1.0f - (position - 3) * scaler, 1.5f);
+            }
+        }
+        // Favorecer vértices com poucos triângulos restantes (evita deixar "ilhas" isoladas)
+        s += 2.0f / std::sqrt((float)remaining);
+        return s;
+    }
+};
+
+#endif
@@ -0,0 +1,368 @@
+#ifndef NAV_GRID_H
+#define NAV_GRID_H
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+#include <Maze.h>
+#include <ThreadPool.h>
+
+/**
+ * @struct NavGridParams
+ * @brief Dimensões do agente e resolução de uma NavGrid.
+ */
+struct NavGridParams {
+    float cellSize = 20.0f;     ///< Lado de cada célula
+    float eyeHeight = 50.0f;    ///< Altura dos olhos acima do chão (como simulationTick())
+    float radius = 5.0f;        ///< Raio da esfera de colisão do jogador
+    float stepHeight = Maze::MAX_STEP_HEIGHT;   ///< Maior subida entre células vizinhas
+};
+
+/**
+ * @class NavGrid
+ * @brief Grafo de navegação em grelha XZ construído a partir das consultas de colisão do labirinto.
+ *
+ * Cada célula tem a altura de Maze::getFloorHeight() no seu centro e é caminhável se houver
+ * chão e a esfera do jogador (olhos a eyeHeight do chão) não tocar numa parede. As ligações às
+ * 8 vizinhas seguem as mesmas regras de simulationTick(): o varrimento da esfera entre os
+ * centros não pode ter contacto e a subida não pode passar de Maze::MAX_STEP_HEIGHT. Como
+ * descer não tem limite, as ligações são dirigidas (uma queda não se volta a subir).
+ *
+ * Tal como getFloorHeight(), a grelha é 2.5D: uma altura por célula (o chão mais alto).
+ * Depois de build() é só de leitura, pelo que findPath() pode correr em várias threads.
+ */
+class NavGrid {
+public:
+    typedef NavGridParams Params;
+
+    /**
+     * @struct Path
+     * @brief Resultado de uma procura: pontos ao nível do chão, do início ao destino.
+     */
+    struct Path {
+        bool found = false;
+        std::vector<glm::vec3> points;  ///< Centros das células nos cantos do caminho (troços retos fundidos)
+        float length = 0.0f;            ///< Comprimento em XZ
+    };
+
+    static const size_t BUILD_GRAIN = 1024;    ///< Células por tarefa em build()
+
+    /**
+     * @brief Amostra o chão e as paredes do labirinto e liga as células.
+     *
+     * As células são independentes, pelo que as consultas (a maior parte do custo) correm em
+     * paralelo no pool; o labirinto só é lido (pode estar a ser usado pela simulação).
+     *
+     * @param pool Pool onde distribuir o trabalho; nullptr corre na thread atual.
+     */
+    void build(Maze& maze, const Params& p = Params(), ThreadPool* pool = nullptr) {
+        params = p;
+        origin = glm::vec2(maze.minBounds.x, maze.minBounds.z);
+        width = std::max(1, (int)std::ceil((maze.maxBounds.x - maze.minBounds.x) / params.cellSize));
+        depth = std::max(1, (int)std::ceil((maze.maxBounds.z - maze.minBounds.z) / params.cellSize));
+        size_t cellCount = (size_t)width * depth;
+        heights.assign(cellCount, NO_FLOOR);
+        links.assign(cellCount, 0);
+
+        auto run = [&](size_t begin, size_t end, bool connect) {
+            for (size_t c = begin; c < end; c++) {
+                if (!connect) {
+                    glm::vec3 center = cellCenter((int)c);
+                    float h = maze.getFloorHeight(center);
+                    if (h < -90000.0f) continue;
+                    if (maze.checkWallCollision(glm::vec3(center.x, h + params.eyeHeight, center.z), params.radius)) continue;
+                    heights[c] = h;
+                    continue;
+                }
+                if (heights[c] == NO_FLOOR) continue;
+                int x = (int)c % width, z = (int)c / width;
+                glm::vec3 eye = cellCenter((int)c) + glm::vec3(0.0f, heights[c] + params.eyeHeight, 0.0f);
+                uint8_t mask = 0;
+                for (int d = 0; d < DIRECTIONS; d++) {
+                    int nx = x + DX[d], nz = z + DZ[d];
+                    if (nx < 0 || nz < 0 || nx >= width || nz >= depth) continue;
+                    int n = nx + nz * width;
+                    if (heights[n] == NO_FLOOR || heights[n] - heights[c] > params.stepHeight) continue;
+                    Maze::SweepHit hit;
+                    glm::vec3 delta(DX[d] * params.cellSize, 0.0f, DZ[d] * params.cellSize);
+                    if (maze.sweepSphere(eye, delta, params.radius, hit)) continue;
+                    mask |= (uint8_t)(1 << d);
+                }
+                links[c] = mask;
+            }
+        };
+        // Primeiro todas as alturas, depois as ligações (que leem as alturas das vizinhas)
+        for (bool connect : { false, true }) {
+            auto pass = [&](size_t begin, size_t end) { run(begin, end, connect); };
+            if (pool) pool->parallelFor(cellCount, BUILD_GRAIN, pass);
+            else pass(0, cellCount);
+        }
+
+        walkable = 0;
+        for (float h : heights) walkable += h != NO_FLOOR;
+    }
+
+    bool empty() const { return walkable == 0; }
+    size_t cellCount() const { return heights.size(); }
+    size_t walkableCells() const { return walkable; }
+    const Params& parameters() const { return params; }
+
+    /**
+     * @brief Célula caminhável de pos ou, se essa não for, a mais próxima das 8 vizinhas.
+     * @return Índice da célula, ou -1.
+     */
+    int cellAt(const glm::vec3& pos) const {
+        if (heights.empty()) return -1;
+        int x = (int)std::floor((pos.x - origin.x) / params.cellSize);
+        int z = (int)std::floor((pos.z - origin.y) / params.cellSize);
+        if (x >= 0 && z >= 0 && x < width && z < depth && heights[x + z * width] != NO_FLOOR) return x + z * width;
+        int best = -1;
+        float bestDistance = std::numeric_limits<float>::max();
+        for (int d = 0; d < DIRECTIONS; d++) {
+            int cx = x + DX[d], cz = z + DZ[d];
+            if (cx < 0 || cz < 0 || cx >= width || cz >= depth) continue;
+            int c = cx + cz * width;
+            if (heights[c] == NO_FLOOR) continue;
+            glm::vec3 center = cellCenter(c);
+            float distance = glm::distance(glm::vec2(center.x, center.z), glm::vec2(pos.x, pos.z));
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    /// Centro de uma célula ao nível do chão (y = 0 se não for caminhável).
+    glm::vec3 cellPosition(int cell) const {
+        glm::vec3 p = cellCenter(cell);
+        if (heights[cell] != NO_FLOOR) p.y = heights[cell];
+        return p;
+    }
+
+    /**
+     * @brief Caminho mais curto de from até to (A* com heurística octil).
+     *
+     * O estado da procura é local à chamada, pelo que chamadas concorrentes são seguras.
+     */
+    Path findPath(const glm::vec3& from, const glm::vec3& to) const {
+        Path path;
+        int start = cellAt(from), goal = cellAt(to);
+        if (start < 0 || goal < 0) return path;
+
+        int gx = goal % width, gz = goal / width;
+        auto heuristic = [&](int c) {
+            float dx = (float)std::abs(c % width - gx), dz = (float)std::abs(c / width - gz);
+            return (std::max(dx, dz) + (std::sqrt(2.0f) - 1.0f) * std::min(dx, dz)) * params.cellSize;
+        };
+
+        std::vector<float> cost(heights.size(), std::numeric_limits<float>::max());
+        std::vector<int> parent(heights.size(), -1);
+        std::vector<bool> closed(heights.size(), false);
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        cost[start] = 0.0f;
+        open.push({ heuristic(start), start });
+        while (!open.empty()) {
+            int c = open.top().second;
+            open.pop();
+            if (closed[c]) continue;
+            closed[c] = true;
+            if (c == goal) break;
+            for (int d = 0; d < DIRECTIONS; d++) {
+                if (!(links[c] & (1 << d))) continue;
+                int n = c + DX[d] + DZ[d] * width;
+                float next = cost[c] + STEP_COST[d] * params.cellSize;
+                if (closed[n] || next >= cost[n]) continue;
+                cost[n] = next;
+                parent[n] = c;
+                open.push({ next + heuristic(n), n });
+            }
+        }
+
+        if (!closed[goal]) return path;
+        std::vector<int> cells;
+        for (int c = goal; c >= 0; c = parent[c]) cells.push_back(c);
+        std::reverse(cells.begin(), cells.end());
+
+        path.found = true;
+        path.length = cost[goal];
+        for (size_t i = 0; i < cells.size(); i++) {
+            // Manter só os cantos: pontos onde a direção muda
+            if (i > 0 && i + 1 < cells.size() && cells[i] - cells[i - 1] == cells[i + 1] - cells[i]) continue;
+            path.points.push_back(cellPosition(cells[i]));
+        }
+        return path;
+    }
+
+    /**
+     * @brief Célula alcançável mais distante (pelo caminho) de from, para colocar uma saída.
+     * @param distance Saída opcional: comprimento do caminho até essa célula.
+     * @return Posição ao nível do chão (from se from não estiver na grelha).
+     */
+    glm::vec3 farthestFrom(const glm::vec3& from, float* distance = nullptr) const {
+        int start = cellAt(from);
+        if (distance) *distance = 0.0f;
+        if (start < 0) return from;
+
+        std::vector<float> cost(heights.size(), std::numeric_limits<float>::max());
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        cost[start] = 0.0f;
+        open.push({ 0.0f, start });
+        int farthest = start;
+        while (!open.empty()) {
+            Entry top = open.top();
+            open.pop();
+            int c = top.second;
+            if (top.first > cost[c]) continue;
+            if (cost[c] > cost[farthest]) farthest = c;
+            for (int d = 0; d < DIRECTIONS; d++) {
+                if (!(links[c] & (1 << d))) continue;
+                int n = c + DX[d] + DZ[d] * width;
+                float next = cost[c] + STEP_COST[d] * params.cellSize;
+                if (next >= cost[n]) continue;
+                cost[n] = next;
+                open.push({ next, n });
+            }
+        }
+        if (distance) *distance = cost[farthest];
+        return cellPosition(farthest);
+    }
+
+    /**
+     * @brief Pontos a intervalos regulares ao longo de um caminho (marcadores de pista).
+     * @param spacing Distância entre pontos, medida ao longo do caminho.
+     * @param maxCount Número máximo de pontos (os mais próximos do início).
+     */
+    static std::vector<glm::vec3> samplePath(const std::vector<glm::vec3>& points, float spacing, size_t maxCount) {
+        std::vector<glm::vec3> samples;
+        float next = spacing;   // O primeiro ponto é a posição atual: não leva marcador
+        float travelled = 0.0f;
+        for (size_t i = 1; i < points.size() && samples.size() < maxCount; i++) {
+            float segment = glm::length(points[i] - points[i - 1]);
+            if (segment <= 0.0f) continue;
+            while (next <= travelled + segment && samples.size() < maxCount) {
+                samples.push_back(glm::mix(points[i - 1], points[i], (next - travelled) / segment));
+                next += spacing;
+            }
+            travelled += segment;
+        }
+        return samples;
+    }
+
+private:
+    static const int DIRECTIONS = 8;
+    static constexpr int DX[DIRECTIONS] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+    static constexpr int DZ[DIRECTIONS] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+    static constexpr float STEP_COST[DIRECTIONS] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+    static constexpr float NO_FLOOR = std::numeric_limits<float>::lowest();
+
+    Params params;
+    glm::vec2 origin = glm::vec2(0.0f);     ///< Canto mínimo (x, z) da grelha
+    int width = 0, depth = 0;               ///< Células em X e em Z
+    std::vector<float> heights;             ///< Altura do chão de cada célula (NO_FLOOR se não for caminhável)
+    std::vector<uint8_t> links;             ///< Bit d: ligação para a vizinha DX[d], DZ[d]
+    size_t walkable = 0;
+
+    glm::vec3 cellCenter(int c) const {
+        return glm::vec3(origin.x + (c % width + 0.5f) * params.cellSize, 0.0f, origin.y + (c / width + 0.5f) * params.cellSize);
+    }
+};
+
+/**
+ * @class PathFinder
+ * @brief Serviço de procura de caminhos fora da thread de render.
+ *
+ * A NavGrid é construída num ThreadPool a partir do construtor; request() devolve logo um
+ * número de pedido e o caminho fica disponível em poll() quando a procura terminar. Pedidos
+ * feitos antes de a grelha estar pronta ficam retidos e são agendados no fim da construção.
+ * O labirinto tem de existir enquanto a grelha estiver a ser construída.
+ */
+class PathFinder {
+public:
+    explicit PathFinder(Maze& maze, const NavGrid::Params& params = NavGrid::Params(), unsigned threadCount = 1)
+        : pool(new ThreadPool(threadCount)) {
+        pool->submit([this, &maze, params]() {
+            navGrid.build(maze, params, pool.get());
+            std::lock_guard<std::mutex> lock(mutex);
+            built = true;
+            for (auto& held : heldRequests) schedule(held.first, held.second);
+            heldRequests.clear();
+        });
+    }
+
+    PathFinder(const PathFinder&) = delete;
+    PathFinder& operator=(const PathFinder&) = delete;
+
+    ~PathFinder() {
+        pool.reset();   // Espera pela construção e pelas procuras em curso
+    }
+
+    /// true quando a grelha está construída (a partir daí, grid() pode ser lida em qualquer thread).
+    bool ready() const { return built; }
+    const NavGrid& grid() const { return navGrid; }
+
+    /**
+     * @brief Agenda uma procura de from até to.
+     * @return Número do pedido, a passar a poll().
+     */
+    unsigned request(const glm::vec3& from, const glm::vec3& to) {
+        std::lock_guard<std::mutex> lock(mutex);
+        unsigned id = nextRequest++;
+        if (built) schedule(id, std::make_pair(from, to));
+        else heldRequests.push_back(std::make_pair(id, std::make_pair(from, to)));
+        outstanding++;
+        return id;
+    }
+
+    /**
+     * @brief Resultado de um pedido, se já estiver pronto (é entregue uma única vez).
+     * @return true se path foi preenchido.
+     */
+    bool poll(unsigned id, NavGrid::Path& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = results.find(id);
+        if (found == results.end()) return false;
+        path = std::move(found->second);
+        results.erase(found);
+        return true;
+    }
+
+    /// Pedidos ainda sem resultado.
+    size_t pending() const { return outstanding; }
+
+private:
+    typedef std::pair<glm::vec3, glm::vec3> Query;
+
+    NavGrid navGrid;
+    std::atomic<bool> built{false};
+    std::atomic<size_t> outstanding{0};
+    std::mutex mutex;
+    unsigned nextRequest = 1;
+    std::deque<std::pair<unsigned, Query>> heldRequests;
+    std::unordered_map<unsigned, NavGrid::Path> results;
+    std::unique_ptr<ThreadPool> pool;   ///< Último membro: é destruído (e espera pelas tarefas) primeiro
+
+    /// Chamado com mutex.
+    void schedule(unsigned id, const Query& query) {
+        pool->submit([this, id, query]() {
+            NavGrid::Path path = navGrid.findPath(query.first, query.second);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[id] = std::move(path);
+            outstanding--;
+        });
+    }
+};
+
+#endif
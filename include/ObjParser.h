@@ -0,0 +1,337 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <tiny_obj_loader.h>
+#include <ThreadPool.h>
+
+/**
+ * @class ObjParser
+ * @brief Leitor paralelo da parte do formato OBJ que os labirintos usam (v, f, usemtl, mtllib).
+ *
+ * O ficheiro é lido de uma vez e dividido em blocos que terminam em fim de linha. Três passagens
+ * paralelas sobre os blocos: a primeira conta vértices e triângulos (para dimensionar as saídas
+ * e saber o índice global do primeiro de cada bloco), a segunda lê as posições e a terceira os
+ * triângulos, já nas posições finais. O material ativo no início de cada bloco vem do último
+ * usemtl dos blocos anteriores.
+ *
+ * A triangulação segue a do tinyobjloader: quadriláteros pela diagonal mais curta e polígonos
+ * maiores em leque (os labirintos só têm triângulos e quadriláteros). Os ficheiros MTL continuam
+ * a ser lidos com tinyobj::LoadMtl.
+ */
+class ObjParser {
+public:
+    /**
+     * @struct Mesh
+     * @brief Resultado da leitura: posições partilhadas e triângulos indexados, pela ordem do ficheiro.
+     */
+    struct Mesh {
+        std::vector<float> positions;           ///< x, y, z por vértice
+        std::vector<uint32_t> indices;          ///< 3 índices (base 0) por triângulo
+        std::vector<int> materialIds;           ///< Material de cada triângulo (-1 sem material)
+        std::vector<tinyobj::material_t> materials; ///< Materiais dos mtllib, pela ordem de definição
+        std::string warning;                    ///< Avisos (materiais em falta, faces inválidas)
+
+        size_t triangleCount() const { return materialIds.size(); }
+    };
+
+    static const size_t MIN_BLOCK_BYTES = 256u << 10;   ///< Blocos mais pequenos não compensam o custo por tarefa
+
+    /**
+     * @brief Lê um ficheiro OBJ.
+     * @param path Caminho do OBJ.
+     * @param mtlSearchPath Diretório (com '/' final) onde procurar os ficheiros dos mtllib.
+     * @param mesh Saída.
+     * @param pool Pool onde distribuir os blocos; nullptr corre na thread atual.
+     * @param error Mensagem de erro, se a leitura falhar.
+     */
+    static bool load(const std::string& path, const std::string& mtlSearchPath, Mesh& mesh,
+                     ThreadPool* pool = nullptr, std::string* error = nullptr) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            if (error) *error = "Nao foi possivel abrir " + path;
+            return false;
+        }
+        std::vector<char> text((size_t)file.tellg());
+        file.seekg(0);
+        file.read(text.data(), (std::streamsize)text.size());
+        if (!file) {
+            if (error) *error = "Erro ao ler " + path;
+            return false;
+        }
+        parse(text.data(), text.size(), mtlSearchPath, mesh, pool);
+        return true;
+    }
+
+    /// Lê o OBJ a partir de memória (ver load()).
+    static void parse(const char* data, size_t size, const std::string& mtlSearchPath, Mesh& mesh, ThreadPool* pool = nullptr) {
+        mesh = Mesh();
+
+        // Blocos terminados em '\n'
+        size_t workers = pool ? pool->size() + 1 : 1;
+        size_t blockCount = std::max<size_t>(1, std::min(workers * 4, size / MIN_BLOCK_BYTES));
+        std::vector<Block> blocks(blockCount);
+        size_t begin = 0;
+        for (size_t b = 0; b < blockCount; b++) {
+            size_t end = b + 1 == blockCount ? size : std::max(begin, size * (b + 1) / blockCount);
+            while (end < size && data[end - 1] != '\n') end++;
+            blocks[b].begin = begin;
+            blocks[b].end = end;
+            begin = end;
+        }
+        auto forEachBlock = [&](auto&& fn) {
+            auto run = [&](size_t first, size_t last) {
+                for (size_t b = first; b < last; b++) fn(blocks[b]);
+            };
+            if (pool) pool->parallelFor(blockCount, 1, run);
+            else run(0, blockCount);
+        };
+
+        // 1. Contagens, usemtl e mtllib por bloco
+        forEachBlock([&](Block& block) {
+            forEachLine(data, block, [&](const char* line, const char* end) {
+                if (isCommand(line, end, "v")) {
+                    block.vertexCount++;
+                } else if (isCommand(line, end, "f")) {
+                    size_t corners = countTokens(line + 1, end);
+                    if (corners >= 3) block.triangleCount += corners - 2;
+                } else if (isCommand(line, end, "usemtl")) {
+                    block.lastMaterial = trim(line + 6, end);
+                    block.hasMaterial = true;
+                } else if (isCommand(line, end, "mtllib")) {
+                    block.materialLibraries.push_back(trim(line + 6, end));
+                }
+            });
+        });
+
+        // Prefixos (em série: um valor por bloco)
+        std::map<std::string, int> materialMap;
+        size_t vertexBase = 0, triangleBase = 0;
+        std::string currentMaterial;
+        bool hasMaterial = false;
+        std::vector<std::string> loadedLibraries;
+        for (Block& block : blocks) {
+            block.vertexBase = vertexBase;
+            block.triangleBase = triangleBase;
+            block.initialMaterial = hasMaterial ? currentMaterial : std::string();
+            vertexBase += block.vertexCount;
+            triangleBase += block.triangleCount;
+            if (block.hasMaterial) {
+                currentMaterial = block.lastMaterial;
+                hasMaterial = true;
+            }
+            for (const std::string& names : block.materialLibraries) {
+                loadMaterialLibraries(names, mtlSearchPath, loadedLibraries, materialMap, mesh);
+            }
+        }
+        mesh.positions.resize(vertexBase * 3);
+        mesh.indices.resize(triangleBase * 3);
+        mesh.materialIds.resize(triangleBase);
+
+        // 2. Posições
+        forEachBlock([&](Block& block) {
+            float* out = &mesh.positions[block.vertexBase * 3];
+            forEachLine(data, block, [&](const char* line, const char* end) {
+                if (!isCommand(line, end, "v")) return;
+                const char* p = line + 1;
+                for (int k = 0; k < 3; k++) *out++ = parseFloat(p, end);
+            });
+        });
+
+        // 3. Triângulos (precisa das posições de todos os blocos para os quadriláteros)
+        std::atomic<size_t> invalidFaces(0);
+        std::mutex warningMutex;
+        forEachBlock([&](Block& block) {
+            size_t vertexCount = block.vertexBase;
+            size_t triangle = block.triangleBase;
+            int material = materialId(materialMap, block.initialMaterial, mesh, warningMutex);
+            std::vector<uint32_t> corners;
+            forEachLine(data, block, [&](const char* line, const char* end) {
+                if (isCommand(line, end, "v")) {
+                    vertexCount++;
+                } else if (isCommand(line, end, "usemtl")) {
+                    material = materialId(materialMap, trim(line + 6, end), mesh, warningMutex);
+                } else if (isCommand(line, end, "f")) {
+                    corners.clear();
+                    bool valid = parseFace(line + 1, end, vertexCount, corners);
+                    if (corners.size() < 3) return;
+                    size_t produced = corners.size() - 2;
+                    if (!valid) {
+                        invalidFaces++;
+                        std::fill_n(&mesh.materialIds[triangle], produced, INVALID);
+                        triangle += produced;
+                        return;
+                    }
+                    triangulate(mesh.positions, corners, &mesh.indices[triangle * 3]);
+                    std::fill_n(&mesh.materialIds[triangle], produced, material);
+                    triangle += produced;
+                }
+            });
+        });
+
+        // Faces com índices fora do intervalo (raras): compactar em série
+        if (invalidFaces > 0) {
+            size_t kept = 0;
+            for (size_t t = 0; t < mesh.materialIds.size(); t++) {
+                if (mesh.materialIds[t] == INVALID) continue;
+                mesh.materialIds[kept] = mesh.materialIds[t];
+                for (int k = 0; k < 3; k++) mesh.indices[kept * 3 + k] = mesh.indices[t * 3 + k];
+                kept++;
+            }
+            mesh.materialIds.resize(kept);
+            mesh.indices.resize(kept * 3);
+            mesh.warning += "Faces com indices invalidos ignoradas: " + std::to_string(invalidFaces.load()) + "\n";
+        }
+    }
+
+private:
+    static const int INVALID = -2;  ///< Marca temporária dos triângulos de faces inválidas
+
+    struct Block {
+        size_t begin = 0, end = 0;
+        size_t vertexCount = 0, triangleCount = 0;
+        size_t vertexBase = 0, triangleBase = 0;
+        bool hasMaterial = false;
+        std::string lastMaterial;       ///< Último usemtl do bloco
+        std::string initialMaterial;    ///< Material ativo no início do bloco
+        std::vector<std::string> materialLibraries;
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    /// Chama fn(início, fim) para cada linha do bloco, sem espaços iniciais nem '\n'.
+    template <typename F>
+    static void forEachLine(const char* data, const Block& block, F&& fn) {
+        const char* p = data + block.begin;
+        const char* end = data + block.end;
+        while (p < end) {
+            const char* lineEnd = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+            if (!lineEnd) lineEnd = end;
+            const char* line = p;
+            while (line < lineEnd && isSpace(*line)) line++;
+            if (line < lineEnd && *line != '#') fn(line, lineEnd);
+            p = lineEnd + 1;
+        }
+    }
+
+    static bool isCommand(const char* line, const char* end, const char* command) {
+        size_t length = std::strlen(command);
+        return (size_t)(end - line) > length && std::memcmp(line, command, length) == 0 && isSpace(line[length]);
+    }
+
+    static std::string trim(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) p++;
+        while (end > p && isSpace(end[-1])) end--;
+        return std::string(p, end);
+    }
+
+    static size_t countTokens(const char* p, const char* end) {
+        size_t count = 0;
+        while (p < end) {
+            while (p < end && isSpace(*p)) p++;
+            if (p == end) break;
+            count++;
+            while (p < end && !isSpace(*p)) p++;
+        }
+        return count;
+    }
+
+    /// Lê o próximo número da linha (0 se não houver); avança p.
+    static float parseFloat(const char*& p, const char* end) {
+        while (p < end && isSpace(*p)) p++;
+        char buffer[64];
+        size_t length = 0;
+        while (p < end && !isSpace(*p) && length + 1 < sizeof(buffer)) buffer[length++] = *p++;
+        buffer[length] = '\0';
+        return (float)std::strtod(buffer, nullptr);
+    }
+
+    /**
+     * @brief Lê os índices de posição de uma face ("v", "v/vt", "v//vn" ou "v/vt/vn").
+     * @param vertexCount Vértices definidos antes desta linha (para índices negativos).
+     * @return false se algum índice estiver fora do intervalo.
+     */
+    static bool parseFace(const char* p, const char* end, size_t vertexCount, std::vector<uint32_t>& corners) {
+        bool valid = true;
+        while (p < end) {
+            while (p < end && isSpace(*p)) p++;
+            if (p == end) break;
+            long index = std::strtol(p, nullptr, 10);
+            while (p < end && !isSpace(*p)) p++;
+            long resolved = index > 0 ? index - 1 : (long)vertexCount + index;
+            if (index == 0 || resolved < 0 || resolved >= (long)vertexCount) {
+                valid = false;
+                resolved = 0;
+            }
+            corners.push_back((uint32_t)resolved);
+        }
+        return valid;
+    }
+
+    /// Escreve os corners.size() - 2 triângulos de uma face.
+    static void triangulate(const std::vector<float>& positions, const std::vector<uint32_t>& corners, uint32_t* out) {
+        if (corners.size() == 4) {
+            auto distance2 = [&](uint32_t a, uint32_t b) {
+                float dx = positions[b * 3] - positions[a * 3];
+                float dy = positions[b * 3 + 1] - positions[a * 3 + 1];
+                float dz = positions[b * 3 + 2] - positions[a * 3 + 2];
+                return dx * dx + dy * dy + dz * dz;
+            };
+            static const int split02[6] = { 0, 1, 2, 0, 2, 3 }, split13[6] = { 0, 1, 3, 1, 2, 3 };
+            const int* order = distance2(corners[0], corners[2]) < distance2(corners[1], corners[3]) ? split02 : split13;
+            for (int k = 0; k < 6; k++) out[k] = corners[order[k]];
+            return;
+        }
+        for (size_t k = 1; k + 1 < corners.size(); k++) {
+            *out++ = corners[0];
+            *out++ = corners[k];
+            *out++ = corners[k + 1];
+        }
+    }
+
+    static int materialId(const std::map<std::string, int>& materialMap, const std::string& name, Mesh& mesh, std::mutex& warningMutex) {
+        if (name.empty()) return -1;
+        auto found = materialMap.find(name);
+        if (found != materialMap.end()) return found->second;
+        std::string message = "Material inexistente: " + name + "\n";
+        std::lock_guard<std::mutex> lock(warningMutex);
+        if (mesh.warning.find(message) == std::string::npos) mesh.warning += message;
+        return -1;
+    }
+
+    /// Lê os ficheiros de uma linha mtllib que ainda não foram lidos.
+    static void loadMaterialLibraries(const std::string& names, const std::string& searchPath, std::vector<std::string>& loaded,
+                                      std::map<std::string, int>& materialMap, Mesh& mesh) {
+        const char* p = names.c_str();
+        const char* end = p + names.size();
+        while (p < end) {
+            while (p < end && isSpace(*p)) p++;
+            const char* start = p;
+            while (p < end && !isSpace(*p)) p++;
+            std::string name(start, p);
+            if (name.empty() || std::find(loaded.begin(), loaded.end(), name) != loaded.end()) continue;
+            loaded.push_back(name);
+
+            std::ifstream stream(searchPath + name);
+            if (!stream) {
+                mesh.warning += "Ficheiro de materiais nao encontrado: " + searchPath + name + "\n";
+                continue;
+            }
+            std::string warning, error;
+            tinyobj::LoadMtl(&materialMap, &mesh.materials, &stream, &warning, &error);
+            mesh.warning += warning + error;
+        }
+    }
+};
+
+#endif
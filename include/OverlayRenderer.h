@@ -41,6 +41,7 @@ public:
         shader.setFloat("alpha", alpha);
         shader.setFloat("time", time);
         shader.setVec2("scale", glm::vec2(1.0f, 1.0f)); 
+        shader.setVec2("offset", glm::vec2(0.0f));
         
         glBindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -65,6 +66,7 @@ public:
             scale.y = scrAspect / imgAspect;
         }
         shader.setVec2("scale", scale);
+        shader.setVec2("offset", glm::vec2(0.0f));
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texture);
@@ -76,6 +78,27 @@ public:
         shader.setInt("useTexture", 0);  
     }
 
+    /**
+     * @brief Desenha um retângulo de cor sólida em coordenadas de ecrã (píxeis, origem no canto superior esquerdo).
+     *
+     * Usado pelo HUD do perfilador; espera blending ativo para respeitar alpha.
+     */
+    void renderRect(Shader& shader, float x, float y, float width, float height,
+                    float scrWidth, float scrHeight, glm::vec3 color, float alpha) {
+        shader.use();
+        shader.setVec3("overlayColor", color);
+        shader.setFloat("alpha", alpha);
+        shader.setInt("useTexture", 2);
+        shader.setVec2("scale", glm::vec2(width / scrWidth, height / scrHeight));
+        shader.setVec2("offset", glm::vec2((x + width * 0.5f) / scrWidth * 2.0f - 1.0f,
+                                           1.0f - (y + height * 0.5f) / scrHeight * 2.0f));
+
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        shader.setInt("useTexture", 0);
+    }
+
     ~OverlayRenderer() {
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
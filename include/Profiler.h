@@ -0,0 +1,338 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shader_m.h>
+#include <OverlayRenderer.h>
+
+/**
+ * @class Profiler
+ * @brief Perfilador de frame: tempos de GPU por pass (GL_TIME_ELAPSED) e tempos de CPU por secção.
+ *
+ * Cada secção guarda um histórico circular de HISTORY frames, de onde saem o mínimo, a
+ * média e o máximo. As queries de GPU usam QUERY_LATENCY cópias por secção e só são lidas
+ * quando o resultado já está disponível, para nunca bloquear o pipeline. As secções de CPU
+ * podem ser alimentadas por qualquer thread (a simulação corre noutra); as amostras são
+ * somadas até ao fim do frame.
+ *
+ * Para corridas de benchmark (replay), startLog() guarda também todos os frames desde esse
+ * ponto, sem o limite do histórico, para writeLogCsv() e writeSummary().
+ */
+class Profiler {
+public:
+    static const int HISTORY = 240;         ///< Frames guardados no histórico
+    static const int QUERY_LATENCY = 4;     ///< Frames de atraso aceites na leitura das queries
+
+    /// Estatísticas de uma secção sobre o histórico (ms).
+    struct Stats {
+        float min = 0.0f, avg = 0.0f, max = 0.0f;
+    };
+
+    /**
+     * @struct Section
+     * @brief Uma secção medida (um pass de GPU ou um bloco de CPU).
+     */
+    struct Section {
+        std::string name;
+        bool gpu;                               ///< true: GL_TIME_ELAPSED; false: relógio de CPU
+        glm::vec3 color;                        ///< Cor no HUD
+        GLuint queries[QUERY_LATENCY] = {};     ///< Queries em voo (apenas GPU)
+        bool issued[QUERY_LATENCY] = {};        ///< A query do slot foi emitida e ainda não lida
+        std::atomic<uint64_t> cpuNanos{0};      ///< Tempo de CPU acumulado no frame atual
+        float history[HISTORY] = {};            ///< Tempos por frame (ms)
+    };
+
+    Profiler() {}
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ~Profiler() {
+        for (auto& section : sections) {
+            if (section->gpu && section->queries[0]) glDeleteQueries(QUERY_LATENCY, section->queries);
+        }
+    }
+
+    /**
+     * @brief Regista uma secção.
+     * @return Identificador usado em beginGpu()/endGpu() ou CpuScope.
+     */
+    int addSection(const std::string& name, bool gpu, glm::vec3 color) {
+        sections.emplace_back(new Section());
+        Section& section = *sections.back();
+        section.name = name;
+        section.gpu = gpu;
+        section.color = color;
+        if (gpu) glGenQueries(QUERY_LATENCY, section.queries);
+        return (int)sections.size() - 1;
+    }
+
+    /// Início do frame: recolhe os resultados de GPU que já chegaram.
+    void beginFrame() {
+        frameStart = std::chrono::steady_clock::now();
+        int slot = frame % QUERY_LATENCY;
+        for (size_t i = 0; i < sections.size(); i++) {
+            Section* section = sections[i].get();
+            if (!section->gpu || !section->issued[slot]) continue;
+            // O slot foi emitido há QUERY_LATENCY frames; se ainda não chegou, a amostra perde-se
+            GLint available = 0;
+            glGetQueryObjectiv(section->queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 nanos = 0;
+                glGetQueryObjectui64v(section->queries[slot], GL_QUERY_RESULT, &nanos);
+                section->history[(frame - QUERY_LATENCY + HISTORY) % HISTORY] = nanos / 1.0e6f;
+                int row = frame - QUERY_LATENCY - logFirstFrame;
+                if (logging && row >= 0) log[row * logColumns() + 1 + i] = nanos / 1.0e6f;
+            }
+            section->issued[slot] = false;
+        }
+    }
+
+    /// Fim do frame: fecha as secções de CPU e o tempo total do frame.
+    void endFrame() {
+        int index = frame % HISTORY;
+        for (auto& section : sections) {
+            if (!section->gpu) section->history[index] = section->cpuNanos.exchange(0) / 1.0e6f;
+        }
+        frameHistory[index] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        if (logging) {
+            // As colunas de GPU ficam NaN até a query do frame ser lida (QUERY_LATENCY frames depois)
+            log.push_back(frameHistory[index]);
+            for (auto& section : sections) {
+                log.push_back(section->gpu ? std::numeric_limits<float>::quiet_NaN() : section->history[index]);
+            }
+        }
+        frame++;
+    }
+
+    void beginGpu(int id) {
+        Section& section = *sections[id];
+        glBeginQuery(GL_TIME_ELAPSED, section.queries[frame % QUERY_LATENCY]);
+    }
+
+    void endGpu(int id) {
+        glEndQuery(GL_TIME_ELAPSED);
+        sections[id]->issued[frame % QUERY_LATENCY] = true;
+    }
+
+    /// Soma uma amostra de CPU à secção (seguro a partir de qualquer thread).
+    void addCpuTime(int id, uint64_t nanos) {
+        sections[id]->cpuNanos.fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    /**
+     * @class CpuScope
+     * @brief Mede o tempo de CPU do bloco em que é declarado.
+     */
+    class CpuScope {
+    public:
+        CpuScope(Profiler& profiler, int id) : profiler(profiler), id(id), start(std::chrono::steady_clock::now()) {}
+        ~CpuScope() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            profiler.addCpuTime(id, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+    private:
+        Profiler& profiler;
+        int id;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// Estatísticas de uma secção (as de GPU ignoram os frames cujas queries ainda não foram lidas).
+    Stats stats(int id) const { return computeStats(sections[id]->history, sections[id]->gpu ? QUERY_LATENCY : 0); }
+    Stats frameStats() const { return computeStats(frameHistory, 0); }
+
+    /// Escreve as estatísticas atuais na consola.
+    void printStats() const {
+        Stats frameTime = frameStats();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "[perfil] frame " << frameTime.min << " / " << frameTime.avg << " / " << frameTime.max << " ms";
+        for (size_t i = 0; i < sections.size(); i++) {
+            Stats s = stats((int)i);
+            std::cout << " | " << sections[i]->name << (sections[i]->gpu ? " (GPU) " : " (CPU) ")
+                      << s.min << " / " << s.avg << " / " << s.max;
+        }
+        std::cout << std::defaultfloat << std::endl;
+    }
+
+    /**
+     * @brief Escreve o histórico (frame mais antigo primeiro) em CSV: frame, frame_ms e uma coluna por secção.
+     */
+    bool writeCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        writeCsvHeader(out);
+        int count = std::min(frame, HISTORY);
+        for (int k = 0; k < count; k++) {
+            int f = frame - count + k;
+            int index = f % HISTORY;
+            out << f << "," << frameHistory[index];
+            for (const auto& section : sections) out << "," << section->history[index];
+            out << "\n";
+        }
+        return (bool)out;
+    }
+
+    /// Começa a guardar todos os frames a partir do próximo (apaga um registo anterior).
+    void startLog() {
+        logging = true;
+        log.clear();
+        logFirstFrame = frame;
+    }
+
+    /// Frames guardados desde startLog().
+    int loggedFrames() const { return (int)(log.size() / logColumns()); }
+
+    /**
+     * @brief Escreve todos os frames guardados desde startLog() em CSV (colunas como writeCsv()).
+     *
+     * Os últimos QUERY_LATENCY frames não têm tempos de GPU (as queries ainda não foram lidas)
+     * e as GPU que não chegaram a tempo também ficam vazias.
+     */
+    bool writeLogCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        writeCsvHeader(out);
+        size_t columns = logColumns();
+        for (int row = 0; row < loggedFrames(); row++) {
+            out << row;
+            for (size_t c = 0; c < columns; c++) {
+                float v = log[row * columns + c];
+                out << ",";
+                if (!std::isnan(v)) out << v;
+            }
+            out << "\n";
+        }
+        return (bool)out;
+    }
+
+    /**
+     * @brief Resumo dos frames guardados: mínimo, média, percentis 50/95/99 e máximo por coluna (ms).
+     */
+    void writeSummary(std::ostream& out) const {
+        size_t columns = logColumns();
+        out << std::fixed << std::setprecision(3);
+        out << "frames " << loggedFrames() << "\n";
+        out << std::left << std::setw(24) << "secao" << std::right
+            << std::setw(9) << "min" << std::setw(9) << "media" << std::setw(9) << "p50"
+            << std::setw(9) << "p95" << std::setw(9) << "p99" << std::setw(9) << "max" << std::setw(8) << "n" << "\n";
+        std::vector<float> values;
+        for (size_t c = 0; c < columns; c++) {
+            values.clear();
+            for (int row = 0; row < loggedFrames(); row++) {
+                float v = log[row * columns + c];
+                if (!std::isnan(v)) values.push_back(v);
+            }
+            std::string name = c == 0 ? "frame" : sections[c - 1]->name + (sections[c - 1]->gpu ? " (GPU)" : " (CPU)");
+            out << std::left << std::setw(24) << name << std::right;
+            if (values.empty()) {
+                out << "  sem amostras\n";
+                continue;
+            }
+            std::sort(values.begin(), values.end());
+            double sum = 0.0;
+            for (float v : values) sum += v;
+            auto percentile = [&](float p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+            out << std::setw(9) << values.front() << std::setw(9) << sum / values.size()
+                << std::setw(9) << percentile(0.5f) << std::setw(9) << percentile(0.95f) << std::setw(9) << percentile(0.99f)
+                << std::setw(9) << values.back() << std::setw(8) << values.size() << "\n";
+        }
+        out << std::defaultfloat;
+    }
+
+    /**
+     * @brief Desenha o HUD: uma barra por secção (média sólida, mínimo/máximo em faixa
+     * translúcida) e o gráfico dos tempos de frame, com a linha de referência de 16.7 ms.
+     *
+     * Usa o modo de cor sólida do overlay; deve ser chamado com blending ativo e depth test desligado.
+     */
+    void drawHud(OverlayRenderer& overlay, Shader& shader, float scrWidth, float scrHeight) const {
+        const float MARGIN = 16.0f, BAR_HEIGHT = 10.0f, BAR_GAP = 4.0f;
+        const float WIDTH = 360.0f, GRAPH_HEIGHT = 80.0f;
+        const float MS_RANGE = 33.3f;   // Largura total das barras e altura do gráfico
+        float pxPerMs = WIDTH / MS_RANGE;
+
+        float panelHeight = sections.size() * (BAR_HEIGHT + BAR_GAP) + GRAPH_HEIGHT + 3 * BAR_GAP;
+        overlay.renderRect(shader, MARGIN - 6, MARGIN - 6, WIDTH + 12, panelHeight + 12, scrWidth, scrHeight,
+                           glm::vec3(0.0f), 0.55f);
+
+        float y = MARGIN;
+        for (size_t i = 0; i < sections.size(); i++) {
+            Stats s = stats((int)i);
+            const glm::vec3& color = sections[i]->color;
+            overlay.renderRect(shader, MARGIN + s.min * pxPerMs, y, std::max(1.0f, (s.max - s.min) * pxPerMs), BAR_HEIGHT,
+                               scrWidth, scrHeight, color, 0.35f);
+            overlay.renderRect(shader, MARGIN, y + 2, std::min(WIDTH, s.avg * pxPerMs), BAR_HEIGHT - 4,
+                               scrWidth, scrHeight, color, 0.9f);
+            y += BAR_HEIGHT + BAR_GAP;
+        }
+
+        // Gráfico dos frames: uma coluna por frame, a vermelho acima de 16.7 ms
+        y += BAR_GAP;
+        float graphBottom = y + GRAPH_HEIGHT;
+        float columnWidth = WIDTH / HISTORY;
+        int count = std::min(frame, HISTORY);
+        for (int k = 0; k < count; k++) {
+            float ms = frameHistory[(frame - count + k) % HISTORY];
+            float h = std::min(GRAPH_HEIGHT, ms / MS_RANGE * GRAPH_HEIGHT);
+            glm::vec3 color = ms > 16.7f ? glm::vec3(1.0f, 0.25f, 0.2f) : glm::vec3(0.3f, 0.9f, 0.4f);
+            overlay.renderRect(shader, MARGIN + (HISTORY - count + k) * columnWidth, graphBottom - h, columnWidth, h,
+                               scrWidth, scrHeight, color, 0.85f);
+        }
+        float budgetY = graphBottom - 16.7f / MS_RANGE * GRAPH_HEIGHT;
+        overlay.renderRect(shader, MARGIN, budgetY, WIDTH, 1.0f, scrWidth, scrHeight, glm::vec3(1.0f), 0.6f);
+    }
+
+    const std::vector<std::unique_ptr<Section>>& getSections() const { return sections; }
+
+private:
+    std::vector<std::unique_ptr<Section>> sections;
+    float frameHistory[HISTORY] = {};
+    int frame = 0;
+    std::chrono::steady_clock::time_point frameStart;
+    bool logging = false;
+    int logFirstFrame = 0;      ///< Frame correspondente à primeira linha de log
+    std::vector<float> log;     ///< Uma linha por frame: frame_ms e uma coluna por secção
+
+    size_t logColumns() const { return 1 + sections.size(); }
+
+    void writeCsvHeader(std::ostream& out) const {
+        out << "frame,frame_ms";
+        for (const auto& section : sections) out << "," << section->name << (section->gpu ? "_gpu_ms" : "_cpu_ms");
+        out << "\n";
+    }
+
+    /// Estatísticas dos últimos frames, saltando os skip mais recentes.
+    Stats computeStats(const float* history, int skip) const {
+        Stats s;
+        int count = std::min(frame - skip, HISTORY - skip);
+        if (count <= 0) return s;
+        int newest = frame - 1 - skip;
+        s.min = history[newest % HISTORY];
+        s.max = s.min;
+        float sum = 0.0f;
+        for (int k = 0; k < count; k++) {
+            float v = history[(newest - k + HISTORY) % HISTORY];
+            s.min = std::min(s.min, v);
+            s.max = std::max(s.max, v);
+            sum += v;
+        }
+        s.avg = sum / count;
+        return s;
+    }
+};
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef PROP_RENDERER_H
+#define PROP_RENDERER_H
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shader_m.h>
+#include <Frustum.h>
+
+/**
+ * @class PropRenderer
+ * @brief Desenho instanciado de objetos repetidos (portões, marcadores, tochas, decoração).
+ *
+ * Cada tipo de objeto tem uma malha partilhada (VAO próprio, com índices ou não) e uma lista
+ * de instâncias com transformação e material. Em draw(), as instâncias cuja caixa está dentro
+ * do frustum são copiadas, agrupadas por malha, para um único buffer de instâncias, e cada
+ * malha com instâncias visíveis custa um glDrawArraysInstanced/glDrawElementsInstanced: o
+ * número de draw calls depende dos tipos de objeto, não do número de objetos.
+ *
+ * O buffer de instâncias alimenta o atributo 3 (material, o mesmo dos vértices do labirinto) e
+ * os atributos 4-7 (matriz model), todos com divisor 1; o vertex shader usa a matriz da
+ * instância quando o uniform "instanced" está ligado. Sem baseInstance no GL 3.3, os
+ * ponteiros destes atributos são reapontados para o troço de cada malha antes do seu draw.
+ */
+class PropRenderer {
+public:
+    static const int VERTEX_FLOATS = 8;     ///< Floats por vértice das malhas (Posição 3, Normal 3, TexCoords 2)
+
+    PropRenderer() {
+        glGenBuffers(1, &instanceVBO);
+    }
+
+    PropRenderer(const PropRenderer&) = delete;
+    PropRenderer& operator=(const PropRenderer&) = delete;
+
+    ~PropRenderer() {
+        for (Mesh& mesh : meshes) {
+            glDeleteVertexArrays(1, &mesh.VAO);
+            glDeleteBuffers(1, &mesh.VBO);
+            glDeleteBuffers(1, &mesh.EBO);
+        }
+        glDeleteBuffers(1, &instanceVBO);
+    }
+
+    /**
+     * @brief Regista uma malha partilhada.
+     * @param vertices Vértices intercalados (VERTEX_FLOATS por vértice).
+     * @param indices Triângulos indexados; vazio para desenhar os vértices por ordem.
+     * @return Identificador do tipo de objeto, a passar a add().
+     */
+    int addMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices = std::vector<unsigned int>()) {
+        Mesh mesh;
+        mesh.count = (GLsizei)(indices.empty() ? vertices.size() / VERTEX_FLOATS : indices.size());
+        mesh.indexed = !indices.empty();
+        mesh.minBounds = glm::vec3(std::numeric_limits<float>::max());
+        mesh.maxBounds = glm::vec3(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i + VERTEX_FLOATS <= vertices.size(); i += VERTEX_FLOATS) {
+            glm::vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+            mesh.minBounds = glm::min(mesh.minBounds, p);
+            mesh.maxBounds = glm::max(mesh.maxBounds, p);
+        }
+
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        glBindVertexArray(mesh.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(6 * sizeof(float)));
+        for (GLuint attribute = 0; attribute < 3; attribute++) glEnableVertexAttribArray(attribute);
+        if (mesh.indexed) {
+            glGenBuffers(1, &mesh.EBO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        }
+
+        // Material e matriz por instância (os ponteiros são fixados em draw())
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (GLuint attribute = MATERIAL_ATTRIBUTE; attribute < MODEL_ATTRIBUTE + 4; attribute++) {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindVertexArray(0);
+
+        meshes.push_back(mesh);
+        return (int)meshes.size() - 1;
+    }
+
+    /// Cubo unitário centrado na origem (36 vértices, sem índices).
+    int addCube() {
+        static const float sides[6][3] = { { 0, 0, -1 }, { 0, 0, 1 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 } };
+        static const float corners[6][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { 1, 1 }, { -1, 1 }, { -1, -1 } };
+        std::vector<float> vertices;
+        for (const float* n : sides) {
+            // Eixos u, v da face: os dois que não são o da normal
+            int axis = n[0] != 0 ? 0 : (n[1] != 0 ? 1 : 2);
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            if (n[axis] < 0) std::swap(u, v);   // Sentido anti-horário visto de fora
+            for (const float* c : corners) {
+                float p[3];
+                p[axis] = 0.5f * n[axis];
+                p[u] = 0.5f * c[0];
+                p[v] = 0.5f * c[1];
+                vertices.insert(vertices.end(), { p[0], p[1], p[2], n[0], n[1], n[2], 0.5f + 0.5f * c[0], 0.5f + 0.5f * c[1] });
+            }
+        }
+        return addMesh(vertices);
+    }
+
+    /**
+     * @brief Acrescenta uma instância de uma malha.
+     * @param material Camada da array de texturas (Maze::Material ou uma camada do MTL).
+     * @return Índice da instância dentro da malha (para setTransform()).
+     */
+    size_t add(int mesh, const glm::mat4& model, float material) {
+        std::vector<Instance>& instances = meshes[mesh].instances;
+        instances.push_back(Instance());
+        instances.back().data.material = material;
+        setTransform(mesh, instances.size() - 1, model);
+        return instances.size() - 1;
+    }
+
+    void setTransform(int mesh, size_t instance, const glm::mat4& model) {
+        Instance& inst = meshes[mesh].instances[instance];
+        inst.data.model = model;
+
+        // Caixa no mundo: os 8 cantos da caixa da malha transformados
+        const Mesh& m = meshes[mesh];
+        inst.minBounds = glm::vec3(std::numeric_limits<float>::max());
+        inst.maxBounds = glm::vec3(std::numeric_limits<float>::lowest());
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 local((corner & 1) ? m.maxBounds.x : m.minBounds.x,
+                            (corner & 2) ? m.maxBounds.y : m.minBounds.y,
+                            (corner & 4) ? m.maxBounds.z : m.minBounds.z);
+            glm::vec3 world = glm::vec3(model * glm::vec4(local, 1.0f));
+            inst.minBounds = glm::min(inst.minBounds, world);
+            inst.maxBounds = glm::max(inst.maxBounds, world);
+        }
+    }
+
+    /// Remove todas as instâncias de uma malha (por exemplo marcadores refeitos a cada caminho).
+    void clear(int mesh) { meshes[mesh].instances.clear(); }
+
+    size_t instanceCount(int mesh) const { return meshes[mesh].instances.size(); }
+
+    /**
+     * @brief Desenha as instâncias dentro do frustum, uma draw call por malha com instâncias visíveis.
+     *
+     * Usa o programa ativo (o de iluminação do labirinto); os vértices das malhas são floats,
+     * pelo que a desquantização é posta na identidade.
+     */
+    void draw(Shader& shader, const Frustum& frustum) {
+        visibleInstances = 0;
+        drawCalls = 0;
+        staging.clear();
+        for (Mesh& mesh : meshes) {
+            mesh.first = staging.size();
+            for (const Instance& inst : mesh.instances) {
+                if (frustum.intersectsAABB(inst.minBounds, inst.maxBounds)) staging.push_back(inst.data);
+            }
+            mesh.visible = staging.size() - mesh.first;
+        }
+        visibleInstances = (unsigned int)staging.size();
+        if (staging.empty()) return;
+
+        // Buffer órfão a cada frame (o driver não espera pelos draws do frame anterior)
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        size_t bytes = staging.size() * sizeof(InstanceData);
+        if (bytes > capacity) capacity = std::max(bytes, capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, staging.data());
+
+        if (uniforms.program != shader.ID) {
+            uniforms.program = shader.ID;
+            uniforms.instanced = shader.getUniformLocation("instanced");
+            uniforms.posOffset = shader.getUniformLocation("posOffset");
+            uniforms.posScale = shader.getUniformLocation("posScale");
+            uniforms.uvOffset = shader.getUniformLocation("uvOffset");
+            uniforms.uvScale = shader.getUniformLocation("uvScale");
+        }
+        shader.setBool(uniforms.instanced, true);
+        shader.setVec3(uniforms.posOffset, glm::vec3(0.0f));
+        shader.setVec3(uniforms.posScale, glm::vec3(1.0f));
+        shader.setVec2(uniforms.uvOffset, glm::vec2(0.0f));
+        shader.setVec2(uniforms.uvScale, glm::vec2(1.0f));
+
+        for (Mesh& mesh : meshes) {
+            if (mesh.visible == 0) continue;
+            glBindVertexArray(mesh.VAO);
+            size_t base = mesh.first * sizeof(InstanceData);
+            glVertexAttribPointer(MATERIAL_ATTRIBUTE, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                  (void*)(base + offsetof(InstanceData, material)));
+            for (GLuint column = 0; column < 4; column++) {
+                glVertexAttribPointer(MODEL_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                      (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+            }
+            if (mesh.indexed) {
+                glDrawElementsInstanced(GL_TRIANGLES, mesh.count, GL_UNSIGNED_INT, 0, (GLsizei)mesh.visible);
+            } else {
+                glDrawArraysInstanced(GL_TRIANGLES, 0, mesh.count, (GLsizei)mesh.visible);
+            }
+            drawCalls++;
+        }
+        glBindVertexArray(0);
+        shader.setBool(uniforms.instanced, false);
+    }
+
+    unsigned int visibleInstances = 0;  ///< Instâncias desenhadas no último draw()
+    unsigned int drawCalls = 0;         ///< Draw calls do último draw()
+
+private:
+    static const GLuint MATERIAL_ATTRIBUTE = 3;     ///< aMaterial no vertex shader
+    static const GLuint MODEL_ATTRIBUTE = 4;        ///< Primeira coluna de aInstanceModel
+
+    /// Dados de uma instância tal como ficam no buffer.
+    struct InstanceData {
+        glm::mat4 model;
+        float material = 0.0f;
+    };
+
+    struct Instance {
+        InstanceData data;
+        glm::vec3 minBounds, maxBounds;     ///< Caixa no mundo (para o frustum)
+    };
+
+    struct Mesh {
+        GLuint VAO = 0, VBO = 0, EBO = 0;
+        GLsizei count = 0;                  ///< Índices (indexed) ou vértices a desenhar
+        bool indexed = false;
+        glm::vec3 minBounds, maxBounds;     ///< Caixa da malha (espaço local)
+        std::vector<Instance> instances;
+        size_t first = 0, visible = 0;      ///< Troço da malha no buffer de instâncias do último draw()
+    };
+
+    /// Localizações dos uniformes, resolvidas uma vez por programa.
+    struct Uniforms {
+        GLuint program = 0;
+        GLint instanced = -1, posOffset = -1, posScale = -1, uvOffset = -1, uvScale = -1;
+    };
+
+    std::vector<Mesh> meshes;
+    std::vector<InstanceData> staging;
+    GLuint instanceVBO = 0;
+    size_t capacity = 0;
+    Uniforms uniforms;
+};
+
+#endif
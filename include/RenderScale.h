@@ -0,0 +1,200 @@
+#ifndef RENDER_SCALE_H
+#define RENDER_SCALE_H
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+/**
+ * @class RenderScale
+ * @brief Resolução dinâmica: as passagens 3D são desenhadas num framebuffer fora do ecrã, a uma
+ * fração da resolução da janela, e ampliadas para o ecrã antes dos overlays.
+ *
+ * O framebuffer é alocado uma vez à resolução da janela e cada frame usa só o canto inferior
+ * esquerdo (width() x height()), pelo que mudar de escala não realoca nada. O tempo de GPU das
+ * passagens 3D é medido com um par de GL_TIMESTAMP por frame (não interferem com as queries
+ * GL_TIME_ELAPSED do Profiler), lido com QUERY_LATENCY frames de atraso e suavizado por média
+ * móvel.
+ *
+ * Com dynamic ligado, a escala procura manter esse tempo abaixo de BUDGET do alvo: o custo é
+ * tratado como proporcional ao número de píxeis (escala²), pelo que desce de uma vez para a
+ * escala prevista quando o alvo é ultrapassado e sobe um STEP de cada vez só quando a previsão
+ * para o passo seguinte ainda fica abaixo de HEADROOM do alvo. Entre mudanças há COOLDOWN frames
+ * para que as medições reflitam a escala nova. Com a escala fixa em 1, o framebuffer é
+ * contornado e desenha-se diretamente no ecrã.
+ */
+class RenderScale {
+public:
+    static constexpr float MIN_SCALE = 0.5f;    ///< Escala mínima por eixo
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float STEP = 0.05f;        ///< As escalas são múltiplos de STEP
+    static constexpr float BUDGET = 0.85f;      ///< Fração do tempo de frame reservada às passagens 3D
+    static constexpr float HEADROOM = 0.8f;     ///< Margem da previsão exigida para subir a escala
+    static constexpr float SMOOTHING = 0.1f;    ///< Peso de cada amostra na média móvel
+    static const int COOLDOWN = 30;             ///< Frames entre duas mudanças de escala
+    static const int QUERY_LATENCY = 4;         ///< Frames de atraso aceites na leitura dos timestamps
+
+    RenderScale() {
+        for (int i = 0; i < QUERY_LATENCY; i++) glGenQueries(2, queries[i]);
+    }
+
+    RenderScale(const RenderScale&) = delete;
+    RenderScale& operator=(const RenderScale&) = delete;
+
+    ~RenderScale() {
+        for (int i = 0; i < QUERY_LATENCY; i++) glDeleteQueries(2, queries[i]);
+        release();
+    }
+
+    /**
+     * @brief Tempo de frame pretendido (ms); as passagens 3D ficam com BUDGET dele.
+     */
+    void setTarget(float frameMs) { targetMs = frameMs * BUDGET; }
+    float target() const { return targetMs; }   ///< Orçamento das passagens 3D (ms)
+
+    /// Liga/desliga a adaptação; desligada, a escala atual fica fixa.
+    void setDynamic(bool enabled) {
+        dynamic = enabled;
+        cooldown = COOLDOWN;
+    }
+    bool isDynamic() const { return dynamic; }
+
+    /// Fixa a escala (arredondada a STEP e limitada a [MIN_SCALE, MAX_SCALE]).
+    void setScale(float value) { current = quantize(value); }
+    float scale() const { return current; }
+
+    /**
+     * @brief Início das passagens 3D: liga o framebuffer (ou o ecrã) e o viewport da resolução de render.
+     * @param windowWidth, windowHeight Tamanho atual do framebuffer da janela.
+     */
+    void begin(int windowWidth, int windowHeight) {
+        collectTimings();
+        if (windowWidth != allocatedWidth || windowHeight != allocatedHeight) allocate(windowWidth, windowHeight);
+        windowW = windowWidth;
+        windowH = windowHeight;
+        offscreen = complete && (dynamic || current < MAX_SCALE);
+        renderW = offscreen ? std::max(1, (int)std::lround(windowWidth * current)) : windowWidth;
+        renderH = offscreen ? std::max(1, (int)std::lround(windowHeight * current)) : windowHeight;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, offscreen ? FBO : 0);
+        glViewport(0, 0, renderW, renderH);
+        glQueryCounter(queries[frame % QUERY_LATENCY][0], GL_TIMESTAMP);
+    }
+
+    /**
+     * @brief Fim das passagens 3D: amplia a imagem para o ecrã (filtro bilinear) e repõe o viewport da janela.
+     */
+    void resolve() {
+        int slot = frame % QUERY_LATENCY;
+        glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+        issued[slot] = true;
+        frame++;
+
+        if (offscreen) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, renderW, renderH, 0, 0, windowW, windowH, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+        glViewport(0, 0, windowW, windowH);
+    }
+
+    int width() const { return renderW; }       ///< Largura de render do frame atual
+    int height() const { return renderH; }      ///< Altura de render do frame atual
+    float gpuMs() const { return smoothedMs; }  ///< Tempo de GPU suavizado das passagens 3D
+
+    unsigned int scaleChanges = 0;              ///< Mudanças de escala feitas pela adaptação
+
+private:
+    unsigned int FBO = 0, colorBuffer = 0, depthBuffer = 0;
+    int allocatedWidth = 0, allocatedHeight = 0;
+    bool complete = false;
+    bool offscreen = false;
+    int windowW = 0, windowH = 0, renderW = 0, renderH = 0;
+
+    float current = MAX_SCALE;
+    bool dynamic = true;
+    float targetMs = 1000.0f / 60.0f * BUDGET;
+    float smoothedMs = 0.0f;
+    bool hasSample = false;
+    int cooldown = COOLDOWN;
+
+    GLuint queries[QUERY_LATENCY][2] = {};
+    bool issued[QUERY_LATENCY] = {};
+    int frame = 0;
+
+    static float quantize(float value) {
+        float clamped = std::min(MAX_SCALE, std::max(MIN_SCALE, value));
+        return std::min(MAX_SCALE, std::max(MIN_SCALE, std::floor(clamped / STEP + 1e-3f) * STEP));
+    }
+
+    void allocate(int width, int height) {
+        release();
+        allocatedWidth = width;
+        allocatedHeight = height;
+        if (width <= 0 || height <= 0) return;     // Janela minimizada
+
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) std::cout << "Aviso: framebuffer de render incompleto; resolucao dinamica desligada" << std::endl;
+    }
+
+    void release() {
+        if (FBO) glDeleteFramebuffers(1, &FBO);
+        if (colorBuffer) glDeleteRenderbuffers(1, &colorBuffer);
+        if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+        FBO = colorBuffer = depthBuffer = 0;
+        complete = false;
+    }
+
+    /// Lê o par de timestamps emitido há QUERY_LATENCY frames e adapta a escala.
+    void collectTimings() {
+        int slot = frame % QUERY_LATENCY;
+        if (!issued[slot]) return;
+        issued[slot] = false;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;     // Amostra perdida; nunca bloquear à espera da GPU
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+        float ms = end > start ? (end - start) / 1.0e6f : 0.0f;
+        smoothedMs = hasSample ? smoothedMs + SMOOTHING * (ms - smoothedMs) : ms;
+        hasSample = true;
+        adapt();
+    }
+
+    void adapt() {
+        if (!dynamic || !complete || cooldown-- > 0 || smoothedMs <= 0.0f) return;
+        float next = current;
+        if (smoothedMs > targetMs) {
+            next = quantize(current * std::sqrt(targetMs / smoothedMs));
+        } else if (current < MAX_SCALE) {
+            float up = quantize(current + STEP);
+            float predicted = smoothedMs * (up * up) / (current * current);
+            if (predicted < targetMs * HEADROOM) next = up;
+        }
+        if (next == current) return;
+        // Os próximos QUERY_LATENCY frames ainda foram medidos à escala antiga
+        smoothedMs *= (next * next) / (current * current);
+        current = next;
+        cooldown = COOLDOWN;
+        scaleChanges++;
+    }
+};
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <shader_m.h>
+#include <TextureLoader.h>
+#include <MazeCache.h>
+
+// GL_ARB_get_program_binary (núcleo só no 4.1; o glad do projeto é 3.3 sem extensões)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+/**
+ * @class ResourceManager
+ * @brief Cache partilhada de texturas e programas de shaders, com recarregamento quando os ficheiros mudam.
+ *
+ * Texturas e shaders são identificados pelos caminhos (e, nas texturas, pelas opções): pedir
+ * duas vezes o mesmo recurso devolve o mesmo objeto OpenGL. O gestor é dono de tudo o que
+ * criou e apaga-o em releaseAll() (ou no destrutor), que deve correr com o contexto ainda ativo
+ * e antes de o TextureLoader ser destruído.
+ *
+ * Com enableProgramBinaries(), cada programa ligado é guardado com glGetProgramBinary num
+ * ficheiro .program ao lado do vertex shader; o cabeçalho guarda um hash FNV-1a do código dos
+ * shaders e do driver (fabricante, renderer e versão), pelo que a cache é ignorada e refeita
+ * quando algum muda. Se o driver recusar o binário, o programa é compilado normalmente.
+ *
+ * pollChanges() compara, de WATCH_INTERVAL em WATCH_INTERVAL segundos, o tamanho e a data de
+ * modificação dos ficheiros de origem (sem depender de APIs de notificação do sistema). Um
+ * shader alterado é recompilado e, se ligar sem erros, substitui o programa no mesmo Shader
+ * (as referências continuam válidas) e volta a correr a função de configuração dada em
+ * shader(); se falhar, fica o programa anterior. Uma textura alterada é enviada de novo para a
+ * mesma textura pelo TextureLoader. Só os PNG listados são vigiados, não as versões .ktx2/.dds.
+ */
+class ResourceManager {
+public:
+    static constexpr uint32_t BINARY_MAGIC = 0x42505A4D;    ///< "MZPB" em little-endian
+    static constexpr uint32_t BINARY_VERSION = 1;           ///< Incrementar sempre que o cabeçalho muda
+    static constexpr double WATCH_INTERVAL = 0.5;           ///< Segundos entre verificações dos ficheiros
+
+    /// Configuração de um programa depois de cada ligação (blocos de uniformes, samplers, constantes).
+    typedef std::function<void(Shader&)> ShaderSetup;
+
+    explicit ResourceManager(TextureLoader& loader) : loader(loader) {}
+
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    ~ResourceManager() { releaseAll(); }
+
+    /**
+     * @brief Liga a cache de program binaries, se o contexto a suportar.
+     * @param load Função de carregamento de funções OpenGL (a mesma dada ao glad).
+     * @return false se GL_ARB_get_program_binary não existir ou não houver formatos binários.
+     */
+    bool enableProgramBinaries(GLADloadproc load) {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major * 10 + minor < 41 && !hasExtension("GL_ARB_get_program_binary")) return false;
+        getProgramBinary = (GetProgramBinaryProc)load("glGetProgramBinary");
+        programBinary = (ProgramBinaryProc)load("glProgramBinary");
+        programParameteri = (ProgramParameteriProc)load("glProgramParameteri");
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binariesEnabled = getProgramBinary && programBinary && programParameteri && formats > 0;
+
+        // Um binário só é válido para o driver que o gerou
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* value = (const char*)glGetString(name);
+            if (value) driverId += std::string(value) + "\n";
+        }
+        return binariesEnabled;
+    }
+
+    /// Textura 2D (ver TextureLoader::load2D), partilhada por caminho e opções.
+    GLuint texture2D(const std::string& path, const TextureOptions& options = TextureOptions()) {
+        return texture(TEXTURE_2D, { path }, options);
+    }
+
+    /// Array de texturas 2D (ver TextureLoader::loadArray), partilhada pela lista de camadas e opções.
+    GLuint textureArray(const std::vector<std::string>& layers, const TextureOptions& options = TextureOptions()) {
+        return texture(TEXTURE_ARRAY, layers, options);
+    }
+
+    /// Cubemap (ver TextureLoader::loadCubemap), partilhado pela lista de faces.
+    GLuint cubemap(const std::vector<std::string>& faces) {
+        return texture(TEXTURE_CUBEMAP, faces, TextureOptions());
+    }
+
+    /**
+     * @brief Programa de vertexPath + fragmentPath, partilhado por caminho.
+     * @param setup Corre depois de cada ligação, incluindo as de recarregamento (só conta o da primeira chamada).
+     * @return Referência válida até releaseAll().
+     */
+    Shader& shader(const std::string& vertexPath, const std::string& fragmentPath, ShaderSetup setup = nullptr) {
+        std::string key = vertexPath + "\n" + fragmentPath;
+        auto it = shaderIndex.find(key);
+        if (it != shaderIndex.end()) {
+            shaderHits++;
+            return *shaders[it->second].shader;
+        }
+
+        ShaderEntry entry;
+        entry.vertexPath = vertexPath;
+        entry.fragmentPath = fragmentPath;
+        entry.setup = setup;
+        entry.files = watch({ vertexPath, fragmentPath });
+        bool linked = false;
+        entry.shader.reset(new Shader(buildProgram(entry, linked)));
+        if (entry.setup) entry.setup(*entry.shader);
+        shaderIndex[key] = shaders.size();
+        shaders.push_back(std::move(entry));
+        return *shaders.back().shader;
+    }
+
+    /**
+     * @brief Recarrega os recursos cujos ficheiros mudaram (chamar uma vez por frame, na thread do contexto).
+     * @return Número de recursos alterados encontrados nesta chamada (incluindo shaders que não ligaram).
+     */
+    int pollChanges() {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastPoll).count() < WATCH_INTERVAL) return 0;
+        lastPoll = now;
+
+        int count = 0;
+        for (ShaderEntry& entry : shaders) {
+            if (!changed(entry.files)) continue;
+            count++;
+            bool linked = false;
+            GLuint program = buildProgram(entry, linked);
+            if (!linked) {
+                glDeleteProgram(program);
+                std::cout << "Shader " << entry.vertexPath << " / " << entry.fragmentPath
+                          << " com erros: mantido o programa anterior" << std::endl;
+                continue;
+            }
+            entry.shader->adopt(program);
+            if (entry.setup) entry.setup(*entry.shader);
+            reloads++;
+            std::cout << "Shader recarregado: " << entry.vertexPath << " / " << entry.fragmentPath << std::endl;
+        }
+        for (TextureEntry& entry : textures) {
+            if (!changed(entry.files)) continue;
+            count++;
+            load(entry);
+            reloads++;
+            std::cout << "Textura a recarregar: " << entry.paths[0] << (entry.paths.size() > 1 ? " (...)" : "") << std::endl;
+        }
+        return count;
+    }
+
+    /// Apaga todas as texturas e programas criados (as referências devolvidas deixam de ser válidas).
+    void releaseAll() {
+        for (TextureEntry& entry : textures) glDeleteTextures(1, &entry.texture);
+        for (ShaderEntry& entry : shaders) {
+            glDeleteProgram(entry.shader->ID);
+            entry.shader->ID = 0;
+        }
+        textures.clear();
+        textureIndex.clear();
+        shaders.clear();
+        shaderIndex.clear();
+    }
+
+    size_t textureCount() const { return textures.size(); }
+    size_t shaderCount() const { return shaders.size(); }
+
+    unsigned int textureHits = 0;       ///< Pedidos de textura servidos pela cache
+    unsigned int shaderHits = 0;        ///< Pedidos de programa servidos pela cache
+    unsigned int binaryLoads = 0;       ///< Programas carregados de um program binary
+    unsigned int binaryStores = 0;      ///< Program binaries escritos
+    unsigned int reloads = 0;           ///< Recursos recarregados por pollChanges()
+
+private:
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint, GLenum, GLint);
+
+    enum TextureKind { TEXTURE_2D, TEXTURE_ARRAY, TEXTURE_CUBEMAP };
+
+    /// Ficheiro vigiado e o estado em que foi lido.
+    struct WatchedFile {
+        std::string path;
+        MazeCache::SourceStamp stamp;
+    };
+
+    struct TextureEntry {
+        TextureKind kind = TEXTURE_2D;
+        std::vector<std::string> paths;
+        TextureOptions options;
+        GLuint texture = 0;
+        std::vector<WatchedFile> files;
+    };
+
+    struct ShaderEntry {
+        std::string vertexPath, fragmentPath;
+        std::unique_ptr<Shader> shader;     ///< Endereço estável: as referências sobrevivem aos recarregamentos
+        ShaderSetup setup;
+        std::vector<WatchedFile> files;
+    };
+
+    TextureLoader& loader;
+    std::vector<TextureEntry> textures;
+    std::unordered_map<std::string, size_t> textureIndex;     ///< Chave (caminhos e opções) -> textures
+    std::vector<ShaderEntry> shaders;
+    std::unordered_map<std::string, size_t> shaderIndex;      ///< Caminhos -> shaders
+    std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+
+    bool binariesEnabled = false;
+    std::string driverId;
+    GetProgramBinaryProc getProgramBinary = nullptr;
+    ProgramBinaryProc programBinary = nullptr;
+    ProgramParameteriProc programParameteri = nullptr;
+
+    GLuint texture(TextureKind kind, const std::vector<std::string>& paths, const TextureOptions& options) {
+        std::ostringstream key;
+        key << kind << "|" << options.repeat << options.mipmaps << options.flip << "|" << options.placeholder.x << ","
+            << options.placeholder.y << "," << options.placeholder.z << "," << options.placeholder.w;
+        for (const std::string& path : paths) key << "|" << path;
+        auto it = textureIndex.find(key.str());
+        if (it != textureIndex.end()) {
+            textureHits++;
+            return textures[it->second].texture;
+        }
+
+        TextureEntry entry;
+        entry.kind = kind;
+        entry.paths = paths;
+        entry.options = options;
+        entry.files = watch(paths);
+        load(entry);
+        textureIndex[key.str()] = textures.size();
+        textures.push_back(std::move(entry));
+        return textures.back().texture;
+    }
+
+    /// Agenda o carregamento (ou recarregamento, se a textura já existir) no TextureLoader.
+    void load(TextureEntry& entry) {
+        switch (entry.kind) {
+            case TEXTURE_2D: entry.texture = loader.load2D(entry.paths[0], entry.options, entry.texture); break;
+            case TEXTURE_ARRAY: entry.texture = loader.loadArray(entry.paths, entry.options, entry.texture); break;
+            case TEXTURE_CUBEMAP: entry.texture = loader.loadCubemap(entry.paths, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), entry.texture); break;
+        }
+    }
+
+    static std::vector<WatchedFile> watch(const std::vector<std::string>& paths) {
+        std::vector<WatchedFile> files(paths.size());
+        for (size_t i = 0; i < paths.size(); i++) {
+            files[i].path = paths[i];
+            MazeCache::statSource(paths[i], files[i].stamp);
+        }
+        return files;
+    }
+
+    /// Atualiza o estado guardado; true se algum ficheiro mudou (um ficheiro que desapareceu não conta).
+    static bool changed(std::vector<WatchedFile>& files) {
+        bool any = false;
+        for (WatchedFile& file : files) {
+            MazeCache::SourceStamp stamp;
+            if (!MazeCache::statSource(file.path, stamp)) continue;
+            if (stamp.size == file.stamp.size && stamp.mtime == file.stamp.mtime) continue;
+            file.stamp = stamp;
+            any = true;
+        }
+        return any;
+    }
+
+    static bool hasExtension(const char* extension) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (name && std::strcmp(name, extension) == 0) return true;
+        }
+        return false;
+    }
+
+    /// Ficheiro do program binary: ao lado do vertex shader, com os nomes dos dois shaders sem extensão.
+    static std::string binaryPath(const ShaderEntry& entry) {
+        auto stem = [](const std::string& path) {
+            size_t slash = path.find_last_of("/\\");
+            std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+            size_t dot = name.find_last_of('.');
+            return dot == std::string::npos ? name : name.substr(0, dot);
+        };
+        size_t slash = entry.vertexPath.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? std::string() : entry.vertexPath.substr(0, slash + 1);
+        std::string vertex = stem(entry.vertexPath), fragment = stem(entry.fragmentPath);
+        return directory + vertex + (fragment == vertex ? std::string() : "_" + fragment) + ".program";
+    }
+
+    static uint64_t fnv1a(const std::string& data, uint64_t h = 1469598103934665603ull) {
+        for (unsigned char c : data) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    /**
+     * @brief Liga o programa de um ShaderEntry: do program binary se for válido, senão dos ficheiros.
+     * @param linked true se o programa devolvido ligou sem erros.
+     */
+    GLuint buildProgram(const ShaderEntry& entry, bool& linked) {
+        std::string vertexCode, fragmentCode;
+        if (!Shader::readSource(entry.vertexPath.c_str(), vertexCode) ||
+            !Shader::readSource(entry.fragmentPath.c_str(), fragmentCode)) {
+            std::cout << "ERRO::SHADER::FICHEIRO_NAO_LIDO_COM_SUCESSO" << std::endl;
+        }
+        uint64_t hash = fnv1a(fragmentCode, fnv1a(vertexCode, fnv1a(driverId)));
+        std::string path = binaryPath(entry);
+
+        if (binariesEnabled) {
+            GLuint program = loadBinary(path, hash);
+            if (program) {
+                binaryLoads++;
+                linked = true;
+                return program;
+            }
+        }
+        // Os binários só podem ser lidos depois da ligação se o pedido for feito antes dela
+        std::function<void(GLuint)> requestRetrievable;
+        if (binariesEnabled) {
+            requestRetrievable = [this](GLuint program) { programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); };
+        }
+        GLuint program = Shader::buildProgram(vertexCode.c_str(), fragmentCode.c_str(), nullptr, &linked, requestRetrievable);
+        if (linked && binariesEnabled && storeBinary(program, path, hash)) binaryStores++;
+        return program;
+    }
+
+    /// @return Programa ligado a partir do ficheiro, ou 0 se não existir, for de outro código/driver ou o driver o recusar.
+    GLuint loadBinary(const std::string& path, uint64_t hash) {
+        std::ifstream in(path, std::ios::binary);
+        uint32_t magic = 0, version = 0, format = 0, length = 0;
+        uint64_t storedHash = 0;
+        in.read((char*)&magic, sizeof(magic));
+        in.read((char*)&version, sizeof(version));
+        in.read((char*)&storedHash, sizeof(storedHash));
+        in.read((char*)&format, sizeof(format));
+        in.read((char*)&length, sizeof(length));
+        if (!in || magic != BINARY_MAGIC || version != BINARY_VERSION || storedHash != hash || length == 0) return 0;
+        std::vector<char> data(length);
+        in.read(data.data(), length);
+        if (!in) return 0;
+
+        GLuint program = glCreateProgram();
+        programBinary(program, (GLenum)format, data.data(), (GLsizei)length);
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            std::cout << "Program binary " << path << " recusado pelo driver: a compilar" << std::endl;
+            return 0;
+        }
+        return program;
+    }
+
+    bool storeBinary(GLuint program, const std::string& path, uint64_t hash) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return false;
+        std::vector<char> data(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        getProgramBinary(program, length, &written, &format, data.data());
+        if (written <= 0) return false;
+
+        // Escrever para um temporário e renomear: um ficheiro a meio nunca é lido como válido
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            uint32_t format32 = (uint32_t)format, length32 = (uint32_t)written;
+            out.write((const char*)&BINARY_MAGIC, sizeof(BINARY_MAGIC));
+            out.write((const char*)&BINARY_VERSION, sizeof(BINARY_VERSION));
+            out.write((const char*)&hash, sizeof(hash));
+            out.write((const char*)&format32, sizeof(format32));
+            out.write((const char*)&length32, sizeof(length32));
+            out.write(data.data(), written);
+            if (!out) {
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAZE_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MAZE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @namespace simd
+ * @brief Abstração mínima de 4 floats por registo (SSE2 em x86-64, NEON em ARM, escalar nos restantes).
+ *
+ * Só inclui as operações usadas pelos testes de colisão. As comparações devolvem máscaras
+ * (Mask4) que se combinam com & e | e se convertem num inteiro de 4 bits com bits(),
+ * um bit por lane. Comparações com NaN são sempre falsas, como em escalar.
+ */
+namespace simd {
+
+#if defined(MAZE_SIMD_SSE2)
+
+struct float4 { __m128 v; };
+struct Mask4 { __m128 v; };
+
+inline float4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+inline float4 set1(float x) { return {_mm_set1_ps(x)}; }
+inline void store(float* p, float4 a) { _mm_storeu_ps(p, a.v); }
+
+inline float4 operator+(float4 a, float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline float4 operator-(float4 a, float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline float4 operator*(float4 a, float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline float4 abs(float4 a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+
+inline Mask4 operator>=(float4 a, float4 b) { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline Mask4 operator<=(float4 a, float4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return {_mm_and_ps(a.v, b.v)}; }
+inline int bits(Mask4 m) { return _mm_movemask_ps(m.v); }
+
+#elif defined(MAZE_SIMD_NEON)
+
+struct float4 { float32x4_t v; };
+struct Mask4 { uint32x4_t v; };
+
+inline float4 load(const float* p) { return {vld1q_f32(p)}; }
+inline float4 set1(float x) { return {vdupq_n_f32(x)}; }
+inline void store(float* p, float4 a) { vst1q_f32(p, a.v); }
+
+inline float4 operator+(float4 a, float4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline float4 operator-(float4 a, float4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline float4 operator*(float4 a, float4 b) { return {vmulq_f32(a.v, b.v)}; }
+inline float4 abs(float4 a) { return {vabsq_f32(a.v)}; }
+
+inline Mask4 operator>=(float4 a, float4 b) { return {vcgeq_f32(a.v, b.v)}; }
+inline Mask4 operator<=(float4 a, float4 b) { return {vcleq_f32(a.v, b.v)}; }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return {vandq_u32(a.v, b.v)}; }
+inline int bits(Mask4 m) {
+    static const int32_t shifts[4] = {0, 1, 2, 3};
+    uint32x4_t lanes = vshlq_u32(vshrq_n_u32(m.v, 31), vld1q_s32(shifts));
+#if defined(__aarch64__)
+    return (int)vaddvq_u32(lanes);
+#else
+    // ARMv7 não tem a soma horizontal: duas somas aos pares
+    uint32x2_t pairs = vpadd_u32(vget_low_u32(lanes), vget_high_u32(lanes));
+    return (int)vget_lane_u32(vpadd_u32(pairs, pairs), 0);
+#endif
+}
+
+#else
+
+struct float4 { float v[4]; };
+struct Mask4 { bool v[4]; };
+
+inline float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline float4 set1(float x) { return {{x, x, x, x}}; }
+inline void store(float* p, float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+
+inline float4 operator+(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+inline float4 operator-(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+inline float4 operator*(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+inline float4 abs(float4 a) { for (int i = 0; i < 4; i++) a.v[i] = std::fabs(a.v[i]); return a; }
+
+inline Mask4 operator>=(float4 a, float4 b) { Mask4 m; for (int i = 0; i < 4; i++) m.v[i] = a.v[i] >= b.v[i]; return m; }
+inline Mask4 operator<=(float4 a, float4 b) { Mask4 m; for (int i = 0; i < 4; i++) m.v[i] = a.v[i] <= b.v[i]; return m; }
+inline Mask4 operator&(Mask4 a, Mask4 b) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] && b.v[i]; return a; }
+inline int bits(Mask4 m) { return (m.v[0] ? 1 : 0) | (m.v[1] ? 2 : 0) | (m.v[2] ? 4 : 0) | (m.v[3] ? 8 : 0); }
+
+#endif
+
+/// Máscara com os primeiros count lanes (count entre 0 e 4).
+inline int firstLanes(unsigned count) { return (1 << (count < 4 ? count : 4)) - 1; }
+
+} // namespace simd
+
+#endif
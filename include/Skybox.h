@@ -5,18 +5,26 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
-#include <iostream>
-#include <stb_image.h>
 #include <shader_m.h>
+#include <ResourceManager.h>
 
 class Skybox {
 public:
     unsigned int VAO, VBO;
     unsigned int textureID;
 
-    Skybox(const std::vector<std::string>& faces) {
+    /// As faces são carregadas (e recarregadas) pelo gestor de recursos, que é dono do cubemap.
+    Skybox(const std::vector<std::string>& faces, ResourceManager& resources) {
         setupMesh();
-        textureID = loadCubemap(faces);
+        textureID = resources.cubemap(faces);
+    }
+
+    Skybox(const Skybox&) = delete;
+    Skybox& operator=(const Skybox&) = delete;
+
+    ~Skybox() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
     }
 
     void draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection, float lightIntensity) {
@@ -92,49 +100,6 @@ private:
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     }
-
-    unsigned int loadCubemap(std::vector<std::string> faces) {
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-        // IMPORTANTE: Desativar flip vertical para cubemaps
-        // (o flip é usado para texturas normais, mas não para skybox)
-        stbi_set_flip_vertically_on_load(false);
-
-        int width, height, nrChannels;
-        for (unsigned int i = 0; i < faces.size(); i++)
-        {
-            unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-            if (data)
-            {
-                GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-                stbi_image_free(data);
-                std::cout << "Skybox face " << i << " carregada: " << faces[i] << std::endl;
-            }
-            else
-            {
-                std::cout << "Falha ao carregar Cubemap em: " << faces[i] << std::endl;
-                stbi_image_free(data);
-            }
-        }
-
-        // Configurar filtros de textura para melhor qualidade
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-        // Ativar seamless cubemap para eliminar costuras entre faces (OpenGL 3.2+)
-        glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-
-        // Reativar flip vertical para outras texturas que possam ser carregadas depois
-        stbi_set_flip_vertically_on_load(true);
-
-        return textureID;
-    }
 };
 
 #endif
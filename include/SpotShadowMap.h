@@ -0,0 +1,151 @@
+#ifndef SPOT_SHADOW_MAP_H
+#define SPOT_SHADOW_MAP_H
+
+#include <cmath>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <shader_m.h>
+#include <Frustum.h>
+#include <Maze.h>
+
+/**
+ * @class SpotShadowMap
+ * @brief Shadow map em perspetiva para a lanterna, sobre a geometria estática do labirinto.
+ *
+ * Só os chunks dentro do frustum da lanterna são desenhados (Maze::draw com frustum). Como o
+ * labirinto não se mexe, o mapa fica válido enquanto a lanterna não se mover: update() só
+ * volta a desenhar quando a posição ou a direção mudam mais do que POSITION_EPSILON /
+ * DIRECTION_EPSILON desde o último mapa, e o shader usa sempre a matriz desse mapa.
+ *
+ * A textura usa comparação de profundidade (sampler2DShadow), pelo que cada amostra já dá
+ * PCF bilinear em hardware.
+ */
+class SpotShadowMap {
+public:
+    static const int DEFAULT_SIZE = 1024;           ///< Resolução por omissão (quadrada)
+    static const int UNIT = 4;                      ///< Unidade de textura do mapa no shader de iluminação
+    static constexpr float POSITION_EPSILON = 0.5f; ///< Deslocamento (unidades) que obriga a refazer o mapa
+    static constexpr float DIRECTION_EPSILON = 1e-4f;   ///< 1 - cos do desvio de direção que obriga a refazer o mapa
+    static constexpr float NORMAL_OFFSET_TEXELS = 1.5f; ///< Deslocamento ao longo da normal, em texels, contra acne
+
+    /**
+     * @param size Resolução do mapa.
+     * @param zNear, zFar Intervalo de profundidade da lanterna (para lá de zFar não há sombra).
+     */
+    SpotShadowMap(int size = DEFAULT_SIZE, float zNear = 5.0f, float zFar = 3000.0f)
+        : size(size), zNear(zNear), zFar(zFar) {
+        glGenTextures(1, &depthTexture);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };   // Fora do mapa: sem sombra
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) std::cout << "Aviso: framebuffer do shadow map incompleto; sombras desligadas" << std::endl;
+    }
+
+    SpotShadowMap(const SpotShadowMap&) = delete;
+    SpotShadowMap& operator=(const SpotShadowMap&) = delete;
+
+    ~SpotShadowMap() {
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteTextures(1, &depthTexture);
+    }
+
+    /**
+     * @brief Refaz o mapa se a lanterna se moveu desde o último.
+     * @param maze Labirinto (chunks descartados pelo frustum da lanterna).
+     * @param depthShader Programa de shadow_depth.vs/.fs.
+     * @param position, direction Posição e direção (normalizada) da lanterna.
+     * @param fovDegrees Abertura total do cone a cobrir.
+     * @return true se o mapa foi desenhado neste frame.
+     */
+    bool update(Maze& maze, Shader& depthShader, const glm::vec3& position, const glm::vec3& direction, float fovDegrees) {
+        if (!complete) return false;
+        if (valid && glm::distance(position, lastPosition) < POSITION_EPSILON &&
+            glm::dot(direction, lastDirection) > 1.0f - DIRECTION_EPSILON && fovDegrees == lastFov) {
+            skippedUpdates++;
+            return false;
+        }
+
+        glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(position, position + direction, up);
+        glm::mat4 projection = glm::perspective(glm::radians(fovDegrees), 1.0f, zNear, zFar);
+        space = projection * view;
+
+        GLint previousFramebuffer = 0, viewport[4];
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, size, size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        // Sem culling: as paredes têm faces com as duas orientações
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        depthShader.use();
+        depthShader.setMat4("lightSpace", space);
+        maze.draw(depthShader, Frustum(space));
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        lastPosition = position;
+        lastDirection = direction;
+        lastFov = fovDegrees;
+        texelAngle = 2.0f * std::tan(glm::radians(fovDegrees) * 0.5f) / size;
+        valid = true;
+        shadowChunks = maze.visibleChunks;
+        renderedUpdates++;
+        return true;
+    }
+
+    /// Força o próximo update() a desenhar (por exemplo se a geometria mudar).
+    void invalidate() { valid = false; }
+
+    void bind() const {
+        glActiveTexture(GL_TEXTURE0 + UNIT);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    bool ready() const { return valid; }
+    const glm::mat4& lightSpace() const { return space; }   ///< projection * view do último mapa
+
+    /// Deslocamento ao longo da normal por unidade de distância à lanterna (o texel cresce com a distância).
+    float normalOffsetPerUnit() const { return texelAngle * NORMAL_OFFSET_TEXELS; }
+    float texelSize() const { return 1.0f / size; }
+
+    unsigned int renderedUpdates = 0;   ///< Mapas desenhados desde o início
+    unsigned int skippedUpdates = 0;    ///< Frames em que o mapa em cache foi reutilizado
+    unsigned int shadowChunks = 0;      ///< Chunks desenhados no último mapa
+
+private:
+    int size;
+    float zNear, zFar;
+    GLuint FBO = 0, depthTexture = 0;
+    bool complete = false;
+    bool valid = false;
+    glm::mat4 space = glm::mat4(1.0f);
+    glm::vec3 lastPosition = glm::vec3(0.0f), lastDirection = glm::vec3(0.0f);
+    float lastFov = 0.0f;
+    float texelAngle = 0.0f;
+};
+
+#endif
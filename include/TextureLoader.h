@@ -0,0 +1,522 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+
+#include <stb_image.h>
+#include <ThreadPool.h>
+#include <CompressedTexture.h>
+
+/**
+ * @struct TextureOptions
+ * @brief Parâmetros de amostragem de uma textura 2D carregada pelo TextureLoader.
+ */
+struct TextureOptions {
+    bool repeat = true;                                 ///< GL_REPEAT (true) ou GL_CLAMP_TO_EDGE
+    bool mipmaps = true;                                ///< Gerar mipmaps e filtrar com GL_LINEAR_MIPMAP_LINEAR
+    bool flip = true;                                   ///< Inverter verticalmente na descodificação
+    glm::vec4 placeholder = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);  ///< Cor 1x1 mostrada até a imagem chegar
+};
+
+/**
+ * @class TextureLoader
+ * @brief Carregamento assíncrono de texturas: descodificação em workers e envio por PBO.
+ *
+ * load2D() e loadCubemap() criam logo a textura com um placeholder 1x1 e devolvem o seu id,
+ * pelo que o render pode começar de imediato. Os PNG são descodificados em paralelo no
+ * ThreadPool; update(), chamado uma vez por frame na thread do contexto OpenGL, copia as
+ * imagens prontas para um pixel buffer object e especifica a textura a partir dele, com um
+ * limite de bytes por frame para não causar picos. As faces de um cubemap só são enviadas
+ * quando as seis estão prontas (faces de tamanhos diferentes deixariam o cubemap incompleto).
+ *
+ * O arranque fica assim limitado pela descodificação mais lenta e não pela soma de todas.
+ *
+ * Se existir ao lado do PNG uma versão pré-comprimida (.ktx2 ou .dds, ver tools/texconv.cpp)
+ * que não seja mais antiga, é essa a usada: os blocos BCn e os mipmaps já calculados são
+ * enviados diretamente, sem descodificação nem glGenerateMipmap. Sem suporte de S3TC no
+ * contexto, ou se o ficheiro não puder ser lido, é usado o PNG.
+ *
+ * loadArray() junta várias imagens numa GL_TEXTURE_2D_ARRAY (uma camada por imagem), enviada
+ * como os cubemaps quando todas as camadas chegam. As camadas só usam as versões comprimidas
+ * se todas as tiverem com o mesmo formato, tamanho e número de níveis; caso contrário, as
+ * camadas comprimidas são descodificadas de novo a partir dos PNG.
+ *
+ * As três funções aceitam também o id de uma textura já existente (recarregamento, ver
+ * ResourceManager): a imagem nova é enviada para essa textura quando chega e, até lá, continua
+ * a ver-se a anterior em vez de um placeholder.
+ */
+class TextureLoader {
+public:
+    explicit TextureLoader(unsigned threadCount = ThreadPool::defaultThreadCount())
+        : pool(new ThreadPool(threadCount)), s3tcSupported(CompressedTexture::s3tcSupported()) {
+        glGenBuffers(1, &PBO);
+    }
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    ~TextureLoader() {
+        pool.reset();   // Espera pelas descodificações em curso antes de libertar o resto
+        for (Image* image : ready) {
+            stbi_image_free(image->pixels);
+            delete image;
+        }
+        for (auto& group : groups) {
+            for (auto& face : group.faces) if (face) stbi_image_free(face->pixels);
+        }
+        glDeleteBuffers(1, &PBO);
+    }
+
+    /**
+     * @brief Cria uma textura 2D com placeholder e agenda o carregamento da imagem.
+     * @param texture Textura a recarregar (0: criar uma nova).
+     * @return Id da textura OpenGL (válido de imediato).
+     */
+    GLuint load2D(const std::string& path, const TextureOptions& options = TextureOptions(), GLuint texture = 0) {
+        bool reload = texture != 0;
+        if (!reload) glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        GLint wrap = options.repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Um envio anterior pré-comprimido pode ter limitado a cadeia de mipmaps
+        if (reload) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+        else uploadPlaceholder(GL_TEXTURE_2D, options.placeholder);
+
+        Image* image = new Image();
+        image->path = path;
+        image->texture = texture;
+        image->target = GL_TEXTURE_2D;
+        image->mipmaps = options.mipmaps;
+        image->flip = options.flip;
+        queue(image);
+        return texture;
+    }
+
+    /**
+     * @brief Cria um cubemap com placeholder e agenda o carregamento das seis faces
+     * (ordem +X, -X, +Y, -Y, +Z, -Z; sem inversão vertical).
+     * @param texture Cubemap a recarregar (0: criar um novo).
+     * @return Id da textura OpenGL (válido de imediato).
+     */
+    GLuint loadCubemap(const std::vector<std::string>& faces, glm::vec4 placeholder = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+                       GLuint texture = 0) {
+        bool reload = texture != 0;
+        if (!reload) glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+        if (reload) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 1000);
+        } else {
+            for (unsigned int i = 0; i < 6; i++) uploadPlaceholder(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, placeholder);
+        }
+
+        int group = (int)groups.size();
+        groups.emplace_back();
+        groups.back().faces.resize(faces.size());
+        for (size_t i = 0; i < faces.size(); i++) {
+            Image* image = new Image();
+            image->path = faces[i];
+            image->texture = texture;
+            image->target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)i;
+            image->flip = false;
+            image->group = group;
+            image->groupIndex = (int)i;
+            queue(image);
+        }
+        return texture;
+    }
+
+    /**
+     * @brief Cria uma array de texturas 2D com uma camada por imagem e agenda o seu carregamento.
+     *
+     * Todas as camadas devem ter as mesmas dimensões (as do primeiro PNG válido); as que não
+     * tiverem ficam com a cor do placeholder.
+     * @param texture Array a recarregar (0: criar uma nova).
+     * @return Id da textura OpenGL (GL_TEXTURE_2D_ARRAY, válido de imediato).
+     */
+    GLuint loadArray(const std::vector<std::string>& layers, const TextureOptions& options = TextureOptions(),
+                     GLuint texture = 0) {
+        bool reload = texture != 0;
+        if (!reload) glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        GLint wrap = options.repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, options.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (reload) {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 1000);
+        } else {
+            std::vector<unsigned char> pixels(layers.size() * 4);
+            for (size_t i = 0; i < pixels.size(); i++) pixels[i] = placeholderByte(options.placeholder, (int)(i % 4));
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, 1, 1, (GLsizei)layers.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+
+        int group = (int)groups.size();
+        groups.emplace_back();
+        groups.back().faces.resize(layers.size());
+        groups.back().texture = texture;
+        groups.back().array = true;
+        groups.back().mipmaps = options.mipmaps;
+        groups.back().placeholder = options.placeholder;
+        for (size_t i = 0; i < layers.size(); i++) {
+            Image* image = new Image();
+            image->path = layers[i];
+            image->texture = texture;
+            image->target = GL_TEXTURE_2D_ARRAY;
+            image->mipmaps = options.mipmaps;
+            image->flip = options.flip;
+            image->rgba = true;
+            image->group = group;
+            image->groupIndex = (int)i;
+            queue(image);
+        }
+        return texture;
+    }
+
+    /**
+     * @brief Envia para a GPU as imagens já descodificadas (chamar uma vez por frame).
+     * @param maxBytes Limite de bytes enviados neste frame (pelo menos uma imagem é sempre enviada).
+     */
+    void update(size_t maxBytes = 16u << 20) {
+        size_t sent = 0;
+        while (sent < maxBytes) {
+            std::unique_ptr<Image> image;
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                if (ready.empty()) break;
+                image.reset(ready.front());
+                ready.pop_front();
+            }
+
+            if (image->group < 0) {
+                sent += upload(*image);
+                finish(*image);
+                continue;
+            }
+
+            // Cubemap ou array: guardar a face até o grupo estar completo
+            Group& group = groups[image->group];
+            int index = image->groupIndex;
+            group.faces[index] = std::move(image);
+            if (++group.arrived < (int)group.faces.size()) continue;
+            if (group.array) {
+                sent += uploadArray(group);
+                continue;
+            }
+            for (auto& face : group.faces) {
+                sent += upload(*face);
+                finish(*face);
+                face.reset();
+            }
+        }
+    }
+
+    /// Imagens ainda por enviar (em descodificação ou à espera de update()).
+    size_t pending() const { return outstanding.load(); }
+
+    /// Bloqueia até todas as texturas estarem na GPU (para ferramentas e testes).
+    void finishAll() {
+        while (pending() > 0) {
+            update(~size_t(0));
+            if (pending() > 0) std::this_thread::yield();
+        }
+    }
+
+private:
+    /// Uma imagem a carregar (uma textura 2D, uma face de um cubemap ou uma camada de uma array).
+    struct Image {
+        std::string path;
+        GLuint texture = 0;
+        GLenum target = GL_TEXTURE_2D;
+        bool mipmaps = false;
+        bool flip = true;
+        bool rgba = false;          ///< Descodificar sempre com 4 canais (camadas de uma array)
+        bool forcePng = false;      ///< Ignorar a versão pré-comprimida
+        int group = -1;             ///< Índice do grupo em groups (-1 para texturas 2D)
+        int groupIndex = 0;         ///< Face ou camada dentro do grupo
+        unsigned char* pixels = nullptr;    ///< Resultado do stbi_load (nullptr se falhou)
+        int width = 0, height = 0, channels = 0;
+        CompressedTexture compressed;       ///< Versão pré-comprimida (format != 0 se foi usada)
+        std::string loadedPath;             ///< Ficheiro efetivamente lido
+    };
+
+    /// Faces de um cubemap (ou camadas de uma array) que já chegaram.
+    struct Group {
+        std::vector<std::unique_ptr<Image>> faces;
+        int arrived = 0;
+        GLuint texture = 0;
+        bool array = false;         ///< GL_TEXTURE_2D_ARRAY em vez de cubemap
+        bool mipmaps = false;
+        glm::vec4 placeholder;      ///< Cor das camadas que falharam
+    };
+
+    std::unique_ptr<ThreadPool> pool;
+    std::mutex readyMutex;
+    std::deque<Image*> ready;               ///< Descodificadas, à espera de envio (protegido por readyMutex)
+    std::deque<Group> groups;               ///< Cubemaps (acedido apenas na thread do contexto)
+    std::atomic<size_t> outstanding{0};
+    GLuint PBO = 0;
+    const bool s3tcSupported;               ///< O contexto aceita BC1-BC3 (lido antes de qualquer worker)
+
+    void queue(Image* image) {
+        outstanding.fetch_add(1);
+        pool->submit([this, image]() {
+            // A flag de inversão do stb_image é global; a versão _thread é local a cada worker
+            stbi_set_flip_vertically_on_load_thread(image->flip);
+
+            // Preferir a versão pré-comprimida, se existir e o contexto a aceitar
+            std::string compressedPath = image->forcePng ? std::string() : CompressedTexture::findFor(image->path);
+            if (!compressedPath.empty() && image->compressed.load(compressedPath, image->flip) &&
+                (s3tcSupported || !CompressedTexture::isS3TC(image->compressed.format))) {
+                image->loadedPath = compressedPath;
+                image->width = image->compressed.levels[0].width;
+                image->height = image->compressed.levels[0].height;
+                std::lock_guard<std::mutex> lock(readyMutex);
+                ready.push_back(image);
+                return;
+            }
+            image->compressed = CompressedTexture();
+
+            image->loadedPath = image->path;
+            int width, height, channels;
+            if (stbi_info(image->path.c_str(), &width, &height, &channels)) {
+                int wanted = (channels == 3 && !image->rgba) ? 3 : 4;
+                image->pixels = stbi_load(image->path.c_str(), &image->width, &image->height, &channels, wanted);
+                image->channels = wanted;
+            }
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(image);
+        });
+    }
+
+    /// Especifica o nível 0 a partir do PBO; devolve os bytes enviados.
+    size_t upload(Image& image) {
+        if (image.compressed.format) return uploadCompressed(image);
+        if (!image.pixels) return 0;
+        size_t size = (size_t)image.width * image.height * image.channels;
+        GLenum format = image.channels == 4 ? GL_RGBA : GL_RGB;
+
+        // Orfanar o buffer evita esperar pelo envio anterior; o driver copia de forma assíncrona
+        std::vector<unsigned char> fallback;
+        unsigned char* staging = beginStaging(size, fallback);
+        std::memcpy(staging, image.pixels, size);
+        endStaging(staging, fallback);
+
+        GLenum bindTarget = image.group < 0 ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP;
+        glBindTexture(bindTarget, image.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(image.target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                     stagingPointer(0, fallback));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (image.mipmaps) glGenerateMipmap(bindTarget);
+        return size;
+    }
+
+    /// Envia todos os níveis de uma textura pré-comprimida num só PBO.
+    size_t uploadCompressed(Image& image) {
+        const CompressedTexture& compressed = image.compressed;
+        size_t size = compressed.data.size();
+        std::vector<unsigned char> fallback;
+        unsigned char* staging = beginStaging(size, fallback);
+        std::memcpy(staging, compressed.data.data(), size);
+        endStaging(staging, fallback);
+
+        GLenum bindTarget = image.group < 0 ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP;
+        glBindTexture(bindTarget, image.texture);
+        for (size_t i = 0; i < compressed.levels.size(); i++) {
+            const CompressedTexture::Level& level = compressed.levels[i];
+            glCompressedTexImage2D(image.target, (GLint)i, compressed.format, level.width, level.height, 0,
+                                   (GLsizei)level.size, stagingPointer(level.offset, fallback));
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // A cadeia termina no último nível do ficheiro; com um só nível não há mipmaps para filtrar
+        glTexParameteri(bindTarget, GL_TEXTURE_MAX_LEVEL, (GLint)compressed.levels.size() - 1);
+        if (compressed.levels.size() == 1 && image.mipmaps) glTexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        return size;
+    }
+
+    /**
+     * @brief Envia todas as camadas de uma array (chamado quando o grupo está completo).
+     * @return Bytes enviados (0 se as camadas comprimidas tiveram de voltar aos PNG).
+     */
+    size_t uploadArray(Group& group) {
+        std::vector<std::unique_ptr<Image>>& layers = group.faces;
+        const CompressedTexture& first = layers[0]->compressed;
+        bool anyCompressed = false, allCompatible = first.format != 0;
+        for (auto& layer : layers) {
+            const CompressedTexture& c = layer->compressed;
+            anyCompressed = anyCompressed || c.format != 0;
+            allCompatible = allCompatible && c.format == first.format && c.levels.size() == first.levels.size() &&
+                            c.levels[0].width == first.levels[0].width && c.levels[0].height == first.levels[0].height;
+        }
+
+        if (anyCompressed && !allCompatible) {
+            // Formatos misturados: as camadas comprimidas voltam a ser descodificadas a partir do PNG
+            std::cout << "Camadas de " << layers[0]->path << " com formatos diferentes: a usar os PNG" << std::endl;
+            for (auto& layer : layers) {
+                if (!layer->compressed.format) continue;
+                layer->compressed = CompressedTexture();
+                layer->forcePng = true;
+                group.arrived--;
+                outstanding.fetch_sub(1);
+                queue(layer.release());
+            }
+            return 0;
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, group.texture);
+        size_t size = allCompatible ? uploadCompressedArray(group) : uploadPixelArray(group);
+        for (auto& layer : layers) {
+            finish(*layer);
+            layer.reset();
+        }
+        return size;
+    }
+
+    /// Camadas pré-comprimidas: cada nível guarda as camadas seguidas no PBO.
+    size_t uploadCompressedArray(Group& group) {
+        std::vector<std::unique_ptr<Image>>& layers = group.faces;
+        const CompressedTexture& first = layers[0]->compressed;
+        GLsizei count = (GLsizei)layers.size();
+        size_t size = 0;
+        for (const auto& level : first.levels) size += level.size * layers.size();
+
+        std::vector<unsigned char> fallback;
+        unsigned char* staging = beginStaging(size, fallback);
+        size_t offset = 0;
+        for (const auto& level : first.levels) {
+            size_t levelIndex = &level - first.levels.data();
+            for (auto& layer : layers) {
+                const CompressedTexture::Level& source = layer->compressed.levels[levelIndex];
+                std::memcpy(staging + offset, layer->compressed.data.data() + source.offset, source.size);
+                offset += source.size;
+            }
+        }
+        endStaging(staging, fallback);
+
+        offset = 0;
+        for (size_t i = 0; i < first.levels.size(); i++) {
+            const CompressedTexture::Level& level = first.levels[i];
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, first.format, level.width, level.height, count, 0,
+                                   (GLsizei)(level.size * count), stagingPointer(offset, fallback));
+            offset += level.size * count;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)first.levels.size() - 1);
+        if (first.levels.size() == 1 && group.mipmaps) glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        return size;
+    }
+
+    /// Camadas descodificadas (RGBA): um só glTexImage3D a partir do PBO.
+    size_t uploadPixelArray(Group& group) {
+        std::vector<std::unique_ptr<Image>>& layers = group.faces;
+        int width = 0, height = 0;
+        for (auto& layer : layers) {
+            if (layer->pixels) { width = layer->width; height = layer->height; break; }
+        }
+        if (width == 0) return 0;   // Nenhuma camada carregou: fica o placeholder
+
+        size_t layerSize = (size_t)width * height * 4;
+        size_t size = layerSize * layers.size();
+        std::vector<unsigned char> fallback;
+        unsigned char* staging = beginStaging(size, fallback);
+        for (size_t i = 0; i < layers.size(); i++) {
+            unsigned char* dst = staging + i * layerSize;
+            const Image& layer = *layers[i];
+            if (layer.pixels && layer.width == width && layer.height == height) {
+                std::memcpy(dst, layer.pixels, layerSize);
+                continue;
+            }
+            if (layer.pixels) {
+                std::cout << "Camada " << layer.path << " com " << layer.width << "x" << layer.height
+                          << " em vez de " << width << "x" << height << ": ignorada" << std::endl;
+            }
+            for (size_t k = 0; k < layerSize; k++) dst[k] = placeholderByte(group.placeholder, (int)(k % 4));
+        }
+        endStaging(staging, fallback);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, (GLsizei)layers.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     stagingPointer(0, fallback));
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (group.mipmaps) glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        return size;
+    }
+
+    /**
+     * @brief Prepara size bytes de staging no PBO (orfanado) e devolve onde escrever.
+     * Se o mapeamento falhar, usa fallback na memória do cliente (e desliga o PBO).
+     */
+    unsigned char* beginStaging(size_t size, std::vector<unsigned char>& fallback) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) return (unsigned char*)mapped;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        fallback.resize(size);
+        return fallback.data();
+    }
+
+    void endStaging(unsigned char* staging, const std::vector<unsigned char>& fallback) {
+        if (staging != fallback.data()) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    /// Ponteiro a passar ao GL para o byte offset do staging (offset no PBO ou endereço no cliente).
+    static const void* stagingPointer(size_t offset, const std::vector<unsigned char>& fallback) {
+        return fallback.empty() ? (const void*)(uintptr_t)offset : (const void*)(fallback.data() + offset);
+    }
+
+    void finish(Image& image) {
+        if (image.compressed.format) {
+            std::cout << "Textura carregada: " << image.loadedPath << " (" << image.width << "x" << image.height << ", "
+                      << CompressedTexture::formatName(image.compressed.format) << ", "
+                      << image.compressed.levels.size() << " niveis)" << std::endl;
+            image.compressed = CompressedTexture();
+        } else if (image.pixels) {
+            std::cout << "Textura carregada: " << image.path << " (" << image.width << "x" << image.height << ")" << std::endl;
+        } else {
+            std::cout << "Falha ao carregar textura " << image.path << std::endl;
+        }
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        outstanding.fetch_sub(1);
+    }
+
+    static unsigned char placeholderByte(glm::vec4 color, int channel) {
+        return (unsigned char)(glm::clamp(color[channel], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    static void uploadPlaceholder(GLenum target, glm::vec4 color) {
+        unsigned char pixel[4];
+        for (int k = 0; k < 4; k++) pixel[k] = placeholderByte(color, k);
+        glTexImage2D(target, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    }
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+/**
+ * @class ThreadPool
+ * @brief Pool de threads com roubo de trabalho (work stealing).
+ *
+ * Cada worker tem a sua fila: retira tarefas do fim da própria fila e, quando esta fica
+ * vazia, rouba do início das filas dos outros. parallelFor() divide um intervalo em blocos,
+ * distribui-os pelas filas e a thread que chama também executa blocos enquanto espera,
+ * pelo que pode ser chamado a partir de uma tarefa do próprio pool sem bloquear.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threadCount Número de workers (por omissão, um por núcleo menos a thread que chama).
+     */
+    explicit ThreadPool(unsigned threadCount = defaultThreadCount()) {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned i = 0; i < threadCount; i++) queues.emplace_back(new Queue());
+        for (unsigned i = 0; i < threadCount; i++) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    /// Número de workers.
+    size_t size() const { return workers.size(); }
+
+    static unsigned defaultThreadCount() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    /**
+     * @brief Executa fn(begin, end) sobre blocos de [0, count) em paralelo e espera pelo fim.
+     *
+     * @param grain Tamanho de cada bloco (os blocos pequenos equilibram melhor a carga,
+     *              os grandes reduzem o custo por tarefa).
+     * @param fn Função void(size_t begin, size_t end); chamada concorrentemente.
+     */
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, Function&& fn) {
+        if (count == 0) return;
+        grain = std::max<size_t>(1, grain);
+        size_t blocks = (count + grain - 1) / grain;
+        if (blocks == 1) {
+            fn((size_t)0, count);
+            return;
+        }
+
+        std::atomic<size_t> remaining(blocks);
+        for (size_t b = 0; b < blocks; b++) {
+            size_t begin = b * grain;
+            size_t end = std::min(count, begin + grain);
+            push(b % queues.size(), [&fn, &remaining, begin, end]() {
+                fn(begin, end);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+
+        // A thread que chama ajuda até todos os blocos terminarem
+        std::function<void()> task;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (steal(0, task)) {
+                task();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief Agenda uma tarefa independente e retorna logo, sem esperar pela sua execução.
+     *
+     * As tarefas são distribuídas pelas filas em rotação. Tarefas ainda na fila quando o pool
+     * é destruído são executadas antes de os workers terminarem.
+     */
+    void submit(std::function<void()> task) {
+        push(nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size(), std::move(task));
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};      ///< Tarefas em filas (não inclui as que estão a correr)
+    std::atomic<size_t> nextQueue{0};   ///< Fila da próxima tarefa de submit()
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void push(size_t queueIndex, std::function<void()> task) {
+        // Contada ainda com o mutex da fila: quem a retirar (com o mesmo mutex) nunca decrementa
+        // o contador antes do incremento, que de outra forma daria a volta abaixo de zero
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+        queued.fetch_add(1, std::memory_order_release);
+    }
+
+    /// Retira do fim da fila própria (a mais recente, ainda quente na cache).
+    bool popLocal(size_t queueIndex, std::function<void()>& task) {
+        Queue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Rouba do início das filas, começando pela seguinte a first.
+    bool steal(size_t first, std::function<void()>& task) {
+        for (size_t k = 0; k < queues.size(); k++) {
+            Queue& queue = *queues[(first + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        std::function<void()> task;
+        while (true) {
+            if (popLocal(index, task) || steal(index + 1, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+            // Ao parar, as filas são esvaziadas primeiro (ver submit())
+            if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <functional>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -21,80 +23,99 @@ public:
         std::string vertexCode;
         std::string fragmentCode;
         std::string geometryCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        std::ifstream gShaderFile;
+        if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode) ||
+            (geometryPath != nullptr && !readSource(geometryPath, geometryCode)))
+        {
+            std::cout << "ERRO::SHADER::FICHEIRO_NAO_LIDO_COM_SUCESSO" << std::endl;
+        }
+        // 2. compilar e ligar o programa
+        ID = buildProgram(vertexCode.c_str(), fragmentCode.c_str(), geometryPath != nullptr ? geometryCode.c_str() : nullptr);
+        // guardar as localizações de todos os uniformes ativos (evita glGetUniformLocation por frame)
+        cacheUniformLocations();
+    }
+    // adotar um programa já ligado (p.ex. carregado de um program binary)
+    // ------------------------------------------------------------------------
+    explicit Shader(GLuint program) : ID(program)
+    {
+        cacheUniformLocations();
+    }
+    // trocar o programa por outro já ligado (recarregamento); o anterior é apagado
+    // ------------------------------------------------------------------------
+    void adopt(GLuint program)
+    {
+        if (ID != 0 && ID != program)
+            glDeleteProgram(ID);
+        ID = program;
+        uniformLocations.clear();
+        cacheUniformLocations();
+    }
+    // ler o código fonte de um ficheiro; false se não puder ser lido
+    // ------------------------------------------------------------------------
+    static bool readSource(const char* path, std::string& code)
+    {
+        std::ifstream file;
         // garantir que objetos ifstream podem lançar exceções:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
+        file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try
         {
-            // abrir ficheiros
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // ler conteúdo do buffer do ficheiro para os streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();		
-            // fechar handlers de ficheiro
-            vShaderFile.close();
-            fShaderFile.close();
-            // converter stream para string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();			
-            // se caminho do geometry shader estiver presente, carregar também
-            if(geometryPath != nullptr)
-            {
-                gShaderFile.open(geometryPath);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            code = stream.str();
+            return true;
         }
         catch (std::ifstream::failure& e)
         {
-            std::cout << "ERRO::SHADER::FICHEIRO_NAO_LIDO_COM_SUCESSO" << std::endl;
+            return false;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compilar shaders
+    }
+    // compilar os shaders e ligar um programa novo (geometryCode opcional)
+    // beforeLink corre antes do glLinkProgram (p.ex. para pedir um program binary);
+    // linked indica se a compilação e a ligação tiveram sucesso (o programa é devolvido na mesma)
+    // ------------------------------------------------------------------------
+    static GLuint buildProgram(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode = nullptr,
+                               bool* linked = nullptr, const std::function<void(GLuint)>& beforeLink = nullptr)
+    {
+        bool ok = true;
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        ok = checkCompileErrors(vertex, "VERTEX") && ok;
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        ok = checkCompileErrors(fragment, "FRAGMENT") && ok;
         // se geometry shader for fornecido, compilar geometry shader
-        unsigned int geometry;
-        if(geometryPath != nullptr)
+        unsigned int geometry = 0;
+        if(gShaderCode != nullptr)
         {
-            const char * gShaderCode = geometryCode.c_str();
             geometry = glCreateShader(GL_GEOMETRY_SHADER);
             glShaderSource(geometry, 1, &gShaderCode, NULL);
             glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
+            ok = checkCompileErrors(geometry, "GEOMETRY") && ok;
         }
         // Programa Shader
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if(geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        if(gShaderCode != nullptr)
+            glAttachShader(program, geometry);
+        if (beforeLink)
+            beforeLink(program);
+        glLinkProgram(program);
+        ok = checkCompileErrors(program, "PROGRAM") && ok;
         // apagar os shaders pois já estão linkados no programa e não são mais necessários
         glDeleteShader(vertex);
         glDeleteShader(fragment);
-        if(geometryPath != nullptr)
+        if(gShaderCode != nullptr)
             glDeleteShader(geometry);
-
+        if (linked != nullptr)
+            *linked = ok;
+        return program;
     }
     // ativar o shader
     // ------------------------------------------------------------------------
@@ -102,69 +123,129 @@ public:
     { 
         glUseProgram(ID); 
     }
+    // localização de um uniforme (-1 se não existir ou não estiver ativo, tal como no OpenGL)
+    // nomes fora da cache (p.ex. "luzes[3]") são pedidos ao driver uma vez e guardados;
+    // resolvê-la uma vez e usar as versões setX(GLint, ...) evita também a procura por nome
+    // ------------------------------------------------------------------------
+    GLint getUniformLocation(const std::string &name) const
+    {
+        auto it = uniformLocations.find(name);
+        if (it != uniformLocations.end())
+            return it->second;
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        uniformLocations.emplace(name, location);
+        return location;
+    }
+    // ligar um bloco de uniformes (std140) a um ponto de ligação partilhado entre programas
+    // ------------------------------------------------------------------------
+    void bindUniformBlock(const std::string &name, GLuint binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
+    }
     // funções utilitárias para uniformes
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        glUniform1i(getUniformLocation(name), (int)value); 
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1i(getUniformLocation(name), value); 
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        glUniform1f(getUniformLocation(name), value); 
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform2fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec2(const std::string &name, float x, float y) const
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        glUniform2f(getUniformLocation(name), x, y); 
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform3fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        glUniform3f(getUniformLocation(name), x, y, z); 
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        glUniform4fv(getUniformLocation(name), 1, &value[0]); 
     }
     void setVec4(const std::string &name, float x, float y, float z, float w) 
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        glUniform4f(getUniformLocation(name), x, y, z, w); 
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
     }
+    // versões com localização já resolvida (getUniformLocation)
+    // ------------------------------------------------------------------------
+    void setBool(GLint location, bool value) const { glUniform1i(location, (int)value); }
+    void setInt(GLint location, int value) const { glUniform1i(location, value); }
+    void setFloat(GLint location, float value) const { glUniform1f(location, value); }
+    void setVec2(GLint location, const glm::vec2 &value) const { glUniform2fv(location, 1, &value[0]); }
+    void setVec3(GLint location, const glm::vec3 &value) const { glUniform3fv(location, 1, &value[0]); }
+    void setVec3(GLint location, float x, float y, float z) const { glUniform3f(location, x, y, z); }
+    void setVec4(GLint location, const glm::vec4 &value) const { glUniform4fv(location, 1, &value[0]); }
+    void setMat3(GLint location, const glm::mat3 &mat) const { glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]); }
+    void setMat4(GLint location, const glm::mat4 &mat) const { glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]); }
 
 private:
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    // preencher a cache com os uniformes ativos do programa ligado
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string name(maxLength > 0 ? maxLength : 1, '\0');
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+            std::string uniformName(name.c_str(), length);
+            GLint location = glGetUniformLocation(ID, uniformName.c_str());
+            if (location < 0)
+                continue; // membros de blocos de uniformes não têm localização
+            uniformLocations[uniformName] = location;
+            // arrays aparecem como "nome[0]"; aceitar também "nome"
+            size_t bracket = uniformName.find("[0]");
+            if (bracket != std::string::npos && bracket + 3 == uniformName.size())
+                uniformLocations[uniformName.substr(0, bracket)] = location;
+        }
+    }
+
     // função utilitária para verificar erros de compilação/ligação
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    static bool checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -186,6 +267,7 @@ private:
                 std::cout << "ERRO::LIGACAO_PROGRAMA do tipo: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
@@ -20,6 +20,30 @@
  * O projeto requer bibliotecas OpenGL, GLFW, GLAD, GLM e STB Image.
  * Compile usando o Makefile fornecido ou CMake.
  *
+ * \section bench_sec Gravação e replay
+ *
+ * `MAZE --record percurso.trace` grava a entrada de cada tick de simulação. `MAZE --replay
+ * percurso.trace [--report prefixo]` repete o percurso a passo fixo, sem vsync, e escreve os
+ * tempos de CPU/GPU de cada frame em `prefixo.csv` e um resumo em `prefixo.txt` (por omissão
+ * `replay`), para comparar builds no labirinto real. O replay desenha à escala fixa de `--scale`
+ * (por omissão 1), para que as medições não dependam da resolução dinâmica.
+ *
+ * \section pacing_sec Ritmo de frames e resolução dinâmica
+ *
+ * `--vsync on|adaptive|off` escolhe o modo de apresentação e `--fps N` limita os frames com
+ * esperas (vsync desligado, entrada amostrada logo antes de cada frame); F3 percorre os modos.
+ * As passagens 3D são desenhadas a uma fração da resolução da janela que se adapta ao tempo de
+ * GPU medido (`--scale auto`, por omissão) ou fica fixa (`--scale 0.75`); F4 liga/desliga a
+ * adaptação.
+ *
+ * \section resources_sec Recursos
+ *
+ * Texturas e shaders são pedidos ao ResourceManager, que os partilha por caminho e os apaga no
+ * fim. Com o jogo a correr, gravar um shader ou uma imagem em `shaders/` ou `imagens/` recarrega-os
+ * em menos de um segundo; um shader com erros mantém o programa anterior. Os programas ligados
+ * ficam em ficheiros `.program` ao lado dos shaders (ignorados pelo git) e são reutilizados
+ * enquanto o código e o driver não mudarem.
+ *
  * \author Alexandre Santos
  * \author Vasco Colaço
  * \date 2025
@@ -49,12 +73,28 @@
 #include <Maze.h>
 #include <Skybox.h>
 #include <OverlayRenderer.h>
+#include <DoubleBuffered.h>
+#include <Profiler.h>
+#include <FrameUniforms.h>
+#include <TextureLoader.h>
+#include <LightClusters.h>
+#include <SpotShadowMap.h>
+#include <NavGrid.h>
+#include <PropRenderer.h>
+#include <InputTrace.h>
+#include <RenderScale.h>
+#include <FramePacer.h>
+#include <ResourceManager.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 
 // Protótipos de funções
 /**
@@ -82,17 +122,87 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
 /**
- * @brief Processa toda a entrada (teclas) para o frame atual.
+ * @struct PlayerInput
+ * @brief Entrada de movimento amostrada uma vez por frame e consumida pelos ticks de simulação.
+ */
+struct PlayerInput {
+    bool forward = false;   ///< W
+    bool back = false;      ///< S
+    bool left = false;      ///< A
+    bool right = false;     ///< D
+    bool sprint = false;    ///< SHIFT
+    bool noclip = false;    ///< Colisões desligadas (V)
+    glm::vec3 front;        ///< Direção da câmara no momento da amostragem
+    glm::vec3 rightDir;     ///< Vetor "direita" da câmara no momento da amostragem
+    float speed = 0.0f;     ///< Velocidade base da câmara (unidades por segundo)
+    float yaw = 0.0f;       ///< Orientação da câmara (só para gravação/replay da vista)
+    float pitch = 0.0f;
+    uint32_t toggles = 0;   ///< Alternâncias de render no momento da amostragem (InputTrace::Flag)
+};
+
+/**
+ * @struct SimulationState
+ * @brief Estado do jogador avançado pelos ticks de simulação a ritmo fixo.
+ *
+ * Guarda também a posição do tick anterior, para que o render interpole entre as duas.
+ * É propriedade da thread de simulação; o render só vê cópias publicadas (snapshots).
+ */
+struct SimulationState {
+    glm::vec3 position;             ///< Posição no fim do último tick
+    glm::vec3 previousPosition;     ///< Posição no fim do tick anterior
+    float lightIntensity = 1.0f;    ///< Intensidade da luz ambiente (ciclo dia/noite)
+    bool victoryAchieved = false;   ///< O jogador chegou ao portão
+    double time = 0.0;              ///< Instante (simulationClock()) a que o último tick corresponde
+};
+
+/**
+ * @brief Processa as teclas de alternância (lanterna, noclip, ecrã inteiro, ...) e amostra a entrada de movimento.
  * @param window A janela.
- * @param camera O objeto câmara para controlar.
- * @param deltaTime Tempo decorrido desde o último frame.
+ * @param camera A câmara (apenas para a orientação atual).
+ * @return Entrada de movimento para os ticks deste frame.
+ */
+PlayerInput processInput(GLFWwindow *window, const Camera &camera);
+
+/**
+ * @brief Avança a simulação um tick: movimento, colisões, chão, failsafe e vitória.
+ * @param state Estado do jogador.
+ * @param input Entrada de movimento amostrada.
+ * @param dt Duração do tick (SIM_TICK).
  * @param maze O objeto labirinto (para deteção de colisões).
  */
-void processInput(GLFWwindow *window, Camera &camera, float deltaTime, Maze &maze);
+void simulationTick(SimulationState &state, const PlayerInput &input, float dt, Maze &maze);
+
+/**
+ * @brief Ciclo da thread de simulação: corre ticks de SIM_TICK ao ritmo do relógio e publica snapshots.
+ * @param maze O labirinto (só as consultas de colisão, que não alteram estado, são usadas aqui).
+ * @param state Estado inicial.
+ */
+void simulationLoop(Maze &maze, SimulationState state);
+
+/// Relógio monotónico em segundos partilhado pelas threads de simulação e de render.
+double simulationClock();
+
+/// Converte a entrada de um tick para o formato de gravação (InputTrace).
+InputTrace::Tick toTraceTick(const PlayerInput &input);
+
+/// Entrada de um tick gravado, tal como simulationTick() a recebeu na gravação.
+PlayerInput fromTraceTick(const InputTrace::Tick &tick);
 
 // Configurações da janela
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+const float Z_NEAR = 0.1f;      ///< Plano próximo da projeção
+const float Z_FAR = 5000.0f;    ///< Plano afastado da projeção
+const float FLASHLIGHT_INNER_ANGLE = 12.5f;     ///< Meia abertura do cone interior da lanterna (graus)
+const float FLASHLIGHT_OUTER_ANGLE = 17.5f;     ///< Meia abertura do cone exterior da lanterna (graus)
+const float HINT_INTERVAL = 0.25f;      ///< Segundos entre procuras do caminho até à saída (H)
+const float HINT_SPACING = 40.0f;       ///< Distância entre marcadores de pista ao longo do caminho
+const size_t HINT_MARKERS = 8;          ///< Número de marcadores de pista mostrados
+
+// Simulação a ritmo fixo, independente do ritmo de renderização
+const float SIM_TICK = 1.0f / 120.0f;       ///< Duração de um tick de física (120 Hz)
+const int MAX_TICKS_PER_FRAME = 8;          ///< Limite de ticks por frame (evita a "espiral da morte" em frames lentos)
+const int REPLAY_TICKS_PER_FRAME = 2;       ///< Ticks por frame no replay (frames de 1/60 s)
 
 // Variáveis globais
 Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
@@ -101,8 +211,11 @@ float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 bool noclip = false;
 bool flashLightOn = true;
+bool occlusionCulling = true;
+bool lodEnabled = true;         ///< Chunks distantes com geometria simplificada
+bool torchesOn = true;          ///< Luzes pontuais (clustered); desligadas fica só a luz superior e a lanterna
+bool hintOn = false;            ///< Marcadores do caminho até à saída
 
-float lightIntensity = 1.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 glm::vec3 topLightPos(0.0f, 50.0f, 0.0f);
@@ -110,13 +223,53 @@ glm::vec3 topLightPos(0.0f, 50.0f, 0.0f);
 bool isFullscreen = false;
 int savedXPos, savedYPos, savedWidth, savedHeight;
 
-bool victoryAchieved = false;
 float victoryTime = 0.0f;
 
+// Partilha entre a thread de render (main) e a thread de simulação
+DoubleBuffered<PlayerInput> sharedInput;            ///< Última entrada amostrada pelo render
+DoubleBuffered<SimulationState> sharedSimulation;   ///< Último estado publicado pela simulação
+std::atomic<bool> simulationRunning(false);
+
+// Gravação (--record) e replay (--replay) da entrada
+InputTrace *inputRecording = nullptr;   ///< Preenchido pela thread de simulação, um Tick por tick
+bool replaying = false;                 ///< Entrada lida do traço: teclado e rato ignorados
+
 bool showControls = false;
 
-int main()
+// Perfilador de frame (criado em main() depois do contexto OpenGL)
+Profiler *profiler = nullptr;
+FramePacer *framePacer = nullptr;       ///< Modo de apresentação (F3)
+RenderScale *renderScale = nullptr;     ///< Resolução das passagens 3D (F4)
+bool showProfiler = false;
+int skyboxSection, shadowSection, mazeSection, overlaySection;     ///< Passes de GPU
+int inputSection, simulationSection, collisionSection, lightsSection;   ///< Blocos de CPU
+
+int main(int argc, char **argv)
 {
+    std::string recordPath, replayPath, reportPrefix = "replay", vsyncOption = "on", scaleOption = "auto";
+    double frameLimit = 0.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--record") recordPath = argv[i + 1];
+        else if (option == "--replay") replayPath = argv[i + 1];
+        else if (option == "--report") reportPrefix = argv[i + 1];
+        else if (option == "--vsync") vsyncOption = argv[i + 1];
+        else if (option == "--fps") frameLimit = std::atof(argv[i + 1]);
+        else if (option == "--scale") scaleOption = argv[i + 1];
+    }
+    InputTrace trace;
+    if (!replayPath.empty()) {
+        if (!trace.load(replayPath)) {
+            std::cout << "Erro ao ler o traco " << replayPath << std::endl;
+            return -1;
+        }
+        if (trace.tickDuration != SIM_TICK) std::cout << "Aviso: traco gravado com outro SIM_TICK" << std::endl;
+        replaying = true;
+    } else if (!recordPath.empty()) {
+        trace.tickDuration = SIM_TICK;
+        inputRecording = &trace;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -153,244 +306,429 @@ int main()
 
     glEnable(GL_DEPTH_TEST);
 
-    // Carregar shaders
-    Shader lightingShader("shaders/2.1.basic_lighting.vs", "shaders/2.1.basic_lighting.fs");
-    Shader skyboxShader("shaders/skybox.vs", "shaders/skybox.fs");
-    Shader overlayShader("shaders/overlay.vs", "shaders/overlay.fs");
-
-    // Configurar labirinto
-    Maze maze("models/3d-model.obj");
-    camera.Position = maze.startPosition;
-    camera.MovementSpeed = maze.modelSize / 20.0f;
-    camera.MouseSensitivity = 0.005f;
-
-    // Carregar textura da parede (bricks)
-    stbi_set_flip_vertically_on_load(true);
-    unsigned int wallTexture;
-    glGenTextures(1, &wallTexture);
-    glBindTexture(GL_TEXTURE_2D, wallTexture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load("imagens/wall_texture.png", &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "Textura parede carregada!" << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura parede" << std::endl;
-    }
-    stbi_image_free(data);
-
-    // Carregar textura do chão
-    unsigned int floorTexture;
-    glGenTextures(1, &floorTexture);
-    glBindTexture(GL_TEXTURE_2D, floorTexture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    data = stbi_load("imagens/floor_texture.png", &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "Textura chao carregada!" << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura chao" << std::endl;
-    }
-    stbi_image_free(data);
-
-    // Carregar textura do portão (gate)
-    unsigned int gateTexture;
-    glGenTextures(1, &gateTexture);
-    glBindTexture(GL_TEXTURE_2D, gateTexture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    data = stbi_load("imagens/gate_texture.png", &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        std::cout << "Textura portao carregada!" << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura portao" << std::endl;
-    }
-    stbi_image_free(data);
+    // Os objetos com recursos OpenGL vivem neste bloco, para serem destruídos antes de glfwTerminate()
+    {
+        // Ritmo de frames: um limite explícito desliga o vsync e passa a esperar entre frames
+        FramePacer pacer(mode->refreshRate, frameLimit);
+        if (frameLimit > 0.0) pacer.setMode(FramePacer::LIMITED);
+        else if (vsyncOption == "off") pacer.setMode(FramePacer::UNCAPPED);
+        else if (vsyncOption == "adaptive") pacer.setMode(FramePacer::ADAPTIVE_VSYNC);
+        else pacer.setMode(FramePacer::VSYNC);
+        framePacer = &pacer;
+
+        // Resolução das passagens 3D: adaptada ao tempo de GPU do frame pretendido, ou fixa
+        RenderScale sceneScale;
+        if (scaleOption != "auto") {
+            sceneScale.setDynamic(false);
+            sceneScale.setScale((float)std::atof(scaleOption.c_str()));
+        }
+        sceneScale.setTarget((float)(pacer.targetFrameTime() * 1000.0));
+        renderScale = &sceneScale;
+
+        // Texturas: descodificadas em paralelo enquanto o labirinto carrega; até chegarem,
+        // são usados placeholders 1x1 (ver TextureLoader::update() no ciclo de render)
+        TextureLoader textureLoader;
+
+        // Texturas e shaders partilhados por caminho, recarregados quando os ficheiros mudam;
+        // os programas ligados ficam em cache (program binaries) para os arranques seguintes
+        ResourceManager resources(textureLoader);
+        resources.enableProgramBinaries((GLADloadproc)glfwGetProcAddress);
+
+        // Carregar shaders. Os uniformes do shader de iluminação que não mudam entre frames são
+        // definidos depois de cada ligação, para sobreviverem aos recarregamentos
+        Shader& lightingShader = resources.shader("shaders/2.1.basic_lighting.vs", "shaders/2.1.basic_lighting.fs", [](Shader& shader) {
+            // Constantes por frame num uniform buffer partilhado (projection, view, luz, lanterna)
+            shader.bindUniformBlock("FrameData", FrameUniforms::BINDING);
+            shader.use();
+            shader.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
+            shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+            shader.setInt("materialTextures", 0);
+            LightClusters::bindSamplers(shader);
+            shader.setInt("flashShadowMap", SpotShadowMap::UNIT);
+            shader.setMat4("model", glm::mat4(1.0f));
+        });
+        Shader& skyboxShader = resources.shader("shaders/skybox.vs", "shaders/skybox.fs");
+        Shader& overlayShader = resources.shader("shaders/overlay.vs", "shaders/overlay.fs");
+        Shader& shadowShader = resources.shader("shaders/shadow_depth.vs", "shaders/shadow_depth.fs");
+        std::cout << "Programas: " << resources.shaderCount() << " (" << resources.binaryLoads << " da cache binaria)" << std::endl;
+
+        // Perfilador: um timer de GPU por pass e relógios de CPU para entrada e simulação
+        Profiler frameProfiler;
+        skyboxSection = frameProfiler.addSection("Skybox", true, glm::vec3(0.4f, 0.6f, 1.0f));
+        shadowSection = frameProfiler.addSection("Sombras", true, glm::vec3(0.5f, 0.5f, 0.6f));
+        mazeSection = frameProfiler.addSection("Labirinto", true, glm::vec3(1.0f, 0.6f, 0.2f));
+        overlaySection = frameProfiler.addSection("Overlays", true, glm::vec3(0.8f, 0.4f, 1.0f));
+        inputSection = frameProfiler.addSection("Entrada", false, glm::vec3(0.9f, 0.9f, 0.3f));
+        simulationSection = frameProfiler.addSection("Simulacao", false, glm::vec3(0.3f, 0.9f, 0.8f));
+        collisionSection = frameProfiler.addSection("Colisoes", false, glm::vec3(1.0f, 0.3f, 0.4f));
+        lightsSection = frameProfiler.addSection("Luzes", false, glm::vec3(1.0f, 0.8f, 0.5f));
+        profiler = &frameProfiler;
+
+        // Imagens de ecrã inteiro: sem mipmaps e transparentes até estarem carregadas
+        TextureOptions overlayOptions;
+        overlayOptions.repeat = false;
+        overlayOptions.mipmaps = false;
+        overlayOptions.placeholder = glm::vec4(0.0f);
+        unsigned int controlsTexture = resources.texture2D("imagens/controlos.png", overlayOptions);
+        unsigned int victoryTexture = resources.texture2D("imagens/victory.png", overlayOptions);
+
+        // Configurar skybox
+        std::vector<std::string> faces {
+            "imagens/right.png",
+            "imagens/left.png",
+            "imagens/top.png",
+            "imagens/bottom.png",
+            "imagens/front.png",
+            "imagens/back.png"
+        };
+        Skybox skybox(faces, resources);
+
+        // Configurar labirinto (formato compacto de vértices: metade da largura de banda)
+        Maze maze("models/3d-model.obj", true);
+        maze.uploadToGPU();
+
+        // Materiais do labirinto: uma array de texturas indexada pelo material de cada vértice
+        // (camadas Maze::MATERIAL_WALL, _FLOOR, _GATE e depois as texturas do MTL)
+        std::vector<std::string> materialLayers {
+            "imagens/wall_texture.png",
+            "imagens/floor_texture.png",
+            "imagens/gate_texture.png"
+        };
+        materialLayers.insert(materialLayers.end(), maze.materialTextures.begin(), maze.materialTextures.end());
+        unsigned int materialTextures = resources.textureArray(materialLayers);
+
+        // Tochas ao longo dos corredores: luzes pontuais atribuídas por cluster em cada frame
+        const float TORCH_INTENSITY = 1.2f;
+        std::vector<PointLight> torches;
+        for (const glm::vec3& position : maze.torchPositions(maze.modelSize / 24.0f, 40.0f)) {
+            PointLight torch;
+            torch.position = position;
+            torch.radius = maze.modelSize / 20.0f;
+            torch.color = glm::vec3(1.0f, 0.6f, 0.25f);
+            torch.intensity = TORCH_INTENSITY;
+            torches.push_back(torch);
+        }
+        std::cout << "Tochas: " << torches.size() << std::endl;
+        LightClusters lightClusters;
+
+        // Objetos repetidos (suportes das tochas, marcadores de pista): uma draw call instanciada por tipo
+        PropRenderer props;
+        int torchProp = props.addCube();
+        int markerProp = props.addCube();
+        for (const PointLight& torch : torches) {
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), torch.position), glm::vec3(3.0f, 8.0f, 3.0f));
+            props.add(torchProp, model, (float)Maze::MATERIAL_GATE);
+        }
 
-    // Carregar textura dos controlos
-    unsigned int controlsTexture;
-    glGenTextures(1, &controlsTexture);
-    glBindTexture(GL_TEXTURE_2D, controlsTexture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    data = stbi_load("imagens/controlos.png", &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        std::cout << "Textura controlos carregada!" << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura controlos" << std::endl;
-    }
-    stbi_image_free(data);
+        // Grelha de navegação construída em background; as procuras de caminho também correm fora
+        // desta thread (validação da saída e pistas da tecla H)
+        PathFinder pathFinder(maze);
+        unsigned exitRequest = 0, hintRequest = 0;
+        float lastHintRequest = -HINT_INTERVAL;
 
-    // Carregar textura de vitoria
-    unsigned int victoryTexture;
-    glGenTextures(1, &victoryTexture);
-    glBindTexture(GL_TEXTURE_2D, victoryTexture);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    data = stbi_load("imagens/victory.png", &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        std::cout << "Textura vitoria carregada!" << std::endl;
-    } else {
-        std::cout << "Falha ao carregar textura vitoria" << std::endl;
-    }
-    stbi_image_free(data);
-
-    // Configurar skybox
-    std::vector<std::string> faces {
-        "imagens/right.png",
-        "imagens/left.png",
-        "imagens/top.png",
-        "imagens/bottom.png",
-        "imagens/front.png",
-        "imagens/back.png"
-    };
-    Skybox skybox(faces);
-    OverlayRenderer overlayRenderer;
-
-    // Mostrar controlos
-    std::cout << "\n========== CONTROLOS ==========" << std::endl;
-    std::cout << "W/A/S/D       - Mover (frente/esquerda/tras/direita)" << std::endl;
-    std::cout << "SHIFT         - Correr (2x velocidade)" << std::endl;
-    std::cout << "F             - Ligar/Desligar lanterna" << std::endl;
-    std::cout << "V             - Noclip (atravessar paredes)" << std::endl;
-    std::cout << "TAB           - Mostrar/Esconder controlos" << std::endl;
-    std::cout << "ESC           - Sair do jogo" << std::endl;
-    std::cout << "Mouse         - Olhar em volta" << std::endl;
-    std::cout << "==============================\n" << std::endl;
-
-    // Loop de renderização
-    while (!glfwWindowShouldClose(window))
-    {
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        // Sombras da lanterna: shadow map da geometria estática, refeito só quando a lanterna se move
+        SpotShadowMap flashShadow;
+        camera.Position = maze.startPosition;
+        SimulationState initialState;
+        initialState.position = initialState.previousPosition = maze.startPosition;
+        camera.MovementSpeed = maze.modelSize / 20.0f;
+        camera.MouseSensitivity = 0.005f;
+        // Depois da velocidade: os primeiros ticks usam a entrada publicada aqui
+        sharedInput.publish(processInput(nullptr, camera));
+
+        OverlayRenderer overlayRenderer;
+
+        // Constantes por frame num uniform buffer partilhado (ligado ao shader de iluminação na sua configuração)
+        FrameUniforms frameUniforms;
+
+        // Mostrar controlos
+        std::cout << "\n========== CONTROLOS ==========" << std::endl;
+        std::cout << "W/A/S/D       - Mover (frente/esquerda/tras/direita)" << std::endl;
+        std::cout << "SHIFT         - Correr (2x velocidade)" << std::endl;
+        std::cout << "F             - Ligar/Desligar lanterna" << std::endl;
+        std::cout << "O             - Ligar/Desligar occlusion culling" << std::endl;
+        std::cout << "L             - Ligar/Desligar niveis de detalhe (LOD)" << std::endl;
+        std::cout << "T             - Ligar/Desligar tochas" << std::endl;
+        std::cout << "H             - Mostrar/Esconder caminho ate a saida" << std::endl;
+        std::cout << "V             - Noclip (atravessar paredes)" << std::endl;
+        std::cout << "TAB           - Mostrar/Esconder controlos" << std::endl;
+        std::cout << "P             - Mostrar/Esconder perfilador" << std::endl;
+        std::cout << "F2            - Guardar perfil em profiler.csv" << std::endl;
+        std::cout << "F3            - Modo de frames (vsync/adaptativo/limite/sem limite)" << std::endl;
+        std::cout << "F4            - Ligar/Desligar resolucao dinamica" << std::endl;
+        std::cout << "ESC           - Sair do jogo" << std::endl;
+        std::cout << "Mouse         - Olhar em volta" << std::endl;
+        std::cout << "==============================\n" << std::endl;
+
+        // A física corre noutra thread; este ciclo só amostra a entrada e desenha.
+        // No replay, os ticks gravados correm aqui, REPLAY_TICKS_PER_FRAME por frame, e as medições
+        // só começam com tudo carregado (texturas e grelha de navegação), sem vsync e à escala fixa.
+        SimulationState replayState = initialState;
+        size_t replayTick = 0;
+        int replayFrame = 0;
+        std::thread simulationThread;
+        initialState.time = simulationClock();
+        sharedSimulation.publish(initialState);
+        if (replaying) {
+            textureLoader.finishAll();
+            while (!pathFinder.ready()) std::this_thread::yield();
+            pacer.setMode(FramePacer::UNCAPPED);
+            sceneScale.setDynamic(false);
+            profiler->startLog();
+            std::cout << "Replay: " << trace.ticks.size() << " ticks" << std::endl;
+        } else {
+            simulationRunning = true;
+            simulationThread = std::thread(simulationLoop, std::ref(maze), initialState);
+        }
 
-        // Ciclo dia/noite
-        lightIntensity -= 0.02f * (deltaTime / 2);
-        if (lightIntensity < 0.1f) lightIntensity = 0.1f;
+        // Loop de renderização
+        while (!glfwWindowShouldClose(window))
+        {
+            float currentFrame = replaying ? replayFrame++ * REPLAY_TICKS_PER_FRAME * SIM_TICK : (float)glfwGetTime();
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+            profiler->beginFrame();
+
+            // Texturas que terminaram de descodificar desde o último frame; shaders e texturas
+            // alterados no disco (fora do replay, para não perturbar as medições)
+            if (!replaying) resources.pollChanges();
+            textureLoader.update();
+
+            // Caminhos: a saída é validada uma vez quando a grelha fica pronta; as pistas são
+            // pedidas de HINT_INTERVAL em HINT_INTERVAL e usadas quando a procura termina
+            NavGrid::Path path;
+            if (pathFinder.ready() && exitRequest == 0) exitRequest = pathFinder.request(maze.startPosition, maze.exitPosition);
+            if (exitRequest && pathFinder.poll(exitRequest, path)) {
+                if (path.found) {
+                    std::cout << "Caminho ate a saida: " << path.length << " unidades" << std::endl;
+                } else {
+                    glm::vec3 farthest = pathFinder.grid().farthestFrom(maze.startPosition);
+                    std::cout << "Aviso: saida inalcancavel a partir do inicio (ponto mais distante alcancavel: "
+                              << farthest.x << " " << farthest.y << " " << farthest.z << ")" << std::endl;
+                }
+            }
+            if (hintOn && pathFinder.ready() && hintRequest == 0 && currentFrame - lastHintRequest >= HINT_INTERVAL) {
+                hintRequest = pathFinder.request(camera.Position, maze.exitPosition);
+                lastHintRequest = currentFrame;
+            }
+            if (hintRequest && pathFinder.poll(hintRequest, path)) {
+                props.clear(markerProp);
+                if (hintOn && path.found) {
+                    for (const glm::vec3& marker : NavGrid::samplePath(path.points, HINT_SPACING, HINT_MARKERS)) {
+                        glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), marker + glm::vec3(0.0f, 20.0f, 0.0f)), glm::vec3(4.0f));
+                        props.add(markerProp, model, (float)Maze::MATERIAL_GATE);
+                    }
+                }
+                hintRequest = 0;
+            }
+            if (!hintOn) props.clear(markerProp);
+
+            // Entrada para os próximos ticks; estado mais recente da simulação para este frame
+            if (replaying) {
+                if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
+                for (int k = 0; k < REPLAY_TICKS_PER_FRAME && replayTick < trace.ticks.size(); k++) {
+                    PlayerInput input = fromTraceTick(trace.ticks[replayTick++]);
+                    simulationTick(replayState, input, SIM_TICK, maze);
+                    replayState.time += SIM_TICK;
+
+                    // Vista e alternâncias de render tal como estavam na gravação
+                    camera.Yaw = input.yaw;
+                    camera.Pitch = input.pitch;
+                    camera.ProcessMouseMovement(0.0f, 0.0f);
+                    noclip = input.noclip;
+                    flashLightOn = (input.toggles & InputTrace::FLASHLIGHT) != 0;
+                    occlusionCulling = (input.toggles & InputTrace::OCCLUSION) != 0;
+                    lodEnabled = (input.toggles & InputTrace::LOD) != 0;
+                    torchesOn = (input.toggles & InputTrace::TORCHES) != 0;
+                    hintOn = (input.toggles & InputTrace::HINTS) != 0;
+                }
+                sharedSimulation.publish(replayState);
+                if (replayTick == trace.ticks.size()) glfwSetWindowShouldClose(window, true);
+            } else {
+                Profiler::CpuScope scope(*profiler, inputSection);
+                sharedInput.publish(processInput(window, camera));
+            }
+            SimulationState sim = sharedSimulation.read();
+            float lightIntensity = sim.lightIntensity;
 
-        processInput(window, camera, deltaTime, maze);
+            // Posição mostrada: interpolada entre os dois últimos ticks publicados (no replay, o último)
+            float alpha = replaying ? 1.0f : glm::clamp((float)((simulationClock() - sim.time) / SIM_TICK), 0.0f, 1.0f);
+            camera.Position = glm::mix(sim.previousPosition, sim.position, alpha);
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            // Passagens 3D à resolução de render (framebuffer fora do ecrã), ampliadas antes dos overlays
+            int scrWidth, scrHeight;
+            glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
+            sceneScale.begin(scrWidth, scrHeight);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Desenhar skybox
-        int scrWidth, scrHeight;
-        glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)scrWidth / (float)scrHeight, 0.1f, 5000.0f);
+            // Desenhar skybox
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)scrWidth / (float)scrHeight, Z_NEAR, Z_FAR);
         
-        skybox.draw(skyboxShader, camera.GetViewMatrix(), projection, lightIntensity);
-
-        // Desenhar labirinto
-        lightingShader.use();
-        lightingShader.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
-        lightingShader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
-        lightingShader.setFloat("lightIntensity", lightIntensity);
-        lightingShader.setVec3("topLightPos", topLightPos);
+            profiler->beginGpu(skyboxSection);
+            skybox.draw(skyboxShader, camera.GetViewMatrix(), projection, lightIntensity);
+            profiler->endGpu(skyboxSection);
+
+            // Constantes do frame: um único envio para o uniform buffer
+            glm::mat4 view = camera.GetViewMatrix();
+            FrameData frameData;
+            frameData.projection = projection;
+            frameData.view = view;
+            frameData.viewPos = glm::vec4(camera.Position, 1.0f);
+            // Lanterna na mão: ligeiramente à direita e abaixo dos olhos, para que as sombras se vejam
+            glm::vec3 flashLightPos = camera.Position + camera.Right * 8.0f - camera.Up * 6.0f;
+            frameData.flashLightPos = glm::vec4(flashLightPos, 1.0f);
+            frameData.flashLightDir = glm::vec4(camera.Front, 0.0f);
+            frameData.topLightPos = glm::vec4(topLightPos, 1.0f);
+            frameData.lightIntensity = lightIntensity;
+            frameData.flashLightCutoff = glm::cos(glm::radians(FLASHLIGHT_INNER_ANGLE));
+            frameData.flashLightOuterCutoff = glm::cos(glm::radians(FLASHLIGHT_OUTER_ANGLE));
+            frameData.flashLightOn = flashLightOn ? 1 : 0;
+            // Níveis de detalhe antes de qualquer passagem, para a sombra e a vista usarem os mesmos
+            maze.selectLod(camera.Position, lodEnabled);
+            if (flashLightOn) {
+                profiler->beginGpu(shadowSection);
+                flashShadow.update(maze, shadowShader, flashLightPos, camera.Front, 2.0f * FLASHLIGHT_OUTER_ANGLE + 5.0f);
+                profiler->endGpu(shadowSection);
+            }
+            frameData.flashLightSpace = flashShadow.lightSpace();
+            frameData.flashShadowParams = glm::vec4(flashLightOn && flashShadow.ready() ? 1.0f : 0.0f,
+                                                    flashShadow.texelSize(), flashShadow.normalOffsetPerUnit(), 0.0f);
+            if (torchesOn) {
+                Profiler::CpuScope scope(*profiler, lightsSection);
+                // Cintilação ligeira, desfasada entre tochas
+                for (size_t i = 0; i < torches.size(); i++) {
+                    torches[i].intensity = TORCH_INTENSITY * (0.85f + 0.15f * std::sin(currentFrame * 9.0f + i * 1.7f));
+                }
+                lightClusters.update(torches, view, projection, Z_NEAR, Z_FAR, sceneScale.width(), sceneScale.height());
+            }
+            lightClusters.apply(frameData, torchesOn);
+            frameUniforms.update(frameData);
+
+            // Desenhar labirinto
+            lightingShader.use();
         
-        // Ativar texturas
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, wallTexture);
-        lightingShader.setInt("wallTexture", 0);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, floorTexture);
-        lightingShader.setInt("floorTexture", 1);
-
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gateTexture);
-        lightingShader.setInt("gateTexture", 2);
-
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        lightingShader.setMat4("projection", projection);
-        lightingShader.setMat4("view", view);
-        lightingShader.setMat4("model", model);
-
-        lightingShader.setVec3("viewPos", camera.Position);
-        lightingShader.setVec3("flashLightDir", camera.Front);
-        lightingShader.setFloat("flashLightCutoff", glm::cos(glm::radians(12.5f)));
-        lightingShader.setFloat("flashLightOuterCutoff", glm::cos(glm::radians(17.5f)));
-        lightingShader.setBool("flashLightOn", flashLightOn);
-
-        // Desenhar Labirinto (Tipo 0)
-        lightingShader.setInt("objectType", 0);
-        maze.draw(lightingShader);
-
-        // Desenhar Saida (Tipo 1)
-        lightingShader.setInt("objectType", 1);
-        // maze.drawExit(lightingShader);
-
-        // Ecrã de vitória
-        if (victoryAchieved) {
-            victoryTime += deltaTime;
+            // Todos os materiais estão na mesma array de texturas
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, materialTextures);
+            lightClusters.bind();
+            flashShadow.bind();
+
+            // Desenhar labirinto, apenas os chunks dentro do frustum da câmara
+            Frustum frustum(projection * view);
+            profiler->beginGpu(mazeSection);
+            if (occlusionCulling) {
+                maze.drawOcclusionCulled(lightingShader, frustum, camera.Position);
+            } else {
+                maze.draw(lightingShader, frustum);
+            }
+
+            // Objetos instanciados, descartados pelo mesmo frustum
+            props.draw(lightingShader, frustum);
+            profiler->endGpu(mazeSection);
+
+            // Ecrã de vitória
+            profiler->beginGpu(overlaySection);
+            sceneScale.resolve();
+            if (sim.victoryAchieved) {
+                victoryTime += deltaTime;
             
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDisable(GL_DEPTH_TEST);
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDisable(GL_DEPTH_TEST);
             
-            // Usar a imagem de vitoria em vez de apenas cor
-            overlayRenderer.renderImageOverlay(overlayShader, victoryTexture, (float)scrWidth, (float)scrHeight);
+                // Usar a imagem de vitoria em vez de apenas cor
+                overlayRenderer.renderImageOverlay(overlayShader, victoryTexture, (float)scrWidth, (float)scrHeight);
              
-            glEnable(GL_DEPTH_TEST);
-            glDisable(GL_BLEND);
-        }
+                glEnable(GL_DEPTH_TEST);
+                glDisable(GL_BLEND);
+            }
 
-        // Mostrar controlos (TAB)
-        if (showControls) {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glDisable(GL_DEPTH_TEST);
+            // Mostrar controlos (TAB)
+            if (showControls) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDisable(GL_DEPTH_TEST);
             
-            overlayRenderer.renderImageOverlay(overlayShader, controlsTexture, (float)scrWidth, (float)scrHeight);
+                overlayRenderer.renderImageOverlay(overlayShader, controlsTexture, (float)scrWidth, (float)scrHeight);
             
-            glEnable(GL_DEPTH_TEST);
-            glDisable(GL_BLEND);
+                glEnable(GL_DEPTH_TEST);
+                glDisable(GL_BLEND);
+            }
+            profiler->endGpu(overlaySection);
+
+            // HUD do perfilador (P), fora das queries para não se medir a si próprio
+            if (showProfiler) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDisable(GL_DEPTH_TEST);
+
+                profiler->drawHud(overlayRenderer, overlayShader, (float)scrWidth, (float)scrHeight);
+
+                glEnable(GL_DEPTH_TEST);
+                glDisable(GL_BLEND);
+
+                // Resumo na consola uma vez por segundo
+                static float lastPrint = 0.0f;
+                if (currentFrame - lastPrint >= 1.0f) {
+                    profiler->printStats();
+                    std::cout << "[frames] " << FramePacer::modeName(pacer.mode()) << ", escala " << sceneScale.scale()
+                              << (sceneScale.isDynamic() ? " (dinamica)" : " (fixa)") << ", GPU 3D " << sceneScale.gpuMs()
+                              << " / " << sceneScale.target() << " ms" << std::endl;
+                    lastPrint = currentFrame;
+                }
+            }
+
+            profiler->endFrame();
+            glfwSwapBuffers(window);
+            // Em LIMITED, espera aqui para que os eventos e a entrada sejam lidos logo antes do próximo frame
+            pacer.wait();
+            glfwPollEvents();
         }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        simulationRunning = false;
+        if (simulationThread.joinable()) simulationThread.join();
+
+        if (inputRecording) {
+            if (trace.save(recordPath)) {
+                std::cout << "Gravacao: " << trace.ticks.size() << " ticks em " << recordPath << std::endl;
+            } else {
+                std::cout << "Erro ao guardar " << recordPath << std::endl;
+            }
+            inputRecording = nullptr;
+        }
+        if (replaying) {
+            // A posição final confirma que as duas builds fizeram o mesmo percurso
+            std::ofstream summary(reportPrefix + ".txt");
+            for (std::ostream *out : { (std::ostream *)&std::cout, (std::ostream *)&summary }) {
+                *out << "Replay " << replayPath << ": " << replayTick << "/" << trace.ticks.size() << " ticks, posicao final "
+                     << replayState.position.x << " " << replayState.position.y << " " << replayState.position.z << "\n";
+                profiler->writeSummary(*out);
+            }
+            if (!profiler->writeLogCsv(reportPrefix + ".csv") || !summary) {
+                std::cout << "Erro ao escrever o relatorio " << reportPrefix << ".csv/.txt" << std::endl;
+            }
+        }
+        profiler = nullptr;
+        framePacer = nullptr;
+        renderScale = nullptr;
+        maze.releaseGPU();
+        resources.releaseAll();
     }
 
     glfwTerminate();
     return 0;
 }
 
-void processInput(GLFWwindow *window, Camera &camera, float deltaTime, Maze &maze)
+PlayerInput processInput(GLFWwindow *window, const Camera &camera)
 {
+    PlayerInput input;
+    input.front = camera.Front;
+    input.rightDir = camera.Right;
+    input.speed = camera.MovementSpeed;
+    input.yaw = camera.Yaw;
+    input.pitch = camera.Pitch;
+    if (!window) return input;
+
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
@@ -417,6 +755,54 @@ void processInput(GLFWwindow *window, Camera &camera, float deltaTime, Maze &maz
         fPressed = false;
     }
 
+    // Tochas (T)
+    static bool tPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS) {
+        if (!tPressed) {
+            torchesOn = !torchesOn;
+            std::cout << "Tochas: " << (torchesOn ? "LIGADAS" : "DESLIGADAS") << std::endl;
+            tPressed = true;
+        }
+    } else {
+        tPressed = false;
+    }
+
+    // Pistas do caminho até à saída (H)
+    static bool hPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (!hPressed) {
+            hintOn = !hintOn;
+            std::cout << "Pistas: " << (hintOn ? "LIGADAS" : "DESLIGADAS") << std::endl;
+            hPressed = true;
+        }
+    } else {
+        hPressed = false;
+    }
+
+    // Occlusion culling (O)
+    static bool oPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) {
+        if (!oPressed) {
+            occlusionCulling = !occlusionCulling;
+            std::cout << "Occlusion culling: " << (occlusionCulling ? "LIGADO" : "DESLIGADO") << std::endl;
+            oPressed = true;
+        }
+    } else {
+        oPressed = false;
+    }
+
+    // Níveis de detalhe (L)
+    static bool lPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (!lPressed) {
+            lodEnabled = !lodEnabled;
+            std::cout << "LOD: " << (lodEnabled ? "LIGADO" : "DESLIGADO") << std::endl;
+            lPressed = true;
+        }
+    } else {
+        lPressed = false;
+    }
+
     // Mostrar controlos (TAB)
     static bool tabPressed = false;
     if (glfwGetKey(window, GLFW_KEY_TAB) == GLFW_PRESS) {
@@ -428,6 +814,57 @@ void processInput(GLFWwindow *window, Camera &camera, float deltaTime, Maze &maz
         tabPressed = false;
     }
 
+    // Perfilador (P) e exportação do histórico (F2)
+    static bool pPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) {
+        if (!pPressed) {
+            showProfiler = !showProfiler;
+            pPressed = true;
+        }
+    } else {
+        pPressed = false;
+    }
+
+    static bool f2Pressed = false;
+    if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS) {
+        if (!f2Pressed) {
+            if (profiler && profiler->writeCsv("profiler.csv")) {
+                std::cout << "Perfil guardado em profiler.csv" << std::endl;
+            } else {
+                std::cout << "Erro ao guardar profiler.csv" << std::endl;
+            }
+            f2Pressed = true;
+        }
+    } else {
+        f2Pressed = false;
+    }
+
+    // Modo de frames (F3): o orçamento da resolução dinâmica segue o tempo de frame do modo
+    static bool f3Pressed = false;
+    if (glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS) {
+        if (!f3Pressed && framePacer) {
+            framePacer->nextMode();
+            if (renderScale) renderScale->setTarget((float)(framePacer->targetFrameTime() * 1000.0));
+            std::cout << "Frames: " << FramePacer::modeName(framePacer->mode()) << std::endl;
+        }
+        f3Pressed = true;
+    } else {
+        f3Pressed = false;
+    }
+
+    // Resolução dinâmica (F4)
+    static bool f4Pressed = false;
+    if (glfwGetKey(window, GLFW_KEY_F4) == GLFW_PRESS) {
+        if (!f4Pressed && renderScale) {
+            renderScale->setDynamic(!renderScale->isDynamic());
+            std::cout << "Resolucao dinamica: " << (renderScale->isDynamic() ? "LIGADA" : "DESLIGADA")
+                      << " (escala " << renderScale->scale() << ")" << std::endl;
+        }
+        f4Pressed = true;
+    } else {
+        f4Pressed = false;
+    }
+
     // Fullscreen (F11)
     static bool f11Pressed = false;
     if (glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS) {
@@ -450,95 +887,157 @@ void processInput(GLFWwindow *window, Camera &camera, float deltaTime, Maze &maz
         f11Pressed = false;
     }
 
+    // Movimento: amostrado aqui, aplicado nos ticks da thread de simulação
+    input.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+    input.back = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+    input.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+    input.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+    input.sprint = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+    input.noclip = noclip;
+    input.toggles = (flashLightOn ? InputTrace::FLASHLIGHT : 0) | (occlusionCulling ? InputTrace::OCCLUSION : 0) |
+                    (lodEnabled ? InputTrace::LOD : 0) | (torchesOn ? InputTrace::TORCHES : 0) | (hintOn ? InputTrace::HINTS : 0);
+    return input;
+}
 
+void simulationTick(SimulationState &state, const PlayerInput &input, float dt, Maze &maze)
+{
+    Profiler::CpuScope tickScope(*profiler, simulationSection);
+    state.previousPosition = state.position;
 
-    // Sprint (Shift)
-    float originalSpeed = camera.MovementSpeed;
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-        camera.MovementSpeed *= 1.5f;
-    }
+    // Ciclo dia/noite
+    state.lightIntensity -= 0.02f * (dt / 2);
+    if (state.lightIntensity < 0.1f) state.lightIntensity = 0.1f;
 
-    // Sub-steps de física
-    int steps = 4; // Reduzido de 8 para 4 para melhor performance
-    float subDeltaTime = deltaTime / steps;
-    
-    // Cache da altura inicial para evitar chamadas redundantes (Otimizacao)
-    float currentFloorHeight = -99999.0f;
-    if (!noclip) {
-        currentFloorHeight = maze.getFloorHeight(camera.Position);
-        if (currentFloorHeight < -90000.0f) currentFloorHeight = camera.Position.y - 50.0f;
-    }
-
-    for (int i = 0; i < steps; i++) {
-        glm::vec3 stepOldPosition = camera.Position;
-        float oldFloorHeight = currentFloorHeight;
-        
-        // Movimento WASD
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            camera.ProcessKeyboard(0, subDeltaTime);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            camera.ProcessKeyboard(1, subDeltaTime);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            camera.ProcessKeyboard(2, subDeltaTime);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            camera.ProcessKeyboard(3, subDeltaTime);
-            
-        // Logica de colisao e chao
-        if (!noclip) {
-            // 1. Parede
-            if (maze.checkWallCollision(camera.Position, 5.0f)) {
-                camera.Position = stepOldPosition;
+    // Sprint (Shift)
+    float velocity = input.speed * (input.sprint ? 1.5f : 1.0f) * dt;
+
+    // Deslocamento pedido neste tick (WASD)
+    glm::vec3 oldPosition = state.position;
+    glm::vec3 movement(0.0f);
+    if (input.forward) movement += input.front * velocity;
+    if (input.back) movement -= input.front * velocity;
+    if (input.left) movement -= input.rightDir * velocity;
+    if (input.right) movement += input.rightDir * velocity;
+    state.position += movement;
+
+    // Logica de colisao e chao
+    if (!input.noclip) {
+        Profiler::CpuScope collisionScope(*profiler, collisionSection);
+        float oldFloorHeight = maze.getFloorHeight(oldPosition);
+        if (oldFloorHeight < -90000.0f) oldFloorHeight = oldPosition.y - 50.0f;
+
+        // 1. Parede: varrimento contínuo com deslizamento
+        state.position = maze.moveAndSlide(oldPosition, movement, 5.0f);
+
+        // 2. Chao na posição final
+        float newFloorHeight = maze.getFloorHeight(state.position);
+
+        // Se chao invalido (buraco/void)
+        if (newFloorHeight < -90000.0f) {
+            state.position = oldPosition;
+        } else {
+            float heightDiff = newFloorHeight - oldFloorHeight;
+
+            if (heightDiff > Maze::MAX_STEP_HEIGHT) {
+                // Degrau muito alto
+                state.position.x = oldPosition.x;
+                state.position.z = oldPosition.z;
             } else {
-                // 2. Chao (So calcula se nao bateu na parede)
-                float newFloorHeight = maze.getFloorHeight(camera.Position);
-                
-                // Se chao invalido (buraco/void)
-                if (newFloorHeight < -90000.0f) {
-                     camera.Position = stepOldPosition;
-                } else {
-                    const float MAX_STEP_HEIGHT = 15.0f;
-                    float heightDiff = newFloorHeight - oldFloorHeight;
-                    
-                    if (heightDiff > MAX_STEP_HEIGHT) {
-                        // Degrau muito alto
-                        camera.Position.x = stepOldPosition.x;
-                        camera.Position.z = stepOldPosition.z;
-                    } else {
-                        // Valido
-                        camera.Position.y = newFloorHeight + 50.0f;
-                        currentFloorHeight = newFloorHeight;
-                    }
-                }
+                // Valido
+                state.position.y = newFloorHeight + 50.0f;
             }
         }
     }
 
-    camera.MovementSpeed = originalSpeed;
-    
     // À prova de falhas: Se o jogador cair do mapa, reiniciar no início
-    if (camera.Position.y < -300.0f) {
+    if (state.position.y < -300.0f) {
         std::cout << "Failsafe ativado! A reiniciar jogador." << std::endl;
-        camera.Position = maze.startPosition;
-        camera.Position.y += 50.0f;
+        state.position = maze.startPosition;
+        state.position.y += 50.0f;
+        state.previousPosition = state.position;
     }
 
     // Verificar chegada ao portão
-    if (!victoryAchieved) {
-        glm::vec2 cameraPos2D(camera.Position.x, camera.Position.z);
+    if (!state.victoryAchieved) {
+        glm::vec2 cameraPos2D(state.position.x, state.position.z);
         glm::vec2 exitPos2D(maze.exitPosition.x, maze.exitPosition.z);
         if (glm::distance(cameraPos2D, exitPos2D) < 50.0f) {
             std::cout << "========================================" << std::endl;
             std::cout << "   PARABENS! CHEGASTE AO PORTAO!" << std::endl;
             std::cout << "   Pressiona ESC para sair" << std::endl;
             std::cout << "========================================" << std::endl;
-            victoryAchieved = true;
-            victoryTime = 0.0f;
+            state.victoryAchieved = true;
         }
     }
 }
 
+void simulationLoop(Maze &maze, SimulationState state)
+{
+    while (simulationRunning) {
+        // Ticks em atraso segundo o relógio (limitados, como num frame lento)
+        double now = simulationClock();
+        int ticks = 0;
+        while (state.time + SIM_TICK <= now && ticks < MAX_TICKS_PER_FRAME) {
+            PlayerInput input = sharedInput.read();
+            if (inputRecording) inputRecording->ticks.push_back(toTraceTick(input));
+            simulationTick(state, input, SIM_TICK, maze);
+            state.time += SIM_TICK;
+            ticks++;
+        }
+        if (state.time + SIM_TICK <= now) state.time = now;
+        if (ticks > 0) sharedSimulation.publish(state);
+
+        // Dormir até ao próximo tick
+        double wait = state.time + SIM_TICK - simulationClock();
+        if (wait > 0.0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
+}
+
+double simulationClock()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+InputTrace::Tick toTraceTick(const PlayerInput &input)
+{
+    InputTrace::Tick tick;
+    tick.flags = input.toggles | (input.forward ? InputTrace::KEY_FORWARD : 0) | (input.back ? InputTrace::KEY_BACK : 0) |
+                 (input.left ? InputTrace::KEY_LEFT : 0) | (input.right ? InputTrace::KEY_RIGHT : 0) |
+                 (input.sprint ? InputTrace::KEY_SPRINT : 0) | (input.noclip ? InputTrace::NOCLIP : 0);
+    for (int k = 0; k < 3; k++) {
+        tick.front[k] = input.front[k];
+        tick.right[k] = input.rightDir[k];
+    }
+    tick.speed = input.speed;
+    tick.yaw = input.yaw;
+    tick.pitch = input.pitch;
+    return tick;
+}
+
+PlayerInput fromTraceTick(const InputTrace::Tick &tick)
+{
+    const uint32_t KEYS = InputTrace::KEY_FORWARD | InputTrace::KEY_BACK | InputTrace::KEY_LEFT |
+                          InputTrace::KEY_RIGHT | InputTrace::KEY_SPRINT | InputTrace::NOCLIP;
+    PlayerInput input;
+    input.forward = (tick.flags & InputTrace::KEY_FORWARD) != 0;
+    input.back = (tick.flags & InputTrace::KEY_BACK) != 0;
+    input.left = (tick.flags & InputTrace::KEY_LEFT) != 0;
+    input.right = (tick.flags & InputTrace::KEY_RIGHT) != 0;
+    input.sprint = (tick.flags & InputTrace::KEY_SPRINT) != 0;
+    input.noclip = (tick.flags & InputTrace::NOCLIP) != 0;
+    input.front = glm::vec3(tick.front[0], tick.front[1], tick.front[2]);
+    input.rightDir = glm::vec3(tick.right[0], tick.right[1], tick.right[2]);
+    input.speed = tick.speed;
+    input.yaw = tick.yaw;
+    input.pitch = tick.pitch;
+    input.toggles = tick.flags & ~KEYS;
+    return input;
+}
+
 void mouse_callback(GLFWwindow *window, double xpos, double ypos)
 {
+    if (replaying) return;
     if (firstMouse) {
         lastX = xpos;
         lastY = ypos;
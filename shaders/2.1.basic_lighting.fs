@@ -4,41 +4,62 @@ out vec4 FragColor;
 in vec3 Normal;  
 in vec3 FragPos;  
 in vec2 TexCoords;
+flat in float Material;
 
 uniform vec3 lightPos; 
 uniform vec3 lightColor;
-uniform float lightIntensity; 
-uniform vec3 topLightPos; 
 uniform vec3 objectColor;
-uniform sampler2D wallTexture;
-uniform sampler2D floorTexture;
-uniform sampler2D gateTexture;
-uniform int objectType; // 0 = Labirinto, 1 = Portão
+uniform sampler2DArray materialTextures;  // Uma camada por material (parede, chão, portão, MTL)
 
-// Uniformes da Lanterna
-uniform vec3 viewPos;
-uniform vec3 flashLightDir;
-uniform float flashLightCutoff;
-uniform float flashLightOuterCutoff;
-uniform bool flashLightOn;
+// Luzes pontuais por cluster (LightClusters.h)
+uniform samplerBuffer lightData;        // 2 texels por luz: (posição, raio), (cor, 0)
+uniform isamplerBuffer clusterRanges;   // (offset, count) por cluster
+uniform isamplerBuffer clusterLights;   // Índices de luz agrupados por cluster
+
+uniform sampler2DShadow flashShadowMap; // Profundidade vista da lanterna (SpotShadowMap.h)
+
+// Constantes do frame, incluindo a lanterna (FrameUniforms.h), partilhadas com o vertex shader
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 flashLightSpace;
+    vec4 viewPos;
+    vec4 flashLightPos;
+    vec4 flashLightDir;
+    vec4 topLightPos;
+    float lightIntensity;
+    float flashLightCutoff;
+    float flashLightOuterCutoff;
+    bool flashLightOn;
+    vec4 clusterScale;
+    ivec4 clusterGrid;
+    vec4 flashShadowParams;
+};
+
+// Visibilidade da lanterna (0 = na sombra, 1 = iluminado), com PCF de 4 amostras bilineares
+float flashShadow(vec3 facingNorm, float lightDistance)
+{
+    if (flashShadowParams.x == 0.0) return 1.0;
+    // Deslocar ao longo da normal evita acne; o texel cresce com a distância à lanterna
+    vec3 offsetPos = FragPos + facingNorm * (flashShadowParams.z * lightDistance);
+    vec4 clip = flashLightSpace * vec4(offsetPos, 1.0);
+    vec3 coord = clip.xyz / clip.w * 0.5 + 0.5;
+    if (clip.w <= 0.0 || coord.z > 1.0) return 1.0;
+
+    float texel = flashShadowParams.y;
+    float visibility = 0.0;
+    visibility += texture(flashShadowMap, vec3(coord.xy + vec2(-0.5, -0.5) * texel, coord.z));
+    visibility += texture(flashShadowMap, vec3(coord.xy + vec2( 0.5, -0.5) * texel, coord.z));
+    visibility += texture(flashShadowMap, vec3(coord.xy + vec2(-0.5,  0.5) * texel, coord.z));
+    visibility += texture(flashShadowMap, vec3(coord.xy + vec2( 0.5,  0.5) * texel, coord.z));
+    return visibility * 0.25;
+}
 
 void main(){
     vec3 topLightColor = vec3(1.0, 1.0, 0.8);
 
-    // Cor inicial da textura
-    vec3 texColor;
-    
-    if (objectType == 1) {
-        // Portão
-        texColor = texture(gateTexture, TexCoords).rgb;
-    } else {
-        // Labirinto (Paredes/Chão)
-        if (Normal.y > 0.5) {
-            texColor = texture(floorTexture, TexCoords).rgb;
-        } else {
-            texColor = texture(wallTexture, TexCoords).rgb;
-        }
-    }
+    // Cor da textura do material do vértice (sem ramos por tipo de objeto)
+    vec3 texColor = texture(materialTextures, vec3(TexCoords, Material)).rgb;
     
     // Ambiente (aumentado para depuração de paredes escuras)
     float ambientStrength = 0.1;
@@ -46,32 +67,54 @@ void main(){
 
     // Difusa (Luz Superior) - usando abs() para funcionar com normais invertidas
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(topLightPos - FragPos);
+    // A normal da face segue o sentido dos vértices: virada para o lado visível da superfície
+    vec3 facingNorm = gl_FrontFacing ? norm : -norm;
+    vec3 lightDir = normalize(topLightPos.xyz - FragPos);
     float diff = abs(dot(norm, lightDir));
     vec3 diffuse = diff * topLightColor * lightIntensity;
 
     // Lanterna (Spotlight)
     vec3 flashlight = vec3(0.0);
     if(flashLightOn) {
-        // Direção do fragmento para a câmara (fonte de luz)
-        vec3 lightDirFlash = normalize(viewPos - FragPos);
+        // Direção do fragmento para a lanterna (na mão do jogador)
+        vec3 toFlash = flashLightPos.xyz - FragPos;
+        vec3 lightDirFlash = normalize(toFlash);
         
         // Verificação do cone da spotlight (usando -flashLightDir como estava a funcionar antes)
-        float theta = dot(lightDirFlash, normalize(-flashLightDir));
+        float theta = dot(lightDirFlash, normalize(-flashLightDir.xyz));
         
         // Suavização nas bordas do cone
         float epsilon = flashLightCutoff - flashLightOuterCutoff;
         float intensity = clamp((theta - flashLightOuterCutoff) / epsilon, 0.0, 1.0);
         
         if(theta > flashLightOuterCutoff) {
-            // Usar abs() para fazer a luz funcionar em ambos os lados das superfícies (corrige normais invertidas)
-            float diffFlash = abs(dot(norm, lightDirFlash));
-            flashlight = vec3(1.0, 1.0, 1.0) * diffFlash * intensity * 2.0;
+            // Só o lado virado para a lanterna é iluminado, e só se nada a tapar
+            float diffFlash = max(dot(facingNorm, lightDirFlash), 0.0);
+            flashlight = vec3(1.0, 1.0, 1.0) * diffFlash * intensity * 2.0 * flashShadow(facingNorm, length(toFlash));
+        }
+    }
+
+    // Luzes pontuais (tochas): só as do cluster deste fragmento
+    vec3 pointLights = vec3(0.0);
+    if (clusterGrid.w != 0) {
+        float depth = -(view * vec4(FragPos, 1.0)).z;
+        ivec3 cell = ivec3(vec3(gl_FragCoord.xy * clusterScale.xy, log(max(depth, 1e-4)) * clusterScale.z + clusterScale.w));
+        cell = clamp(cell, ivec3(0), clusterGrid.xyz - 1);
+        int cluster = (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+        ivec2 range = texelFetch(clusterRanges, cluster).xy;
+        for (int i = 0; i < range.y; i++) {
+            int light = texelFetch(clusterLights, range.x + i).x;
+            vec4 positionRadius = texelFetch(lightData, light * 2);
+            vec3 toLight = positionRadius.xyz - FragPos;
+            float distanceRatio = length(toLight) / positionRadius.w;
+            float falloff = clamp(1.0 - distanceRatio * distanceRatio, 0.0, 1.0);
+            float diffLight = max(dot(facingNorm, normalize(toLight)), 0.0);
+            pointLights += texelFetch(lightData, light * 2 + 1).rgb * diffLight * falloff * falloff;
         }
     }
 
     // Multiplicar iluminação com cor da textura
     // Usar texColor diretamente dá melhor visibilidade da textura
-    vec3 result = (ambient + diffuse + flashlight) * texColor;
+    vec3 result = (ambient + diffuse + flashlight + pointLights) * texColor;
     FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -2,20 +2,49 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in float aMaterial;   // Camada da array de texturas (Maze::Material)
+layout (location = 4) in mat4 aInstanceModel;   // Matriz por instância (PropRenderer.h), locations 4-7
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+flat out float Material;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform bool instanced = false;     // true: usar aInstanceModel em vez de model
+
+// Constantes do frame (FrameUniforms.h), partilhadas com o fragment shader
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    mat4 flashLightSpace;
+    vec4 viewPos;
+    vec4 flashLightPos;
+    vec4 flashLightDir;
+    vec4 topLightPos;
+    float lightIntensity;
+    float flashLightCutoff;
+    float flashLightOuterCutoff;
+    bool flashLightOn;
+    vec4 clusterScale;
+    ivec4 clusterGrid;
+    vec4 flashShadowParams;
+};
+
+// Desquantização do formato compacto de vértices (identidade para vértices em float)
+uniform vec3 posOffset = vec3(0.0);
+uniform vec3 posScale = vec3(1.0);
+uniform vec2 uvOffset = vec2(0.0);
+uniform vec2 uvScale = vec2(1.0);
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
-    TexCoords = aTexCoords;
+    mat4 world = instanced ? aInstanceModel : model;
+    vec3 position = posOffset + aPos * posScale;
+    FragPos = vec3(world * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(world))) * aNormal;  
+    TexCoords = uvOffset + aTexCoords * uvScale;
+    Material = aMaterial;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
@@ -23,6 +23,9 @@ void main()
         
         // Usar alpha da textura original
         FragColor = vec4(finalColor, texColor.a * alpha);
+    } else if (useTexture == 2) {
+        // Modo cor sólida (HUD do perfilador)
+        FragColor = vec4(overlayColor, alpha);
     } else {
         // Modo overlay animado (vitória)
         // Criar efeito de vinheta - mais escuro nas bordas, mais brilhante no centro
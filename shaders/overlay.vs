@@ -5,9 +5,10 @@ layout (location = 1) in vec2 aTexCoord;
 out vec2 TexCoord;
 
 uniform vec2 scale;
+uniform vec2 offset;    // Centro do quad em NDC (0 = centro do ecrã)
 
 void main()
 {
-    gl_Position = vec4(aPos.x * scale.x, aPos.y * scale.y, 0.0, 1.0);
+    gl_Position = vec4(aPos.x * scale.x + offset.x, aPos.y * scale.y + offset.y, 0.0, 1.0);
     TexCoord = aTexCoord;
 }
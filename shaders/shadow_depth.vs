@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 lightSpace;    // projection * view da lanterna (SpotShadowMap.h)
+
+// Desquantização do formato compacto de vértices (identidade para vértices em float)
+uniform vec3 posOffset = vec3(0.0);
+uniform vec3 posScale = vec3(1.0);
+
+void main()
+{
+    gl_Position = lightSpace * vec4(posOffset + aPos * posScale, 1.0);
+}
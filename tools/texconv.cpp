@@ -0,0 +1,321 @@
+/**
+ * @file texconv.cpp
+ * @brief Conversor offline de PNG para KTX2 comprimido (BC1/BC3) com a cadeia de mipmaps completa.
+ *
+ * Gera, ao lado de cada imagem, um .ktx2 que o TextureLoader usa em vez do PNG (ver
+ * CompressedTexture.h). Os mipmaps são reduzidos com um filtro de caixa 2x2, como o
+ * glGenerateMipmap que deixam de precisar, e cada bloco 4x4 é codificado com os extremos
+ * da caixa envolvente das cores (ligeiramente recolhida) e o índice mais próximo por texel.
+ *
+ * Uso (a partir da raiz do projeto):
+ *   ./texconv [--format auto|bc1|bc3] [--no-mips] [--flip] imagem.png [...]
+ *
+ * --format auto escolhe BC3 se a imagem tiver algum texel transparente e BC1 caso contrário.
+ * --flip guarda as linhas de baixo para cima (KTXorientation "ru"), que é a orientação em que
+ * as texturas 2D do jogo são usadas; sem ela a orientação é "rd" (a do próprio PNG, usada nas
+ * faces do skybox). Assim o carregamento não precisa de inverter os blocos.
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <CompressedTexture.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/// Opções da linha de comandos.
+struct ConvertOptions {
+    std::string format = "auto";
+    bool mipmaps = true;
+    bool flip = false;
+};
+
+/// Imagem RGBA8.
+struct Image {
+    int width = 0, height = 0;
+    std::vector<unsigned char> rgba;
+
+    const unsigned char* texel(int x, int y) const {
+        x = std::min(x, width - 1);
+        y = std::min(y, height - 1);
+        return &rgba[((size_t)y * width + x) * 4];
+    }
+};
+
+/// Nível seguinte da cadeia (média de 2x2; as dimensões ímpares repetem a última coluna/linha).
+static Image downsample(const Image& image) {
+    Image next;
+    next.width = std::max(1, image.width / 2);
+    next.height = std::max(1, image.height / 2);
+    next.rgba.resize((size_t)next.width * next.height * 4);
+    for (int y = 0; y < next.height; y++) {
+        for (int x = 0; x < next.width; x++) {
+            for (int c = 0; c < 4; c++) {
+                int sum = image.texel(2 * x, 2 * y)[c] + image.texel(2 * x + 1, 2 * y)[c] +
+                          image.texel(2 * x, 2 * y + 1)[c] + image.texel(2 * x + 1, 2 * y + 1)[c];
+                next.rgba[((size_t)y * next.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return next;
+}
+
+static uint16_t packRGB565(const int* rgb) {
+    return (uint16_t)(((rgb[0] * 31 + 127) / 255) << 11 | ((rgb[1] * 63 + 127) / 255) << 5 | ((rgb[2] * 31 + 127) / 255));
+}
+
+static void unpackRGB565(uint16_t color, int* rgb) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+/// Bloco de cor BC1 em modo de 4 cores (também usado como metade de cor do BC3).
+static void encodeColorBlock(const unsigned char block[16][4], unsigned char* out) {
+    int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            lo[c] = std::min(lo[c], (int)block[i][c]);
+            hi[c] = std::max(hi[c], (int)block[i][c]);
+        }
+    }
+    // Recolher a caixa 1/16 de cada lado: os extremos ficam mais perto da maioria dos texels
+    for (int c = 0; c < 3; c++) {
+        int inset = (hi[c] - lo[c]) / 16;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+    uint16_t c0 = packRGB565(hi), c1 = packRGB565(lo);
+    if (c0 < c1) std::swap(c0, c1);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][3];
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 1 << 30;
+            for (int k = 0; k < 4; k++) {
+                int error = 0;
+                for (int c = 0; c < 3; c++) error += (block[i][c] - palette[k][c]) * (block[i][c] - palette[k][c]);
+                if (error < bestError) { bestError = error; best = k; }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+    out[0] = (unsigned char)(c0 & 0xFF); out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF); out[3] = (unsigned char)(c1 >> 8);
+    for (int k = 0; k < 4; k++) out[4 + k] = (unsigned char)(indices >> (8 * k));
+}
+
+/// Bloco de alfa BC3 em modo de 8 valores.
+static void encodeAlphaBlock(const unsigned char block[16][4], unsigned char* out) {
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++) {
+        a0 = std::max(a0, (int)block[i][3]);
+        a1 = std::min(a1, (int)block[i][3]);
+    }
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        int palette[8] = { a0, a1 };
+        for (int k = 2; k < 8; k++) palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 1 << 30;
+            for (int k = 0; k < 8; k++) {
+                int error = std::abs(block[i][3] - palette[k]);
+                if (error < bestError) { bestError = error; best = k; }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int k = 0; k < 6; k++) out[2 + k] = (unsigned char)(indices >> (8 * k));
+}
+
+/// Codifica um nível completo (os blocos das margens repetem os texels da borda).
+static std::vector<unsigned char> encodeLevel(const Image& image, bool bc3) {
+    int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    int blockBytes = bc3 ? 16 : 8;
+    std::vector<unsigned char> out((size_t)blocksX * blocksY * blockBytes);
+    unsigned char block[16][4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            for (int i = 0; i < 16; i++) std::memcpy(block[i], image.texel(bx * 4 + i % 4, by * 4 + i / 4), 4);
+            unsigned char* dst = &out[((size_t)by * blocksX + bx) * blockBytes];
+            if (bc3) {
+                encodeAlphaBlock(block, dst);
+                encodeColorBlock(block, dst + 8);
+            } else {
+                encodeColorBlock(block, dst);
+            }
+        }
+    }
+    return out;
+}
+
+template <typename T>
+static void put(std::vector<unsigned char>& out, size_t offset, T value) {
+    if (out.size() < offset + sizeof(T)) out.resize(offset + sizeof(T));
+    std::memcpy(&out[offset], &value, sizeof(T));
+}
+
+static void align(std::vector<unsigned char>& out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+/**
+ * @brief Escreve um KTX2 sem supercompressão: cabeçalho, índice de níveis, DFD, pares
+ * chave/valor e os níveis do mais pequeno para o maior, como exige a especificação.
+ */
+static bool writeKTX2(const std::string& path, const std::vector<std::vector<unsigned char>>& levels,
+                      int width, int height, bool bc3, bool bottomUp) {
+    static const unsigned char IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const size_t HEADER = 80;
+    uint32_t levelCount = (uint32_t)levels.size();
+    std::vector<unsigned char> out(HEADER + levelCount * 24, 0);
+    std::memcpy(out.data(), IDENTIFIER, 12);
+    put<uint32_t>(out, 12, bc3 ? CompressedTexture::VK_BC3_UNORM : CompressedTexture::VK_BC1_RGB_UNORM);
+    put<uint32_t>(out, 16, 1);              // typeSize
+    put<uint32_t>(out, 20, (uint32_t)width);
+    put<uint32_t>(out, 24, (uint32_t)height);
+    put<uint32_t>(out, 28, 0);              // pixelDepth
+    put<uint32_t>(out, 32, 0);              // layerCount
+    put<uint32_t>(out, 36, 1);              // faceCount
+    put<uint32_t>(out, 40, levelCount);
+    put<uint32_t>(out, 44, 0);              // supercompressionScheme
+
+    // Data Format Descriptor: um bloco básico com uma amostra (BC1) ou duas (alfa + cor, BC3)
+    size_t dfdOffset = out.size();
+    uint32_t samples = bc3 ? 2 : 1;
+    uint32_t blockSize = 24 + 16 * samples;
+    put<uint32_t>(out, dfdOffset, 4 + blockSize);
+    put<uint32_t>(out, dfdOffset + 4, 0);                       // vendorId | descriptorType
+    put<uint16_t>(out, dfdOffset + 8, 2);                       // versionNumber
+    put<uint16_t>(out, dfdOffset + 10, (uint16_t)blockSize);
+    out.resize(dfdOffset + 28, 0);
+    out[dfdOffset + 12] = bc3 ? 130 : 128;                      // KHR_DF_MODEL_BC3 / BC1A
+    out[dfdOffset + 13] = 1;                                    // primaries BT.709
+    out[dfdOffset + 14] = 1;                                    // transfer linear (como os PNG em GL_RGB)
+    out[dfdOffset + 15] = 0;                                    // alfa não pré-multiplicado
+    out[dfdOffset + 16] = 3;                                    // bloco 4x4 (dimensões - 1)
+    out[dfdOffset + 17] = 3;
+    out[dfdOffset + 20] = bc3 ? 16 : 8;                         // bytesPlane0
+    for (uint32_t s = 0; s < samples; s++) {
+        size_t sample = out.size();
+        out.resize(sample + 16, 0);
+        bool alpha = bc3 && s == 0;
+        put<uint16_t>(out, sample, (uint16_t)(s * 64));         // bitOffset
+        out[sample + 2] = 63;                                   // bitLength - 1
+        out[sample + 3] = alpha ? 15 : 0;                       // KHR_DF_CHANNEL_BC3_ALPHA / _COLOR
+        put<uint32_t>(out, sample + 12, 0xFFFFFFFFu);           // sampleUpper
+    }
+    put<uint32_t>(out, 48, (uint32_t)dfdOffset);
+    put<uint32_t>(out, 52, (uint32_t)(out.size() - dfdOffset));
+
+    // Pares chave/valor (ordenados pela chave)
+    size_t kvdOffset = out.size();
+    const std::pair<std::string, std::string> entries[] = {
+        { "KTXorientation", bottomUp ? "ru" : "rd" },
+        { "KTXwriter", "texconv (Labirinto 3D)" },
+    };
+    for (const auto& entry : entries) {
+        uint32_t length = (uint32_t)(entry.first.size() + 1 + entry.second.size() + 1);
+        size_t p = out.size();
+        put<uint32_t>(out, p, length);
+        out.insert(out.end(), entry.first.begin(), entry.first.end());
+        out.push_back(0);
+        out.insert(out.end(), entry.second.begin(), entry.second.end());
+        out.push_back(0);
+        align(out, 4);
+    }
+    put<uint32_t>(out, 56, (uint32_t)kvdOffset);
+    put<uint32_t>(out, 60, (uint32_t)(out.size() - kvdOffset));
+
+    // Níveis: do mais pequeno para o maior, alinhados ao tamanho do bloco
+    for (size_t i = levels.size(); i-- > 0;) {
+        align(out, bc3 ? 16 : 8);
+        put<uint64_t>(out, HEADER + i * 24, (uint64_t)out.size());
+        put<uint64_t>(out, HEADER + i * 24 + 8, (uint64_t)levels[i].size());
+        put<uint64_t>(out, HEADER + i * 24 + 16, (uint64_t)levels[i].size());
+        out.insert(out.end(), levels[i].begin(), levels[i].end());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)out.data(), (std::streamsize)out.size());
+    return (bool)file;
+}
+
+static bool convert(const std::string& input, const ConvertOptions& options) {
+    stbi_set_flip_vertically_on_load(options.flip);
+    Image image;
+    int channels;
+    unsigned char* pixels = stbi_load(input.c_str(), &image.width, &image.height, &channels, 4);
+    if (!pixels) {
+        std::cerr << "Falha ao ler " << input << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    image.rgba.assign(pixels, pixels + (size_t)image.width * image.height * 4);
+    stbi_image_free(pixels);
+
+    bool bc3 = options.format == "bc3";
+    if (options.format == "auto") {
+        for (size_t i = 3; i < image.rgba.size() && !bc3; i += 4) bc3 = image.rgba[i] != 255;
+    }
+
+    int width = image.width, height = image.height;
+    std::vector<std::vector<unsigned char>> levels;
+    size_t bytes = 0;
+    while (true) {
+        levels.push_back(encodeLevel(image, bc3));
+        bytes += levels.back().size();
+        if (!options.mipmaps || (image.width == 1 && image.height == 1)) break;
+        image = downsample(image);
+    }
+
+    size_t dot = input.find_last_of('.');
+    std::string output = (dot == std::string::npos ? input : input.substr(0, dot)) + ".ktx2";
+    if (!writeKTX2(output, levels, width, height, bc3, options.flip)) {
+        std::cerr << "Falha ao escrever " << output << std::endl;
+        return false;
+    }
+    std::cout << input << " -> " << output << " (" << (bc3 ? "BC3" : "BC1") << ", "
+              << levels.size() << " niveis, " << bytes / 1024 << " KiB)" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    ConvertOptions options;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) options.format = argv[++i];
+        else if (arg == "--no-mips") options.mipmaps = false;
+        else if (arg == "--flip") options.flip = true;
+        else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            return 2;
+        }
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty() || (options.format != "auto" && options.format != "bc1" && options.format != "bc3")) {
+        std::cerr << "Uso: texconv [--format auto|bc1|bc3] [--no-mips] [--flip] imagem.png [...]" << std::endl;
+        return 2;
+    }
+
+    int failures = 0;
+    for (const std::string& input : inputs) {
+        if (!convert(input, options)) failures++;
+    }
+    return failures ? 1 : 0;
+}